@@ -0,0 +1,146 @@
+#ifndef FONT_CHEF_ATLAS_H
+#define FONT_CHEF_ATLAS_H
+
+/**
+ * @file atlas.h
+ * This file contains the fc_atlas structure, which lets several fonts cook their glyphs into the same pages.
+ */
+
+/**
+ * @defgroup atlas Atlas
+ * Functions that deal with pages shared by several fonts
+ *
+ * Each ::fc_font cooks its glyphs into pages of its own, so text in several fonts (or several sizes of the same
+ * font) needs a texture for each of them. Fonts added to an atlas are cooked together instead, into pages that
+ * all of them share: text in every one of them can then be drawn from the same texture, in a single draw call.
+ *
+ * Every font keeps its own metrics, glyphs and kerning, and is rendered as usual; the page numbers and source
+ * rectangles it produces point into the pages of the atlas. ::fc_get_pixels, ::fc_get_page and
+ * ::fc_get_page_count on any of the fonts return the pages of the atlas.
+ *
+ * **Example**
+ * @code
+ * struct fc_atlas * atlas = fc_atlas_construct();
+ * struct fc_font * body = fc_construct(font_data, fc_px(16), fc_color_white);
+ * struct fc_font * title = fc_construct(font_data, fc_px(32), fc_color_white);
+ * fc_add(body, fc_basic_latin.first, fc_basic_latin.last);
+ * fc_add(title, fc_basic_latin.first, fc_basic_latin.last);
+ * fc_atlas_add_font(atlas, body);
+ * fc_atlas_add_font(atlas, title);
+ * fc_atlas_cook(atlas);
+ * upload_texture(fc_atlas_get_page(atlas, 0));
+ * @endcode
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "font-chef/font-chef-export.h"
+#include "font-chef/font.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Pages shared by several fonts
+ * @ingroup atlas
+ *
+ * This is an opaque structure, created with ::fc_atlas_construct and destroyed with ::fc_atlas_destruct.
+ */
+struct fc_atlas;
+
+/**
+ * @brief Creates an empty atlas
+ * @ingroup atlas
+ * @return A pointer to a new atlas, or `NULL` if out of memory
+ */
+FONT_CHEF_EXPORT extern struct fc_atlas * fc_atlas_construct(void);
+
+/**
+ * @brief Adds a font to an atlas, to be cooked along with every other font in it
+ * @ingroup atlas
+ *
+ * From now on, cooking the font (with ::fc_cook or ::fc_atlas_cook) cooks the whole atlas. Settings that change
+ * the pages themselves (pixel format and maximum page size) are those of the atlas, the ones of the font are not
+ * used; every other setting still applies to the glyphs of that font. In RGBA format each font keeps its color.
+ *
+ * A font can be in a single atlas, and cannot be saved to a cache (see ::fc_save_cache) while in it. Fonts in an
+ * atlas are never in dynamic atlas mode (see ::fc_set_dynamic_atlas).
+ *
+ * @param atlas A pointer to a `fc_atlas`
+ * @param font A pointer to the `fc_font` to add, which must not be in another atlas
+ * @return `1` if the font was added (or was already in @p atlas), `0` if it is in another atlas or out of memory
+ */
+FONT_CHEF_EXPORT extern uint8_t fc_atlas_add_font(struct fc_atlas * atlas, struct fc_font * font);
+
+/**
+ * @brief Sets the format of the pixels of an atlas. It is ::fc_pixel_format_rgba by default.
+ * @ingroup atlas
+ *
+ * This works like ::fc_set_pixel_format, for every font in the atlas. This must be called *before* cooking it.
+ *
+ * @param atlas A pointer to a `fc_atlas`
+ * @param format The pixel format of the pages
+ */
+FONT_CHEF_EXPORT extern void fc_atlas_set_pixel_format(struct fc_atlas * atlas, enum fc_pixel_format format);
+
+/**
+ * @brief Sets the maximum width and height of each page of an atlas. It is 0 (no limit) by default.
+ * @ingroup atlas
+ *
+ * This works like ::fc_set_max_page_size, for every font in the atlas. This must be called *before* cooking it.
+ *
+ * @param atlas A pointer to a `fc_atlas`
+ * @param max_size The maximum width and height of a page in pixels, or `0` for no limit
+ */
+FONT_CHEF_EXPORT extern void fc_atlas_set_max_page_size(struct fc_atlas * atlas, size_t max_size);
+
+/**
+ * @brief Cooks every font in an atlas into its pages
+ * @ingroup atlas
+ *
+ * This does everything ::fc_cook does for each font in the atlas, packing their glyphs together. Glyphs of each
+ * font are rasterized with its own settings (threads, oversampling, distance fields and so on), but either all
+ * the fonts in an atlas cook multi-channel distance fields (see ::fc_set_msdf) or none of them do.
+ *
+ * @param atlas A pointer to a `fc_atlas`
+ * @return `1` if every font was cooked, `0` if the fonts mix multi-channel distance fields with other glyphs (and
+ * nothing was cooked) or out of memory
+ */
+FONT_CHEF_EXPORT extern uint8_t fc_atlas_cook(struct fc_atlas * atlas);
+
+/**
+ * @brief Returns how many pages an atlas has
+ * @ingroup atlas
+ * @param atlas A pointer to a cooked `fc_atlas`
+ * @return The amount of pages, `0` before cooking
+ */
+FONT_CHEF_EXPORT extern size_t fc_atlas_get_page_count(struct fc_atlas const * atlas);
+
+/**
+ * @brief Returns the pixels of a page of an atlas
+ * @ingroup atlas
+ * @param atlas A pointer to a cooked `fc_atlas`
+ * @param index Which page to get, from `0` to `fc_atlas_get_page_count(atlas) - 1`
+ * @return A pointer to the pixels of the page, or `NULL` if there is no such page
+ */
+FONT_CHEF_EXPORT extern struct fc_pixels const * fc_atlas_get_page(struct fc_atlas const * atlas, size_t index);
+
+/**
+ * @brief Destroys an atlas and its pages
+ * @ingroup atlas
+ *
+ * Fonts in the atlas are left out of any atlas, and must be cooked again before rendering. Destructing a font
+ * (see ::fc_destruct) that is in an atlas takes it out of the atlas; its glyphs stay in the pages until the atlas
+ * is cooked again.
+ *
+ * @param atlas A pointer to a `fc_atlas`
+ */
+FONT_CHEF_EXPORT extern void fc_atlas_destruct(struct fc_atlas * atlas);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FONT_CHEF_ATLAS_H */
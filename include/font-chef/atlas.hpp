@@ -0,0 +1,190 @@
+#ifndef FONT_CHEF_ATLAS_HPP
+#define FONT_CHEF_ATLAS_HPP
+
+/**
+ * @file atlas.hpp
+ * This file contains a wrapper class for ::fc_atlas.
+ */
+
+#include "font-chef/font-chef-export.h"
+#include "font-chef/atlas.h"
+#include "font-chef/font.hpp"
+
+namespace fc {
+  /**
+   * @brief A wrapper class for ::fc_atlas
+   * @ingroup atlas
+   * @ingroup cpp
+   *
+   * Fonts added to an atlas must be destructed before it, or cooked again after it is destructed.
+   *
+   * **Example**
+   * @code
+   * fc::atlas atlas;
+   * fc::font body = fc::from(font_data, fc::px(16), fc_color_white).add(fc_basic_latin);
+   * fc::font title = fc::from(font_data, fc::px(32), fc_color_white).add(fc_basic_latin);
+   * atlas.add(body).add(title).cook();
+   * // use atlas.page(0) to make a texture shared by both fonts
+   * @endcode
+   */
+  class FONT_CHEF_EXPORT atlas {
+    private:
+      fc_atlas * data;
+
+    public:
+      /**
+       * @brief Constructs an empty atlas
+       * @sa ::fc_atlas_construct
+       */
+      atlas() : data(fc_atlas_construct()) { }
+
+      /**
+       * @brief Move constructor
+       * @param other The other fc::atlas instance to move from.
+       */
+      atlas(atlas && other) noexcept : data(other.data) {
+        other.data = nullptr;
+      }
+
+      atlas(atlas const & other) = delete;
+
+      /**
+       * @brief Destructs a fc::atlas instance and frees its pages
+       * @sa ::fc_atlas_destruct
+       */
+      ~atlas() {
+        if (data) fc_atlas_destruct(data);
+      }
+
+      /**
+       * @brief Adds a font to this atlas, to be cooked along with every other font in it
+       *
+       * This is the `lvalue` version of this method (objects with a name)
+       *
+       * @param font The font to add
+       * @return *this
+       * @sa ::fc_atlas_add_font
+       */
+      atlas & add(fc::font & font) & {
+        fc_atlas_add_font(data, font.data);
+        return *this;
+      }
+
+      /**
+       * @brief Adds a font to this atlas, to be cooked along with every other font in it
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @param font The font to add
+       * @return *this
+       * @sa ::fc_atlas_add_font
+       */
+      atlas && add(fc::font & font) && {
+        fc_atlas_add_font(data, font.data);
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Sets the format of the pixels of this atlas
+       *
+       * This is the `lvalue` version of this method (objects with a name)
+       *
+       * @param format The pixel format of the pages
+       * @return *this
+       * @sa ::fc_atlas_set_pixel_format
+       */
+      atlas & pixel_format(fc_pixel_format format) & {
+        fc_atlas_set_pixel_format(data, format);
+        return *this;
+      }
+
+      /**
+       * @brief Sets the format of the pixels of this atlas
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @param format The pixel format of the pages
+       * @return *this
+       * @sa ::fc_atlas_set_pixel_format
+       */
+      atlas && pixel_format(fc_pixel_format format) && {
+        fc_atlas_set_pixel_format(data, format);
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Sets the maximum width and height of each page of this atlas
+       *
+       * This is the `lvalue` version of this method (objects with a name)
+       *
+       * @param max_size The maximum width and height of a page in pixels, or `0` for no limit
+       * @return *this
+       * @sa ::fc_atlas_set_max_page_size
+       */
+      atlas & max_page_size(size_t max_size) & {
+        fc_atlas_set_max_page_size(data, max_size);
+        return *this;
+      }
+
+      /**
+       * @brief Sets the maximum width and height of each page of this atlas
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @param max_size The maximum width and height of a page in pixels, or `0` for no limit
+       * @return *this
+       * @sa ::fc_atlas_set_max_page_size
+       */
+      atlas && max_page_size(size_t max_size) && {
+        fc_atlas_set_max_page_size(data, max_size);
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Cooks every font in this atlas into its pages
+       *
+       * This is the `lvalue` version of this method (objects with a name)
+       *
+       * @return *this
+       * @sa ::fc_atlas_cook
+       */
+      atlas & cook() & {
+        fc_atlas_cook(data);
+        return *this;
+      }
+
+      /**
+       * @brief Cooks every font in this atlas into its pages
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @return *this
+       * @sa ::fc_atlas_cook
+       */
+      atlas && cook() && {
+        fc_atlas_cook(data);
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Returns how many pages this atlas has
+       * @return The count of pages
+       * @sa ::fc_atlas_get_page_count
+       */
+      size_t page_count() const {
+        return fc_atlas_get_page_count(data);
+      }
+
+      /**
+       * @brief Obtains a structure containing a pointer to the pixel data of a page and it's dimensions
+       * @param index Which page to get, from `0` to page_count() - 1
+       * @return a ::fc_pixels value
+       * @sa ::fc_atlas_get_page
+       */
+      fc_pixels page(size_t index) const {
+        return *fc_atlas_get_page(data, index);
+      }
+  };
+}
+
+#endif //FONT_CHEF_ATLAS_HPP
@@ -0,0 +1,107 @@
+#ifndef FONT_CHEF_BLIT_H
+#define FONT_CHEF_BLIT_H
+
+/**
+ * @file blit.h
+ * This file provides ::fc_blit, which draws rendered glyphs into an image in memory.
+ */
+
+/**
+ * @defgroup blit Blit
+ * Functions and types that draw glyphs on the CPU, without a GPU or a graphics library
+ *
+ * Font-chef otherwise leaves drawing to the application: it hands out pages to upload as textures and rectangles
+ * to draw them with. When there is nothing to draw with (e.g, a server generating thumbnails), ::fc_blit copies
+ * glyphs straight from the pages of a font into an RGBA image, blending them over what is already there.
+ *
+ * **Example**
+ * @code
+ * uint8_t * pixels = calloc(640 * 480, 4);
+ * struct fc_framebuffer framebuffer = { pixels, 640, 480, 0 };
+ * struct fc_character_mapping mapping[32];
+ * struct fc_render_result result = fc_render(font, (uint8_t const *) "Hello, world!", 13, mapping);
+ * fc_move(mapping, result.glyph_count, 10, 40);
+ * fc_blit(font, mapping, result.glyph_count, &framebuffer, NULL, fc_color_white);
+ * @endcode
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "font-chef/font-chef-export.h"
+#include "font-chef/font.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief An RGBA image in memory that glyphs are drawn into
+ * @ingroup blit
+ */
+struct fc_framebuffer {
+  /**
+   * @brief The pixels, 4 bytes each in red, green, blue and alpha order, with alpha not premultiplied
+   */
+  uint8_t * data;
+
+  /**
+   * @brief The width of the image in pixels
+   */
+  size_t width;
+
+  /**
+   * @brief The height of the image in pixels
+   */
+  size_t height;
+
+  /**
+   * @brief How many bytes there are from the start of a row to the start of the next one, or `0` if rows
+   * are `width * 4` bytes apart
+   */
+  size_t stride;
+};
+
+/**
+ * @brief Draws rendered glyphs into a framebuffer
+ * @ingroup blit
+ *
+ * Each glyph is copied from its page (see ::fc_get_page) into the pixels of @p framebuffer its target
+ * rectangle covers, rounded to whole pixels. Glyphs whose target is not as large as their source (e.g, with
+ * oversampling or after ::fc_scale) are scaled with nearest-neighbour sampling.
+ *
+ * Glyph pixels are tinted by @p color (use `fc_color_white` to draw RGBA pages as they are) and drawn over
+ * the framebuffer, with `src_alpha` being the glyph alpha times the @p color alpha:
+ * - color channels become `dst_rgb = src_rgb * src_alpha + dst_rgb * (1 - src_alpha)`
+ * - the alpha channel becomes `dst_alpha = src_alpha + dst_alpha * (1 - src_alpha)`
+ *
+ * That is the usual "over" operator, so drawing onto an opaque framebuffer keeps it opaque. Pages in alpha
+ * format are drawn in @p color. Distance field pages hold distances rather than coverage, and are drawn as
+ * they are.
+ *
+ * Glyphs are blended with vector instructions (see @ref simd-level). With more than one thread (see
+ * ::fc_set_thread_count) or an executor (see ::fc_set_executor), the framebuffer is split in bands of rows
+ * that are drawn in parallel. Every pixel is drawn by a single band, in the same order, so the result is the
+ * same either way.
+ *
+ * @param font A pointer to the cooked `fc_font` the glyphs were rendered with
+ * @param mapping The glyphs to draw, as produced by ::fc_render and friends
+ * @param count How many glyphs there are in @p mapping
+ * @param framebuffer Where to draw the glyphs
+ * @param clip Only pixels inside this rectangle are drawn, or `NULL` to draw anywhere in @p framebuffer
+ * @param color The color to tint glyphs with
+ */
+FONT_CHEF_EXPORT extern void fc_blit(
+  struct fc_font const * font,
+  struct fc_character_mapping const * mapping,
+  size_t count,
+  struct fc_framebuffer const * framebuffer,
+  struct fc_rect const * clip,
+  struct fc_color color
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FONT_CHEF_BLIT_H */
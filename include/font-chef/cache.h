@@ -0,0 +1,132 @@
+#ifndef FONT_CHEF_CACHE_H
+#define FONT_CHEF_CACHE_H
+
+/**
+ * @file cache.h
+ * This file provides functions to save the cooked state of a ::fc_font to a binary blob and load it
+ * back later on, skipping ::fc_cook altogether.
+ */
+
+/**
+ * @defgroup cache Cache
+ * Functions that deal with saving and loading cooked fonts
+ *
+ * A cache holds everything ::fc_cook produces: font metrics, the packed glyphs, the kerning table and
+ * the pixels of every page. It is keyed by a hash of the font data, font size, font color, the added
+ * blocks and the settings that change what gets cooked (pixel format, kerning table and maximum page
+ * size), so a cache is only loaded by a font that would have cooked the exact same thing. The font data
+ * is not hashed in full, as that would take longer than loading the cache: only its size, its table
+ * directory and `head` table (which hold a checksum of each table and of the whole font) and a sample
+ * of its bytes are.
+ *
+ * Loading a cache does not copy anything: the font uses the cache memory as it is (the file is
+ * mapped into memory by ::fc_load_cache_file), so the pixel data of a font loaded from a cache
+ * is read-only.
+ *
+ * The cache is stored in the byte order and layout of the machine that saved it. It is meant to
+ * speed up starting an application again on the same machine, not to be shipped along with it.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "font-chef/font-chef-export.h"
+#include "font-chef/font.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Saves the cooked state of a font into a buffer
+ * @ingroup cache
+ *
+ * Call it with a `NULL` buffer first to know how big the buffer must be. Fonts in dynamic atlas mode
+ * (see ::fc_set_dynamic_atlas) or glyph cache mode (see ::fc_set_glyph_cache) cannot be saved, as their
+ * glyphs can still change, and neither can fonts in a shared atlas (see ::fc_atlas_add_font), whose
+ * pages hold glyphs of other fonts. Cooked subset fonts (see ::fc_set_subset) no longer have the font
+ * data the cache is keyed by, but ::fc_cook_cached saves the cache before letting go of it.
+ *
+ * **Example**
+ * @code
+ * size_t size = fc_save_cache(font, NULL, 0);
+ * void * buffer = malloc(size);
+ * fc_save_cache(font, buffer, size);
+ * @endcode
+ *
+ * @param font A pointer to a cooked `fc_font`
+ * @param buffer Where to save the cache, or `NULL` to only get its size
+ * @param size The size of @p buffer in bytes. Nothing is written if it is not big enough
+ * @return The size of the cache in bytes, or `0` if the font cannot be saved
+ * @sa ::fc_load_cache
+ */
+FONT_CHEF_EXPORT extern size_t fc_save_cache(struct fc_font const * font, void * buffer, size_t size);
+
+/**
+ * @brief Saves the cooked state of a font into a file
+ * @ingroup cache
+ * @param font A pointer to a cooked `fc_font`
+ * @param path The path of the file to write, which is overwritten if it exists
+ * @return `1` if the file was written, `0` otherwise
+ * @sa ::fc_save_cache
+ * @sa ::fc_load_cache_file
+ */
+FONT_CHEF_EXPORT extern uint8_t fc_save_cache_file(struct fc_font const * font, char const * path);
+
+/**
+ * @brief Loads a cache into a font in place of cooking it
+ * @ingroup cache
+ *
+ * The font must have the same font data, size, color, blocks and settings as the font that saved
+ * the cache, otherwise nothing is loaded. Fonts in dynamic atlas mode, in glyph cache mode or in a shared
+ * atlas never load a cache. A cache whose glyphs do not lie within its pages is not loaded either.
+ *
+ * The cache memory is used as it is, so it must stay valid and unchanged until the font is
+ * destructed or cooked again. It must also be aligned to 16 bytes (memory returned by `malloc`
+ * usually is).
+ *
+ * @param font A pointer to a `fc_font` instance, with all blocks already added
+ * @param data The cache, as saved by ::fc_save_cache
+ * @param size The size of @p data in bytes
+ * @return `1` if the cache was loaded and the font is ready for ::fc_render, `0` otherwise
+ */
+FONT_CHEF_EXPORT extern uint8_t fc_load_cache(struct fc_font * font, void const * data, size_t size);
+
+/**
+ * @brief Maps a cache file into memory and loads it into a font in place of cooking it
+ * @ingroup cache
+ *
+ * This works like ::fc_load_cache, except the font owns the mapping and releases it when it is
+ * destructed or cooked again.
+ *
+ * @param font A pointer to a `fc_font` instance, with all blocks already added
+ * @param path The path of a file saved by ::fc_save_cache_file
+ * @return `1` if the cache was loaded and the font is ready for ::fc_render, `0` otherwise
+ */
+FONT_CHEF_EXPORT extern uint8_t fc_load_cache_file(struct fc_font * font, char const * path);
+
+/**
+ * @brief Loads a font from a cache file, or cooks it and saves the cache file if that fails
+ * @ingroup cache
+ *
+ * Use this in place of ::fc_cook to only cook a font the first time an application runs (and
+ * whenever the font or its settings change).
+ *
+ * **Example**
+ * @code
+ * struct fc_font * font = fc_construct(font_data, fc_px(30), fc_color_black);
+ * fc_add(font, fc_basic_latin.first, fc_basic_latin.last);
+ * fc_cook_cached(font, "basic-latin-30px.fcc");
+ * @endcode
+ *
+ * @param font A pointer to a `fc_font` instance, with all blocks already added
+ * @param path The path of the cache file
+ * @return `1` if the font was loaded from the cache file, `0` if it was cooked
+ */
+FONT_CHEF_EXPORT extern uint8_t fc_cook_cached(struct fc_font * font, char const * path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FONT_CHEF_CACHE_H */
@@ -3,6 +3,7 @@
 
 #include "font-chef/size.h"
 #include "font-chef/rect.h"
+#include "font-chef/vertex.h"
 
 /**
  * @file character-mapping.h
@@ -45,6 +46,11 @@ struct fc_character_mapping {
    * @brief Which unicode codepoint this mapping represents
    */
   uint32_t codepoint;
+
+  /**
+   * @brief Which page of pixels the source rectangle refers to (see ::fc_get_page)
+   */
+  uint32_t page;
 };
 
 /**
@@ -98,6 +104,55 @@ FONT_CHEF_EXPORT extern uint32_t fc_wrap(
     enum fc_alignment alignment
 );
 
+/**
+ * @brief Returns how many bytes a workspace for ::fc_wrap_with_workspace must have to wrap @p count mappings
+ * @ingroup character-mapping
+ * @param count How many mappings will be wrapped at most
+ * @return The workspace size in bytes
+ * @sa ::fc_wrap_with_workspace
+ */
+FONT_CHEF_EXPORT extern size_t fc_wrap_workspace_size(size_t count);
+
+/**
+ * @brief Same as ::fc_wrap, but uses a buffer supplied by you instead of allocating memory
+ * @ingroup character-mapping
+ *
+ * ::fc_wrap allocates some memory to keep track of words and lines every time it is called. If you wrap
+ * text every frame, allocate a workspace once (of at least ::fc_wrap_workspace_size bytes for the longest
+ * text you will wrap) and reuse it for every call. If @p workspace is `NULL` or too small, memory is
+ * allocated just like ::fc_wrap does.
+ *
+ * **Example**
+ * @code
+ * size_t workspace_size = fc_wrap_workspace_size(256);
+ * void * workspace = malloc(workspace_size);
+ * // every frame
+ * fc_wrap_with_workspace(mapping, count, 200, line_height, space_width, fc_align_left, workspace, workspace_size);
+ * @endcode
+ *
+ * @param mapping The array of character mappings to wrap
+ * @param count How many mappings are in the array
+ * @param line_width The maximum line width, in target/screen size (e.g, pixels)
+ * @param line_height The space between the topmost pixel in the line to the bottomost pixel in the line (this includes characters in the line itself)
+ * @param space_width The width of a space character
+ * @param alignment Which aligment should lines follow
+ * @param workspace A buffer that this function can use as it sees fit while it runs
+ * @param workspace_size The size of @p workspace in bytes
+ * @return The line count in the text
+ * @sa ::fc_wrap_workspace_size
+ * @sa ::fc_render_wrapped_with_workspace
+ */
+FONT_CHEF_EXPORT extern uint32_t fc_wrap_with_workspace(
+    struct fc_character_mapping mapping[],
+    size_t count,
+    float line_width,
+    float line_height,
+    float space_width,
+    enum fc_alignment alignment,
+    void * workspace,
+    size_t workspace_size
+);
+
 /**
  * @brief Moves all the target rectangles by @p left pixels horizontally and @p baseline pixels vertically
  * @ingroup character-mapping
@@ -115,6 +170,42 @@ FONT_CHEF_EXPORT extern uint32_t fc_wrap(
  */
 FONT_CHEF_EXPORT void fc_move(struct fc_character_mapping * mapping, size_t count, float left, float baseline);
 
+/**
+ * @brief Multiplies all the target rectangles by @p scale, around the start of the baseline
+ * @ingroup character-mapping
+ *
+ * This is meant for fonts cooked as signed distance fields (see ::fc_set_sdf), which can be drawn at any size:
+ * render text at the cooked size, then scale it by `target size / cooked size`. Scale before ::fc_move, as the
+ * position it moves to would be scaled as well.
+ *
+ * @param mapping The array of character mappings to scale
+ * @param count How many mappings are in the array
+ * @param scale How much bigger (or smaller, when less than `1`) the text should be
+ */
+FONT_CHEF_EXPORT void fc_scale(struct fc_character_mapping * mapping, size_t count, float scale);
+
+/**
+ * @brief Turns character mappings into compact instance records, one per glyph
+ * @ingroup character-mapping
+ *
+ * Call it once mappings are where they should be (e.g, after ::fc_wrap, ::fc_move and ::fc_scale). Target rects
+ * are rounded to the nearest pixel and give the quad size, while the source rects give the texture coordinates.
+ * Glyphs without pixels (like spaces) are left out, and so are glyphs that do not fit in a ::fc_glyph_instance:
+ * those bigger than 255 pixels or placed beyond what 16 bits can hold. Because of that there might be fewer
+ * instances than mappings.
+ *
+ * @param mapping An array of character mappings
+ * @param count How many mappings there are in @p mapping
+ * @param instances Where to write instances, with room for at least @p count of them
+ * @return How many instances were written
+ * @sa ::fc_render_instances
+ */
+FONT_CHEF_EXPORT size_t fc_make_instances(
+    struct fc_character_mapping const * mapping,
+    size_t count,
+    struct fc_glyph_instance * instances
+);
+
 #ifdef __cplusplus
 }
 #endif
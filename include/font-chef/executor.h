@@ -0,0 +1,67 @@
+#ifndef FONT_CHEF_EXECUTOR_H
+#define FONT_CHEF_EXECUTOR_H
+
+/**
+ * @file executor.h
+ * This file provides the fc_executor structure, used to plug an external task system
+ * (e.g, a job system or a thread pool) into the parts of font-chef that can run in parallel.
+ */
+
+/**
+ * @defgroup executor Executor
+ * Functions and types that deal with running work in parallel
+ */
+
+#include "font-chef/font-chef-export.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A unit of work. It will be called once for each index in a batch of tasks.
+ * @ingroup executor
+ *
+ * Tasks of the same batch can run concurrently with each other, they never touch the same memory.
+ *
+ * @param data The data pointer passed to ::fc_executor.run
+ * @param index Which task of the batch to run, from `0` to `count - 1`
+ */
+typedef void (*fc_task)(void * data, size_t index);
+
+/**
+ * @brief Describes how to run a batch of tasks.
+ * @ingroup executor
+ *
+ * `run` must call `task(data, i)` exactly once for every `i` from `0` to `count - 1`, in any order and
+ * from any thread, and only return after all of them are done.
+ *
+ * **Example**
+ * @code
+ * // runs tasks with OpenMP
+ * void run_with_openmp(void * context, fc_task task, void * data, size_t count) {
+ *   #pragma omp parallel for
+ *   for (long i = 0; i < (long) count; i++) task(data, (size_t) i);
+ * }
+ *
+ * struct fc_executor executor = { run_with_openmp, NULL };
+ * @endcode
+ */
+struct fc_executor {
+  /**
+   * @brief Runs @p count tasks and returns when they are all done
+   */
+  void (*run)(void * context, fc_task task, void * data, size_t count);
+
+  /**
+   * @brief A pointer passed as-is to @p run
+   */
+  void * context;
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FONT_CHEF_EXECUTOR_H */
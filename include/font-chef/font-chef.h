@@ -56,6 +56,10 @@ for (int i = 0; i < count; i++) {
  */
 
 #include "font.h"
+#include "atlas.h"
+#include "blit.h"
+#include "cache.h"
+#include "simd-level.h"
 
 #ifdef __cplusplus
 #include "font.hpp"
@@ -12,8 +12,11 @@
  */
 
 #include "render-result.hpp"
+#include "text-view.hpp"
 #include "color.hpp"
 #include "font.hpp"
+#include "atlas.hpp"
 #include "font-size.hpp"
+#include "simd-level.h"
 
 #endif //FONT_CHEF_FONT_CHEF_H
@@ -7,6 +7,18 @@
  *
  * @defgroup font Font
  * All the functions and types that deal with fonts and font-cooking
+ *
+ * **Threads**
+ *
+ * Once a font is cooked, every function that takes it as a `struct fc_font const *` (e.g, ::fc_render,
+ * ::fc_render_wrapped, ::fc_render_batch, ::fc_get_page or ::fc_blit) only reads from it, without locks or
+ * caches filled on the way. Any number of threads may call them on the same font at the same time, each with
+ * its own output buffers, and they all get the same results as a single thread would.
+ *
+ * Functions that take a `struct fc_font *` (e.g, ::fc_cook, ::fc_render_dynamic, ::fc_next_frame or any
+ * setter) change the font, and must not run while any other thread uses it. Different fonts can always be
+ * used from different threads, except for the few limits documented on ::fc_construct_sharing and
+ * ::fc_set_simd_level.
  */
 
 #include <stdlib.h>
@@ -18,11 +30,27 @@
 #include "font-chef/character-mapping.h"
 #include "font-chef/color.h"
 #include "font-chef/size.h"
+#include "font-chef/executor.h"
+#include "font-chef/vertex.h"
+#include "font-chef/glyph-arrays.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief Specifies the format of the pixel data produced by ::fc_cook
+ * @ingroup font
+ * @sa ::fc_set_pixel_format
+ */
+enum fc_pixel_format {
+  /** 4 bytes per pixel, RGBA, with the font color in every pixel and glyph coverage as alpha (default) */
+  fc_pixel_format_rgba = 0,
+
+  /** 1 byte per pixel with glyph coverage only, to be used as alpha by a shader that applies the color */
+  fc_pixel_format_alpha
+};
+
 /**
  * @brief A structure holding pixel data and its dimensions
  *
@@ -33,14 +61,21 @@ extern "C" {
  * */
 struct fc_pixels {
   /**
-   * @brief The pixel data produced after ::fc_cook, a 4-byte-per-pixel RGBA bitmap.
+   * @brief The pixel data produced after ::fc_cook, a 4-byte-per-pixel RGBA bitmap
+   * or a 1-byte-per-pixel alpha bitmap depending on @p format.
    */
   unsigned char * data;
 
   /**
    * @brief Width and height of this pixel data. Buffer size would be dimensions.width * dimensions.height * 4
+   * (or just dimensions.width * dimensions.height if @p format is ::fc_pixel_format_alpha)
    */
   struct fc_size dimensions;
+
+  /**
+   * @brief The format of this pixel data
+   */
+  enum fc_pixel_format format;
 };
 
 /**
@@ -58,6 +93,95 @@ struct fc_render_result {
   uint32_t glyph_count;
 };
 
+/**
+ * @brief Counters of the glyph cache of a font, since the start of the current frame
+ * @ingroup font
+ * @sa ::fc_set_glyph_cache
+ * @sa ::fc_get_glyph_cache_stats
+ */
+struct fc_glyph_cache_stats {
+  /**
+   * @brief How many glyphs were already in the cache when they were needed
+   */
+  size_t hits;
+
+  /**
+   * @brief How many glyphs were not in the cache, and were rasterized into it
+   */
+  size_t misses;
+
+  /**
+   * @brief How many glyphs were evicted from the cache to make room for others
+   */
+  size_t evictions;
+
+  /**
+   * @brief How many glyphs were left out because every cell was already used in the current frame, or because they
+   * did not fit in a cell
+   */
+  size_t overflows;
+
+  /**
+   * @brief How many cells hold a glyph
+   */
+  size_t used;
+
+  /**
+   * @brief How many glyphs fit in the cache
+   */
+  size_t capacity;
+};
+
+/**
+ * @brief A text to be rendered by ::fc_render_batch, along with where to lay it out
+ * @sa ::fc_render_batch
+ */
+struct fc_batch_text {
+  /**
+   * @brief A pointer to a character array containing the text to map
+   */
+  unsigned char const * text;
+
+  /**
+   * @brief How many bytes are there in the character array
+   */
+  size_t byte_count;
+
+  /**
+   * @brief Where to lay out the text
+   *
+   * The text is moved so that its first line starts at `box.left` and `box.top`. If `box.right` is greater
+   * than `box.left`, the text is also wrapped to the width of the box, as with ::fc_render_wrapped.
+   */
+  struct fc_rect box;
+
+  /**
+   * @brief Which aligment lines should follow when the text is wrapped
+   */
+  enum fc_alignment alignment;
+};
+
+/**
+ * @brief Where the mappings of one text rendered by ::fc_render_batch are, and how many there are
+ * @sa ::fc_render_batch
+ */
+struct fc_batch_span {
+  /**
+   * @brief The index of the first mapping of the text
+   */
+  size_t first;
+
+  /**
+   * @brief How many glyphs were produced
+   */
+  uint32_t glyph_count;
+
+  /**
+   * @brief How many lines were produced
+   */
+  uint32_t line_count;
+};
+
 
 /**
  * @struct fc_font
@@ -93,6 +217,8 @@ struct fc_render_result {
  *                  nor free'd by font-chef).
  * @param font_size A size either in pixels or points to apply when packing
  * @param font_color The color of the characters in the rendered bitmap
+ * @sa ::fc_construct_owned
+ * @sa ::fc_construct_from_file
  */
 FONT_CHEF_EXPORT extern struct fc_font * fc_construct(
   uint8_t const * font_data,
@@ -100,6 +226,74 @@ FONT_CHEF_EXPORT extern struct fc_font * fc_construct(
   struct fc_color font_color
 );
 
+/**
+ * @brief Constructs a `fc_font` structure that takes ownership of its font data
+ * @ingroup font
+ *
+ * Same as `::fc_construct`, except that @p font_data is freed by font-chef once it is no longer
+ * needed: when the font (and every font sharing its data, see `::fc_construct_sharing`) is destructed.
+ *
+ * @param font_data A pointer to the in-memory font-data, allocated with `malloc`. It is freed
+ *                  right away if the font cannot be constructed
+ * @param size The size of @p font_data in bytes
+ * @param font_size A size either in pixels or points to apply when packing
+ * @param font_color The color of the characters in the rendered bitmap
+ * @return The new font, or `NULL` if @p font_data is not a font or there is not enough memory
+ */
+FONT_CHEF_EXPORT extern struct fc_font * fc_construct_owned(
+  uint8_t * font_data,
+  size_t size,
+  struct fc_font_size font_size,
+  struct fc_color font_color
+);
+
+/**
+ * @brief Constructs a `fc_font` structure from a font file, mapped into memory
+ * @ingroup font
+ *
+ * The file is mapped read-only instead of being read into the heap, so only the parts of it that are
+ * actually used take memory (e.g, the few glyphs drawn from a large CJK font), and processes using the
+ * same font file share those pages. The file is unmapped once the font (and every font sharing its
+ * data, see `::fc_construct_sharing`) is destructed. It must not be modified while it is mapped.
+ *
+ * **Example**
+ * @code
+ * struct fc_font * font = fc_construct_from_file("times.ttf", fc_px(12), fc_color_red);
+ * if (font == NULL) {
+ *     // the file does not exist or is not a font
+ * }
+ * @endcode
+ *
+ * @param path The path of the font file
+ * @param font_size A size either in pixels or points to apply when packing
+ * @param font_color The color of the characters in the rendered bitmap
+ * @return The new font, or `NULL` if the file cannot be mapped or is not a font
+ */
+FONT_CHEF_EXPORT extern struct fc_font * fc_construct_from_file(
+  char const * path,
+  struct fc_font_size font_size,
+  struct fc_color font_color
+);
+
+/**
+ * @brief Constructs a `fc_font` structure with the same font data as another font
+ * @ingroup font
+ *
+ * This is how to get several sizes or colors of a font without loading it again. If @p other owns its
+ * font data (see `::fc_construct_owned` and `::fc_construct_from_file`), the data is shared by both
+ * fonts and released with the last of them, so @p other may be destructed first. Fonts sharing their
+ * data must not be constructed or destructed at the same time from different threads.
+ *
+ * @param other The font to take the font data from
+ * @param font_size A size either in pixels or points to apply when packing
+ * @param font_color The color of the characters in the rendered bitmap
+ */
+FONT_CHEF_EXPORT extern struct fc_font * fc_construct_sharing(
+  struct fc_font const * other,
+  struct fc_font_size font_size,
+  struct fc_color font_color
+);
+
 /**
  * @brief Adds the given unicode range to the list of blocks to be cooked. You must
  * add blocks *before* calling `::fc_cook`.
@@ -113,7 +307,9 @@ FONT_CHEF_EXPORT extern struct fc_font * fc_construct(
  *
  * If you call this function *after* calling `::fc_cook`, you will need to call
  * `::fc_cook` again. It is advised not to do this, add all the ranges you
- * will be using before.
+ * will be using before. The exception is a font with a dynamic atlas (see
+ * `::fc_set_dynamic_atlas`): the glyphs of the new block are then cooked right
+ * away into the free space of the existing pixels.
  *
  * **Example**
  * @code
@@ -135,6 +331,279 @@ FONT_CHEF_EXPORT extern void fc_add(
   uint32_t last
 );
 
+/**
+ * @brief Enables or disables the kerning table built by `::fc_cook`. It is enabled by default.
+ * @ingroup font
+ *
+ * When enabled, `::fc_cook` extracts the kerning of every pair of cooked codepoints from the font
+ * and stores it, already scaled to pixels, in a table that `::fc_render` probes once per pair.
+ * When disabled, kerning is looked up in the font data for every pair at render time instead.
+ *
+ * Building the table walks the pairs the font kerning tables list for the cooked glyphs, so its cost
+ * grows with the number of pairs that end up in it rather than with the number of glyphs squared. Use
+ * `::fc_get_kerning_pair_count` to know how big the table turned out to be.
+ *
+ * This must be called *before* `::fc_cook` to have any effect.
+ *
+ * @param font A pointer to the `fc_font` instance
+ * @param enabled Non-zero to build the kerning table when cooking, zero to skip it
+ * @sa ::fc_get_kerning_pair_count
+ */
+FONT_CHEF_EXPORT extern void fc_set_kerning_table(struct fc_font * font, uint8_t enabled);
+
+/**
+ * @brief Makes `::fc_cook` keep everything rendering needs, so the font data can be let go of. It is disabled by default.
+ * @ingroup font
+ *
+ * Rendering reads glyph advances, kerning, vertical metrics and space metrics. They all come from the
+ * font data, which is the whole font file and can take megabytes. When enabled, `::fc_cook` (and loading
+ * a cache) stores all of them in the font, always building the kerning table (see
+ * `::fc_set_kerning_table`), and the font no longer uses its font data afterwards:
+ * `::fc_get_font_data` returns `NULL`. Font data the font owns (see `::fc_construct_owned` and
+ * `::fc_construct_from_file`) is released right away, unless other fonts share it; borrowed font data
+ * can be freed by the caller.
+ *
+ * From then on, the font cannot be cooked again, saved to a cache, added to an atlas or shared with
+ * `::fc_construct_sharing`. This has no effect on fonts in dynamic atlas mode, in glyph cache mode or in
+ * a shared atlas, which keep rasterizing glyphs from the font data after cooking.
+ *
+ * This must be called *before* `::fc_cook` to have any effect.
+ *
+ * @param font A pointer to the `fc_font` instance
+ * @param enabled Non-zero to let go of the font data after cooking, zero to keep it
+ */
+FONT_CHEF_EXPORT extern void fc_set_subset(struct fc_font * font, uint8_t enabled);
+
+/**
+ * @brief Sets the format of the pixel data produced by `::fc_cook`. Default is ::fc_pixel_format_rgba.
+ * @ingroup font
+ *
+ * With ::fc_pixel_format_alpha the 8-bit glyph coverage produced while packing is kept as the final
+ * bitmap, which takes a quarter of the memory and skips expanding it to RGBA. The font color is then
+ * not present in the pixels: apply it when rendering (e.g, in a shader).
+ *
+ * This must be called *before* `::fc_cook` to have any effect.
+ *
+ * @param font A pointer to the `fc_font` instance
+ * @param format The pixel format to produce
+ * @sa ::fc_pixels
+ */
+FONT_CHEF_EXPORT extern void fc_set_pixel_format(struct fc_font * font, enum fc_pixel_format format);
+
+/**
+ * @brief Sets the maximum width and height, in pixels, of each page produced by `::fc_cook`. Default is `0` (no limit).
+ * @ingroup font
+ *
+ * Glyphs are packed into a page sized from an estimate of how much space the added blocks need. Glyphs
+ * that do not fit spill into more pages of the same size, so a big set of blocks never goes past your
+ * texture size limit. Use `::fc_get_page_count` and `::fc_get_page` to get all the pages, and the
+ * `page` field of `::fc_character_mapping` to know which one to draw each glyph from.
+ *
+ * Pages are trimmed to the rows they use, except for the last page of a dynamic atlas (see
+ * `::fc_set_dynamic_atlas`), which keeps its free space for new glyphs.
+ *
+ * This must be called *before* `::fc_cook` to have any effect.
+ *
+ * @param font A pointer to the `fc_font` instance
+ * @param max_size The maximum width and height of a page, or `0` for no limit
+ * @sa ::fc_get_page
+ */
+FONT_CHEF_EXPORT extern void fc_set_max_page_size(struct fc_font * font, size_t max_size);
+
+/**
+ * @brief Sets how many threads `::fc_cook` may use to rasterize glyphs. Default is `1`.
+ * @ingroup font
+ *
+ * Glyphs are packed first and then rasterized in batches spread over the threads, the calling thread
+ * included. The resulting pixels and mappings are the same regardless of the thread count. Values of
+ * `0` and `1` both mean that everything runs on the calling thread.
+ *
+ * This is ignored if an executor was set with `::fc_set_executor`.
+ *
+ * This must be called *before* `::fc_cook` to have any effect on it. `::fc_blit` uses the same threads
+ * to draw into a framebuffer in bands, whenever it is called.
+ *
+ * @param font A pointer to the `fc_font` instance
+ * @param thread_count The maximum amount of threads to use
+ * @sa ::fc_set_executor
+ */
+FONT_CHEF_EXPORT extern void fc_set_thread_count(struct fc_font * font, size_t thread_count);
+
+/**
+ * @brief Sets an executor to run the parallel parts of `::fc_cook` (e.g, on your own job system)
+ * @ingroup font
+ *
+ * When `executor.run` is not `NULL`, font-chef hands it batches of tasks instead of starting threads
+ * itself. Pass an executor with a `NULL` `run` to go back to using `::fc_set_thread_count`.
+ *
+ * This must be called *before* `::fc_cook` to have any effect on it. `::fc_blit` hands the executor its
+ * bands of rows as well.
+ *
+ * @param font A pointer to the `fc_font` instance
+ * @param executor The executor to use
+ * @sa ::fc_executor
+ */
+FONT_CHEF_EXPORT extern void fc_set_executor(struct fc_font * font, struct fc_executor executor);
+
+/**
+ * @brief Enables or disables the dynamic atlas mode. It is disabled by default.
+ * @ingroup font
+ *
+ * In dynamic atlas mode `::fc_cook` keeps its glyph packer around, so glyphs can be added to the
+ * cooked pixels later on without cooking everything again: `::fc_render_dynamic` cooks codepoints
+ * missing from the atlas on demand and `::fc_add` cooks the glyphs of a new block right away. Only
+ * the glyphs themselves are rasterized, into free space of the last page.
+ *
+ * Every area of the pages that changes is recorded and can be queried with `::fc_get_dirty_rects`,
+ * so that only those areas need to be uploaded to a texture. When there is no free space left, the
+ * last page grows to twice its height (pixel coordinates of glyphs already cooked stay the same) and
+ * the whole page is reported as dirty. Once it reaches the maximum page size (see
+ * `::fc_set_max_page_size`), a new page is added instead.
+ *
+ * This must be called *before* `::fc_cook` to have any effect.
+ *
+ * @param font A pointer to the `fc_font` instance
+ * @param enabled Non-zero to keep the atlas open for new glyphs after cooking, zero to close it
+ * @sa ::fc_render_dynamic
+ * @sa ::fc_get_dirty_rects
+ */
+FONT_CHEF_EXPORT extern void fc_set_dynamic_atlas(struct fc_font * font, uint8_t enabled);
+
+/**
+ * @brief Enables the glyph cache mode, with a single page of a fixed size. It is disabled by default.
+ * @ingroup font
+ *
+ * Some texts draw from far more codepoints than fit in a texture (e.g, user-generated text in CJK
+ * scripts). In glyph cache mode the font has a single page of @p width by @p height pixels, split in
+ * cells as big as the largest glyph of the blocks added so far, and `::fc_render_dynamic` rasterizes the glyphs it
+ * needs into them on demand. Once every cell is taken, the least recently used glyph makes room for
+ * the new one. Each glyph that changes is recorded as a dirty rect (see `::fc_get_dirty_rects`).
+ *
+ * Glyphs used since the start of the current frame are never evicted, so that every glyph rendered
+ * during a frame is still there when it is drawn: call `::fc_next_frame` once per frame. Glyphs that
+ * find no cell are mapped as if the font did not have them, and counted as overflows. The counters
+ * returned by `::fc_get_glyph_cache_stats` tell how well the cache fits the text being drawn.
+ *
+ * `::fc_cook` creates the blank page and fills it with the glyphs of the blocks, for as long as there
+ * are free cells. Without blocks, cells have room for the font bounding box, which is usually far
+ * larger than any glyph. Kerning is always queried from the font, and glyphs keep the
+ * font color in RGBA format. This takes precedence over the dynamic atlas mode, and must be called
+ * *before* `::fc_cook` to have any effect.
+ *
+ * @param font A pointer to the `fc_font` instance
+ * @param width The width of the page in pixels, or `0` to disable the glyph cache
+ * @param height The height of the page in pixels, or `0` to disable the glyph cache
+ * @sa ::fc_render_dynamic
+ * @sa ::fc_next_frame
+ */
+FONT_CHEF_EXPORT extern void fc_set_glyph_cache(struct fc_font * font, size_t width, size_t height);
+
+/**
+ * @brief Starts a new frame of the glyph cache
+ * @ingroup font
+ *
+ * The counters of the glyph cache go back to zero, and glyphs used so far can be evicted again.
+ * This does nothing unless the font is in glyph cache mode (see `::fc_set_glyph_cache`).
+ *
+ * @param font A pointer to the `fc_font` instance
+ */
+FONT_CHEF_EXPORT extern void fc_next_frame(struct fc_font * font);
+
+/**
+ * @brief Returns the counters of the glyph cache, since the start of the current frame
+ * @ingroup font
+ * @param font A pointer to the `fc_font` instance
+ * @return The counters of the glyph cache, all of them zero unless the font is in glyph cache mode
+ * @sa ::fc_set_glyph_cache
+ */
+FONT_CHEF_EXPORT extern struct fc_glyph_cache_stats fc_get_glyph_cache_stats(struct fc_font const * font);
+
+/**
+ * @brief Makes `::fc_cook` produce a signed distance field atlas instead of glyph coverage. It is disabled by default.
+ * @ingroup font
+ *
+ * Each glyph is cooked as a signed distance field that reaches @p padding pixels out of the glyph on every side.
+ * Pixels on the glyph outline have @p on_edge_value; values grow towards the inside of the glyph and drop by
+ * `on_edge_value / padding` for every pixel away from it, down to `0` at the edge of the field. Use
+ * ::fc_pixel_format_alpha to get a single channel atlas; in RGBA mode the field goes to the alpha channel.
+ *
+ * A distance field can be drawn at any size with a shader that compares samples against the on-edge value
+ * (e.g, `smoothstep(edge - w, edge + w, sample)`), so a single cooked atlas serves every size. Text is still
+ * laid out at the cooked size, without snapping glyphs to whole pixels: scale the results with ::fc_scale by
+ * `target size / cooked size` (and multiply the metrics given to ::fc_wrap by the same factor). Source
+ * rectangles and target rectangles include the padding.
+ *
+ * This replaces any setting made with `::fc_set_msdf`, and must be called *before* `::fc_cook` to have any effect.
+ *
+ * @param font A pointer to the `fc_font` instance
+ * @param padding How many pixels the field reaches out of each glyph, or `0` to cook glyph coverage
+ * @param on_edge_value The value of pixels on glyph outlines, from `1` to `255` (`128` is a good start)
+ * @sa ::fc_scale
+ * @sa ::fc_set_msdf
+ */
+FONT_CHEF_EXPORT extern void fc_set_sdf(struct fc_font * font, uint8_t padding, uint8_t on_edge_value);
+
+/**
+ * @brief Makes `::fc_cook` produce a multi-channel signed distance field atlas. It is disabled by default.
+ * @ingroup font
+ *
+ * A single distance field rounds sharp corners off glyphs drawn much larger than they were cooked. A multi-channel
+ * field keeps them: each of the red, green and blue channels holds the distance to some of the glyph edges, and the
+ * median of the three is the distance to the outline. Draw it like the field of `::fc_set_sdf`, comparing
+ * `max(min(r, g), min(max(r, g), b))` against the on-edge value. The alpha channel holds the plain distance field,
+ * for effects that reach far from glyphs (e.g, shadows and glows).
+ *
+ * Pages are always RGBA in this mode, whatever the pixel format, and the font color is not used. Fields are
+ * computed from the glyph outlines, which takes much longer than rasterizing them: glyphs are spread over the
+ * threads one by one (see `::fc_set_thread_count`), and `::fc_cook_cached` only pays for it once.
+ *
+ * Everything else works as in `::fc_set_sdf`, which this setting replaces. This must be called *before*
+ * `::fc_cook` to have any effect.
+ *
+ * @param font A pointer to the `fc_font` instance
+ * @param padding How many pixels the field reaches out of each glyph, or `0` to cook glyph coverage
+ * @param on_edge_value The value of pixels on glyph outlines, from `1` to `255` (`128` is a good start)
+ * @sa ::fc_set_sdf
+ */
+FONT_CHEF_EXPORT extern void fc_set_msdf(struct fc_font * font, uint8_t padding, uint8_t on_edge_value);
+
+/**
+ * @brief Sets how many times larger than their size glyphs are rasterized, horizontally and vertically. It is 1 by default.
+ * @ingroup font
+ *
+ * Oversampled glyphs take @p horizontal times more pixels across and @p vertical times more pixels down in the
+ * pages, and are filtered so that drawing them at their size with bilinear filtering looks smoother than plain
+ * glyphs, especially when they are not placed on whole pixels (see `::fc_set_subpixel_positioning`). Source
+ * rectangles are in page pixels while target rectangles keep the font size, so they no longer have the same
+ * dimensions. A horizontal value of `2` with a vertical value of `1` is a good choice for horizontal text.
+ *
+ * Values are clamped between `1` and `8`. Distance fields (see `::fc_set_sdf` and `::fc_set_msdf`) are never
+ * oversampled. This must be called *before* `::fc_cook` to have any effect.
+ *
+ * @param font A pointer to the `fc_font` instance
+ * @param horizontal How many times wider glyphs are rasterized
+ * @param vertical How many times taller glyphs are rasterized
+ * @sa ::fc_set_subpixel_positioning
+ */
+FONT_CHEF_EXPORT extern void fc_set_oversampling(struct fc_font * font, uint8_t horizontal, uint8_t vertical);
+
+/**
+ * @brief Chooses whether rendered glyphs keep fractional positions. It is disabled by default.
+ * @ingroup font
+ *
+ * By default `::fc_render` (and every function that lays out text) snaps each glyph to whole pixels, which keeps
+ * plain glyphs crisp but makes spacing uneven by up to half a pixel. With subpixel positioning target rectangles
+ * keep the exact positions given by glyph advances and kerning, and should be drawn with bilinear filtering;
+ * combine it with horizontal oversampling (see `::fc_set_oversampling`) so that glyphs stay sharp.
+ *
+ * This can be changed at any time, and affects text rendered afterwards.
+ *
+ * @param font A pointer to the `fc_font` instance
+ * @param enabled Non-zero to keep fractional positions, zero to snap glyphs to whole pixels
+ * @sa ::fc_set_oversampling
+ */
+FONT_CHEF_EXPORT extern void fc_set_subpixel_positioning(struct fc_font * font, uint8_t enabled);
+
 /**
  * @brief Generates a bitmap and corresponding character information for a font.
  * @ingroup font
@@ -146,6 +615,8 @@ FONT_CHEF_EXPORT extern void fc_add(
  * If you call `::fc_add` after calling this function, you will need to call
  * call it again. It is advisable to call `::fc_cook` just once.
  *
+ * If the font is in an atlas (see `::fc_atlas_add_font`), this cooks every font in it with `::fc_atlas_cook`.
+ *
  * **Example**
  * @code
  * // suppose this creates a 4bpp texture from pixel data
@@ -216,6 +687,150 @@ FONT_CHEF_EXPORT extern struct fc_render_result fc_render(
   struct fc_character_mapping * mapping
 );
 
+/**
+ * @brief Same as ::fc_render, but stores glyphs as a structure of arrays
+ * @ingroup font
+ *
+ * The glyphs previously in @p arrays are replaced, and room is made for @p byte_count glyphs if there is not enough.
+ * The target rectangles can then be moved, measured and wrapped with ::fc_move_arrays, ::fc_text_bounds_arrays and
+ * ::fc_wrap_arrays.
+ *
+ * @param font A pointer to a cooked `fc_font`
+ * @param text A pointer to a character array containing the text to render
+ * @param byte_count How many bytes are there in the character array
+ * @param arrays Where glyphs are stored. Zero-initialize it before using it for the first time
+ * @return how many glyphs and lines were produced (no glyphs if memory could not be allocated)
+ * @sa ::fc_glyph_arrays
+ */
+FONT_CHEF_EXPORT extern struct fc_render_result fc_render_arrays(
+    struct fc_font const * font,
+    unsigned char const * text,
+    size_t byte_count,
+    struct fc_glyph_arrays * arrays
+);
+
+/**
+ * @brief Renders text straight into vertex and index buffers, ready to be drawn by a GPU
+ * @ingroup font
+ *
+ * This lays out glyphs just like ::fc_render, but instead of filling an array of mappings it writes four
+ * vertices for each glyph (position, texture coordinates from `0` to `1` and, optionally, a color and the
+ * glyph page) and six indices for the two triangles between them, following @p layout. Glyphs without
+ * pixels, like spaces, produce no vertices.
+ *
+ * Vertices and indices are added after the ones already in @p buffer, whose counts are updated. If the
+ * buffer is full, the glyphs that did not fit are left out.
+ *
+ * **Example**
+ * @code
+ * struct vertex { float x, y, u, v; };
+ * struct vertex vertices[4 * 64];
+ * uint16_t indices[6 * 64];
+ * struct fc_vertex_layout layout = {
+ *   sizeof(struct vertex), offsetof(struct vertex, x), offsetof(struct vertex, u),
+ *   FC_VERTEX_UNUSED, FC_VERTEX_UNUSED, fc_index_u16
+ * };
+ * struct fc_vertex_buffer buffer = { vertices, indices, 4 * 64, 0, 0 };
+ * fc_render_vertices(font, (unsigned char const *) "Hello", 5, 10, 40, fc_color_white, &layout, &buffer);
+ * draw_triangles(vertices, buffer.vertex_count, indices, buffer.index_count);
+ * @endcode
+ *
+ * @param font A pointer to a cooked `fc_font`
+ * @param text A pointer to a character array containing the text to render
+ * @param byte_count How many bytes are there in the character array
+ * @param left Where the text should start, horizontally (see ::fc_move)
+ * @param baseline Where the text baseline should be, vertically (see ::fc_move)
+ * @param color The color written to each vertex, if @p layout has a color attribute
+ * @param layout Where each attribute goes in a vertex and which type of index to write
+ * @param buffer Where vertices and indices are written
+ * @return How many glyphs were written
+ * @sa ::fc_render
+ */
+FONT_CHEF_EXPORT extern size_t fc_render_vertices(
+    struct fc_font const * font,
+    unsigned char const * text,
+    size_t byte_count,
+    float left,
+    float baseline,
+    struct fc_color color,
+    struct fc_vertex_layout const * layout,
+    struct fc_vertex_buffer * buffer
+);
+
+/**
+ * @brief Renders text straight into compact instance records, ready for instanced rendering
+ * @ingroup font
+ *
+ * This lays out glyphs just like ::fc_render followed by ::fc_move, and writes a ::fc_glyph_instance for each
+ * glyph, as ::fc_make_instances would, without going through an array of mappings. A whole text can then be
+ * drawn with a single instanced draw call, uploading 14 bytes per glyph.
+ *
+ * **Example**
+ * @code
+ * struct fc_glyph_instance instances[64];
+ * size_t count = fc_render_instances(font, (unsigned char const *) "Hello", 5, 10, 40, instances, 64);
+ * draw_instanced(instances, count);
+ * @endcode
+ *
+ * @param font A pointer to a cooked `fc_font`
+ * @param text A pointer to a character array containing the text to render
+ * @param byte_count How many bytes are there in the character array
+ * @param left Where the text should start, horizontally (see ::fc_move)
+ * @param baseline Where the text baseline should be, vertically (see ::fc_move)
+ * @param instances Where to write instances
+ * @param capacity How many instances fit in @p instances. Glyphs past that are left out
+ * @return How many instances were written
+ * @sa ::fc_make_instances
+ */
+FONT_CHEF_EXPORT extern size_t fc_render_instances(
+    struct fc_font const * font,
+    unsigned char const * text,
+    size_t byte_count,
+    float left,
+    float baseline,
+    struct fc_glyph_instance * instances,
+    size_t capacity
+);
+
+/**
+ * @brief Same as `::fc_render`, but first cooks the codepoints of @p text missing from a dynamic atlas
+ * @ingroup font
+ *
+ * Codepoints that the font has but that were not cooked yet are rasterized into the free space of the
+ * pixels (see `::fc_set_dynamic_atlas`), or into cells of the glyph cache (see `::fc_set_glyph_cache`).
+ * Codepoints that the font does not have are not cooked and are mapped as in `::fc_render`. If the font
+ * is in neither mode, this is the same as `::fc_render`.
+ *
+ * After calling this, check `::fc_get_dirty_rects` to know which parts of the pixels changed and need
+ * to be uploaded again.
+ *
+ * **Example**
+ * @code
+ * struct fc_character_mapping mapping[64];
+ * size_t dirty_count;
+ * struct fc_render_result result = fc_render_dynamic(font, text, text_length, mapping);
+ * for (size_t page = 0; page < fc_get_page_count(font); page++) {
+ *   struct fc_rect const * dirty = fc_get_dirty_rects(font, page, &dirty_count);
+ *   for (size_t i = 0; i < dirty_count; i++) update_texture(textures[page], fc_get_page(font, page), dirty[i]);
+ * }
+ * fc_clear_dirty_rects(font);
+ * @endcode
+ *
+ * @param font A pointer to a `fc_font` value that will be used
+ * @param text A pointer to a character array containing the text to map
+ * @param byte_count How many bytes are there in the character array
+ * @param mapping An array of `fc_character_mapping` values that must be at least `byte_count` long.
+ * @return how many glyphs and lines were produced
+ * @sa ::fc_set_dynamic_atlas
+ * @sa ::fc_set_glyph_cache
+ */
+FONT_CHEF_EXPORT extern struct fc_render_result fc_render_dynamic(
+  struct fc_font * font,
+  unsigned char const * text,
+  size_t byte_count,
+  struct fc_character_mapping * mapping
+);
+
 /**
  * @brief A shortcut for rendering and then wrapping the result.
  * @ingroup font
@@ -247,6 +862,79 @@ FONT_CHEF_EXPORT struct fc_render_result fc_render_wrapped(
     struct fc_character_mapping * mapping
 );
 
+/**
+ * @brief Same as ::fc_render_wrapped, but wraps using a buffer supplied by you instead of allocating memory
+ * @ingroup font
+ *
+ * Use a workspace of at least `fc_wrap_workspace_size(byte_count)` bytes and reuse it across calls to
+ * render and wrap text without any memory allocation. See ::fc_wrap_with_workspace for details.
+ *
+ * @param font A pointer to a `fc_font` value that will be used
+ * @param text A pointer to a character array containing the text to map
+ * @param byte_count How many bytes are there in the character array
+ * @param line_width The maximum line width, in target/screen size (e.g, pixels)
+ * @param line_height_multiplier A value that can be used to increase the line height/spacing
+ * @param alignment Which aligment should lines follow
+ * @param mapping An array of `fc_character_mapping` values that
+ *                       must be at least `byte_count` long.
+ * @param workspace A buffer used while wrapping
+ * @param workspace_size The size of @p workspace in bytes
+ * @return how many glyphs and lines were produced
+ * @sa ::fc_wrap_workspace_size
+ * @sa ::fc_wrap_with_workspace
+ */
+FONT_CHEF_EXPORT struct fc_render_result fc_render_wrapped_with_workspace(
+    struct fc_font const * font,
+    unsigned char const * text,
+    size_t byte_count,
+    size_t line_width,
+    float line_height_multiplier,
+    enum fc_alignment alignment,
+    struct fc_character_mapping * mapping,
+    void * workspace,
+    size_t workspace_size
+);
+
+/**
+ * @brief Renders many texts at once, laying out each of them in its own box
+ * @ingroup font
+ *
+ * This produces the same mappings as calling ::fc_render (or ::fc_render_wrapped) followed by ::fc_move for
+ * each text, but all of them go into a single array, one text right after the other. Use @p spans to know
+ * where the mappings of each text are.
+ *
+ * Texts are split in groups that are rendered in parallel, using the threads or executor set with
+ * ::fc_set_thread_count or ::fc_set_executor.
+ *
+ * **Example**
+ * @code
+ * struct fc_batch_text texts[2] = {
+ *   { (unsigned char const *) "Player 1", 8, { 10, 10, 0, 0 }, fc_align_left },
+ *   { (unsigned char const *) "A longer label that wraps", 25, { 10, 50, 110, 0 }, fc_align_center }
+ * };
+ * struct fc_character_mapping mapping[33];
+ * struct fc_batch_span spans[2];
+ * size_t glyph_count = fc_render_batch(font, texts, 2, mapping, spans);
+ * @endcode
+ *
+ * @param font A pointer to a cooked `fc_font`
+ * @param texts The texts to render
+ * @param text_count How many texts there are
+ * @param mapping An array of `fc_character_mapping` values that must be at least as long as the sum of the
+ *                `byte_count` of every text
+ * @param spans An array of @p text_count values that will hold where the mappings of each text are
+ * @return How many mappings were produced in total
+ * @sa ::fc_render
+ * @sa ::fc_render_wrapped
+ */
+FONT_CHEF_EXPORT extern size_t fc_render_batch(
+    struct fc_font const * font,
+    struct fc_batch_text const * texts,
+    size_t text_count,
+    struct fc_character_mapping * mapping,
+    struct fc_batch_span * spans
+);
+
 /**
  * @brief Destroys and frees all memory allocated by this library.
  * @ingroup font
@@ -290,7 +978,7 @@ FONT_CHEF_EXPORT extern struct fc_color fc_get_color(struct fc_font const * font
  * @ingroup font
  * @warning Font-cache does not know the font data buffer size (because it is irrelevant to it) so it is impossible to return it.
  * @param font The font to get the font data from
- * @return The font data
+ * @return The font data, or `NULL` once a subset font was cooked (see `::fc_set_subset`)
  */
 FONT_CHEF_EXPORT extern uint8_t const * fc_get_font_data(struct fc_font const * font);
 
@@ -313,14 +1001,77 @@ FONT_CHEF_EXPORT extern size_t fc_get_block_count(struct fc_font const * font);
  */
 FONT_CHEF_EXPORT extern struct fc_unicode_block fc_get_block_at(struct fc_font const * font, size_t index);
 
+/**
+ * @brief Returns how many kerning pairs were stored in the kerning table by ::fc_cook
+ * @ingroup font
+ *
+ * Each pair takes 12 bytes. It returns `0` if the font was not cooked yet, if the font has no kerning
+ * or if the kerning table was disabled with ::fc_set_kerning_table.
+ *
+ * @param font The font to get the kerning pair count from
+ * @return The count of kerning pairs stored
+ * @sa ::fc_set_kerning_table
+ */
+FONT_CHEF_EXPORT extern size_t fc_get_kerning_pair_count(struct fc_font const * font);
+
 /**
  * @brief Returns the pixel data after for a font generated after a ::fc_cook was called
  * @ingroup font
+ *
+ * If the glyphs were spread over more than one page (see ::fc_set_max_page_size), this is the first
+ * one. Use ::fc_get_page to get the others.
+ *
  * @param font The font to get the pixel data from
  * @return A value of ::fc_pixels
  */
 FONT_CHEF_EXPORT extern struct fc_pixels const * fc_get_pixels(struct fc_font const * font);
 
+/**
+ * @brief Returns how many pages of pixels were produced by ::fc_cook
+ * @ingroup font
+ * @param font The font to get the page count from
+ * @return The count of pages, `0` if the font was not cooked yet
+ * @sa ::fc_set_max_page_size
+ */
+FONT_CHEF_EXPORT extern size_t fc_get_page_count(struct fc_font const * font);
+
+/**
+ * @brief Returns a page of pixels produced by ::fc_cook
+ * @ingroup font
+ *
+ * Page `0` is the same returned by ::fc_get_pixels.
+ *
+ * @param font The font to get the page from
+ * @param index Which page to get
+ * @return The page pixels or `NULL` if @p index is not less than ::fc_get_page_count
+ * @sa ::fc_set_max_page_size
+ */
+FONT_CHEF_EXPORT extern struct fc_pixels const * fc_get_page(struct fc_font const * font, size_t index);
+
+/**
+ * @brief Returns the areas of a page changed since the last call to ::fc_clear_dirty_rects
+ * @ingroup font
+ *
+ * Only a font in dynamic atlas or glyph cache mode changes its pages after ::fc_cook. Rects are in pixel coordinates
+ * and may overlap. If the page grew or is new, a single rect covering all of it is returned and the
+ * texture must be created again with the new dimensions.
+ *
+ * @param font The font to get the dirty rects from
+ * @param page Which page to get the dirty rects of
+ * @param count Where to store how many rects were returned
+ * @return A pointer to @p count rects, valid until the font changes again
+ * @sa ::fc_set_dynamic_atlas
+ */
+FONT_CHEF_EXPORT extern struct fc_rect const * fc_get_dirty_rects(struct fc_font const * font, size_t page, size_t * count);
+
+/**
+ * @brief Forgets the dirty rects of every page, usually after uploading them
+ * @ingroup font
+ * @param font The font to clear the dirty rects of
+ * @sa ::fc_get_dirty_rects
+ */
+FONT_CHEF_EXPORT extern void fc_clear_dirty_rects(struct fc_font * font);
+
 /**
  * @brief Returns the space glyph width and height for this font at its specified size
  * @ingroup font
@@ -8,6 +8,7 @@
 
 #include "font-chef/font-chef-export.h"
 #include "font-chef/font.h"
+#include "font-chef/cache.h"
 #include <cstring>
 
 #include <string>
@@ -16,8 +17,11 @@
 #include "font-chef/font-size.hpp"
 #include "font-chef/color.hpp"
 #include "font-chef/render-result.hpp"
+#include "font-chef/text-view.hpp"
 
 namespace fc {
+  class atlas;
+
   /**
    * @brief A wrapper class for ::fc_font.
    * @ingroup font
@@ -25,10 +29,18 @@ namespace fc {
    *
    * You can construct a fc::font yourself or you can use fc::from (which is preferred if you are going
    * to use method chaining, see fc::from for an examples).
+   *
+   * Once cooked, its `const` member functions may be called from several threads at the same time
+   * (see the @ref font group for the details).
    */
   class FONT_CHEF_EXPORT font {
     private:
       fc_font * data;
+      friend class atlas;
+      friend font from_file(std::string const & path, fc::font_size const & font_size, fc::color const & font_color);
+      friend font from_owned(uint8_t * font_data, size_t size, fc::font_size const & font_size, fc::color const & font_color);
+
+      explicit font(fc_font * data) : data(data) { }
 
     public:
     /**
@@ -42,14 +54,16 @@ namespace fc {
       /**
        * @brief Copy constructor
        * @warning It does not actually *copy* anything. It reconstructs another fc::font instance with the same steps used to construct the other.
+       * A subset font that was already cooked cannot be copied, and the copy is empty (see operator bool).
        * @param other The other fc::font instance to copy from
        */
       font(font const & other)
-      : data(fc_construct(
-          fc_get_font_data(other.data),
+      : data(fc_construct_sharing(
+          other.data,
           fc_get_font_size(other.data),
           fc_get_color(other.data))
       ) {
+        if (data == nullptr) return;
         size_t block_count = fc_get_block_count(other.data);
         for (size_t i = 0; i < block_count; i++) add(fc_get_block_at(other.data, i));
         if (fc_get_pixels(other.data) != nullptr) cook();
@@ -73,6 +87,14 @@ namespace fc {
         if (data) fc_destruct(data);
       }
 
+      /**
+       * @brief Tells whether this font was constructed, which fc::from_file and fc::from_owned may fail to do
+       * @return `true` if this font can be used
+       */
+      explicit operator bool() const {
+        return data != nullptr;
+      }
+
       /**
        * @brief Adds a new unicode block to be cooked.
        *
@@ -131,6 +153,390 @@ namespace fc {
         return std::move(*this);
       }
 
+      /**
+       * @brief Enables or disables the kerning table built when cooking
+       *
+       * This is the `lvalue` version of this method (objects with a name)
+       *
+       * @param enabled `true` to build the kerning table when cooking, `false` to skip it
+       * @return *this
+       * @sa ::fc_set_kerning_table
+       */
+      font & kerning_table(bool enabled) & {
+        fc_set_kerning_table(data, enabled ? 1 : 0);
+        return *this;
+      }
+
+      /**
+       * @brief Enables or disables the kerning table built when cooking
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @param enabled `true` to build the kerning table when cooking, `false` to skip it
+       * @return *this
+       * @sa ::fc_set_kerning_table
+       */
+      font && kerning_table(bool enabled) && {
+        fc_set_kerning_table(data, enabled ? 1 : 0);
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Makes cooking keep everything rendering needs, so that the font data can be let go of
+       *
+       * This is the `lvalue` version of this method (objects with a name)
+       *
+       * @param enabled `true` to let go of the font data after cooking, `false` to keep it
+       * @return *this
+       * @sa ::fc_set_subset
+       */
+      font & subset(bool enabled) & {
+        fc_set_subset(data, enabled ? 1 : 0);
+        return *this;
+      }
+
+      /**
+       * @brief Makes cooking keep everything rendering needs, so that the font data can be let go of
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @param enabled `true` to let go of the font data after cooking, `false` to keep it
+       * @return *this
+       * @sa ::fc_set_subset
+       */
+      font && subset(bool enabled) && {
+        fc_set_subset(data, enabled ? 1 : 0);
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Sets the format of the pixel data produced when cooking
+       *
+       * This is the `lvalue` version of this method (objects with a name)
+       *
+       * @param format The pixel format to produce
+       * @return *this
+       * @sa ::fc_set_pixel_format
+       */
+      font & pixel_format(fc_pixel_format format) & {
+        fc_set_pixel_format(data, format);
+        return *this;
+      }
+
+      /**
+       * @brief Sets the format of the pixel data produced when cooking
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @param format The pixel format to produce
+       * @return *this
+       * @sa ::fc_set_pixel_format
+       */
+      font && pixel_format(fc_pixel_format format) && {
+        fc_set_pixel_format(data, format);
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Sets the maximum width and height of each page produced when cooking
+       *
+       * This is the `lvalue` version of this method (objects with a name)
+       *
+       * @param max_size The maximum width and height of a page, or `0` for no limit
+       * @return *this
+       * @sa ::fc_set_max_page_size
+       */
+      font & max_page_size(size_t max_size) & {
+        fc_set_max_page_size(data, max_size);
+        return *this;
+      }
+
+      /**
+       * @brief Sets the maximum width and height of each page produced when cooking
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @param max_size The maximum width and height of a page, or `0` for no limit
+       * @return *this
+       * @sa ::fc_set_max_page_size
+       */
+      font && max_page_size(size_t max_size) && {
+        fc_set_max_page_size(data, max_size);
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Sets how many threads may be used to rasterize glyphs when cooking
+       *
+       * This is the `lvalue` version of this method (objects with a name)
+       *
+       * @param thread_count The maximum amount of threads to use
+       * @return *this
+       * @sa ::fc_set_thread_count
+       */
+      font & threads(size_t thread_count) & {
+        fc_set_thread_count(data, thread_count);
+        return *this;
+      }
+
+      /**
+       * @brief Sets how many threads may be used to rasterize glyphs when cooking
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @param thread_count The maximum amount of threads to use
+       * @return *this
+       * @sa ::fc_set_thread_count
+       */
+      font && threads(size_t thread_count) && {
+        fc_set_thread_count(data, thread_count);
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Sets an executor to run the parallel parts of cooking
+       *
+       * This is the `lvalue` version of this method (objects with a name)
+       *
+       * @param executor The executor to use
+       * @return *this
+       * @sa ::fc_set_executor
+       */
+      font & executor(fc_executor executor) & {
+        fc_set_executor(data, executor);
+        return *this;
+      }
+
+      /**
+       * @brief Sets an executor to run the parallel parts of cooking
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @param executor The executor to use
+       * @return *this
+       * @sa ::fc_set_executor
+       */
+      font && executor(fc_executor executor) && {
+        fc_set_executor(data, executor);
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Enables or disables the dynamic atlas mode, where missing glyphs can be cooked after cooking
+       *
+       * This is the `lvalue` version of this method (objects with a name)
+       *
+       * @param enabled `true` to keep the atlas open for new glyphs after cooking
+       * @return *this
+       * @sa ::fc_set_dynamic_atlas
+       */
+      font & dynamic_atlas(bool enabled) & {
+        fc_set_dynamic_atlas(data, enabled ? 1 : 0);
+        return *this;
+      }
+
+      /**
+       * @brief Enables or disables the dynamic atlas mode, where missing glyphs can be cooked after cooking
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @param enabled `true` to keep the atlas open for new glyphs after cooking
+       * @return *this
+       * @sa ::fc_set_dynamic_atlas
+       */
+      font && dynamic_atlas(bool enabled) && {
+        fc_set_dynamic_atlas(data, enabled ? 1 : 0);
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Makes cooking produce a signed distance field atlas, that can be drawn at any size
+       *
+       * This is the `lvalue` version of this method (objects with a name)
+       *
+       * @param padding How many pixels the field reaches out of each glyph, or `0` to cook glyph coverage
+       * @param on_edge_value The value of pixels on glyph outlines
+       * @return *this
+       * @sa ::fc_set_sdf
+       */
+      font & sdf(uint8_t padding, uint8_t on_edge_value = 128) & {
+        fc_set_sdf(data, padding, on_edge_value);
+        return *this;
+      }
+
+      /**
+       * @brief Makes cooking produce a signed distance field atlas, that can be drawn at any size
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @param padding How many pixels the field reaches out of each glyph, or `0` to cook glyph coverage
+       * @param on_edge_value The value of pixels on glyph outlines
+       * @return *this
+       * @sa ::fc_set_sdf
+       */
+      font && sdf(uint8_t padding, uint8_t on_edge_value = 128) && {
+        fc_set_sdf(data, padding, on_edge_value);
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Makes cooking produce a multi-channel signed distance field atlas, that keeps corners sharp at any size
+       *
+       * This is the `lvalue` version of this method (objects with a name)
+       *
+       * @param padding How many pixels the field reaches out of each glyph, or `0` to cook glyph coverage
+       * @param on_edge_value The value of pixels on glyph outlines
+       * @return *this
+       * @sa ::fc_set_msdf
+       */
+      font & msdf(uint8_t padding, uint8_t on_edge_value = 128) & {
+        fc_set_msdf(data, padding, on_edge_value);
+        return *this;
+      }
+
+      /**
+       * @brief Makes cooking produce a multi-channel signed distance field atlas, that keeps corners sharp at any size
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @param padding How many pixels the field reaches out of each glyph, or `0` to cook glyph coverage
+       * @param on_edge_value The value of pixels on glyph outlines
+       * @return *this
+       * @sa ::fc_set_msdf
+       */
+      font && msdf(uint8_t padding, uint8_t on_edge_value = 128) && {
+        fc_set_msdf(data, padding, on_edge_value);
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Enables the glyph cache mode, with a single page of a fixed size
+       *
+       * This is the `lvalue` version of this method (objects with a name)
+       *
+       * @param width The width of the page in pixels, or `0` to disable the glyph cache
+       * @param height The height of the page in pixels, or `0` to disable the glyph cache
+       * @return *this
+       * @sa ::fc_set_glyph_cache
+       */
+      font & glyph_cache(size_t width, size_t height) & {
+        fc_set_glyph_cache(data, width, height);
+        return *this;
+      }
+
+      /**
+       * @brief Enables the glyph cache mode, with a single page of a fixed size
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @param width The width of the page in pixels, or `0` to disable the glyph cache
+       * @param height The height of the page in pixels, or `0` to disable the glyph cache
+       * @return *this
+       * @sa ::fc_set_glyph_cache
+       */
+      font && glyph_cache(size_t width, size_t height) && {
+        fc_set_glyph_cache(data, width, height);
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Starts a new frame of the glyph cache, resetting its counters
+       * @sa ::fc_next_frame
+       */
+      void next_frame() {
+        fc_next_frame(data);
+      }
+
+      /**
+       * @brief Returns the counters of the glyph cache, since the start of the current frame
+       * @return The counters of the glyph cache
+       * @sa ::fc_get_glyph_cache_stats
+       */
+      fc_glyph_cache_stats glyph_cache_stats() const {
+        return fc_get_glyph_cache_stats(data);
+      }
+
+      /**
+       * @brief Sets how many times larger than their size glyphs are rasterized, horizontally and vertically
+       * @param horizontal How many times wider glyphs are rasterized
+       * @param vertical How many times taller glyphs are rasterized
+       * @return *this
+       * @sa ::fc_set_oversampling
+       */
+      font & oversampling(uint8_t horizontal, uint8_t vertical) & {
+        fc_set_oversampling(data, horizontal, vertical);
+        return *this;
+      }
+
+      /**
+       * @brief Sets how many times larger than their size glyphs are rasterized, horizontally and vertically
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @param horizontal How many times wider glyphs are rasterized
+       * @param vertical How many times taller glyphs are rasterized
+       * @return *this
+       * @sa ::fc_set_oversampling
+       */
+      font && oversampling(uint8_t horizontal, uint8_t vertical) && {
+        fc_set_oversampling(data, horizontal, vertical);
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Chooses whether rendered glyphs keep fractional positions instead of being snapped to whole pixels
+       * @param enabled Whether glyphs keep fractional positions
+       * @return *this
+       * @sa ::fc_set_subpixel_positioning
+       */
+      font & subpixel_positioning(bool enabled) & {
+        fc_set_subpixel_positioning(data, enabled);
+        return *this;
+      }
+
+      /**
+       * @brief Chooses whether rendered glyphs keep fractional positions instead of being snapped to whole pixels
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @param enabled Whether glyphs keep fractional positions
+       * @return *this
+       * @sa ::fc_set_subpixel_positioning
+       */
+      font && subpixel_positioning(bool enabled) && {
+        fc_set_subpixel_positioning(data, enabled);
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Returns the areas of a page changed since the last call to clear_dirty_rects
+       * @param page Which page to get the dirty rects of
+       * @return A vector with the dirty rects
+       * @sa ::fc_get_dirty_rects
+       */
+      std::vector<fc_rect> dirty_rects(size_t page = 0) const {
+        size_t count;
+        fc_rect const * rects = fc_get_dirty_rects(data, page, &count);
+        return std::vector<fc_rect>(rects, rects + count);
+      }
+
+      /**
+       * @brief Forgets every dirty rect, usually after uploading them
+       * @sa ::fc_clear_dirty_rects
+       */
+      void clear_dirty_rects() {
+        fc_clear_dirty_rects(data);
+      }
+
+      /**
+       * @brief Returns how many kerning pairs were stored in the kerning table when cooking
+       * @return The count of kerning pairs
+       * @sa ::fc_get_kerning_pair_count
+       */
+      size_t kerning_pair_count() const {
+        return fc_get_kerning_pair_count(data);
+      }
+
       /**
        * @brief Cooks all the added unicode ranges into a pixmap and clipping information
        *
@@ -158,6 +564,65 @@ namespace fc {
         return std::move(*this);
       }
 
+      /**
+       * @brief Loads this font from a cache file, or cooks it and saves the cache file if that fails
+       *
+       * This is the `lvalue` version of this method (objects with a name)
+       *
+       * @param path The path of the cache file
+       * @return *this
+       * @sa ::fc_cook_cached
+       */
+      font & cook_cached(std::string const & path) & {
+        fc_cook_cached(data, path.c_str());
+        return *this;
+      }
+
+      /**
+       * @brief Loads this font from a cache file, or cooks it and saves the cache file if that fails
+       *
+       * This is the `rvalue` version of this method (objects without a name)
+       *
+       * @param path The path of the cache file
+       * @return *this
+       * @sa ::fc_cook_cached
+       */
+      font && cook_cached(std::string const & path) && {
+        fc_cook_cached(data, path.c_str());
+        return std::move(*this);
+      }
+
+      /**
+       * @brief Maps a cache file into memory and loads it in place of cooking
+       * @param path The path of a file saved by save_cache
+       * @return `true` if the cache was loaded, `false` otherwise
+       * @sa ::fc_load_cache_file
+       */
+      bool load_cache(std::string const & path) {
+        return fc_load_cache_file(data, path.c_str()) != 0;
+      }
+
+      /**
+       * @brief Saves the cooked state of this font into a file
+       * @param path The path of the file to write
+       * @return `true` if the file was written, `false` otherwise
+       * @sa ::fc_save_cache_file
+       */
+      bool save_cache(std::string const & path) const {
+        return fc_save_cache_file(data, path.c_str()) != 0;
+      }
+
+      /**
+       * @brief Saves the cooked state of this font into memory
+       * @return The cache, or an empty vector if this font cannot be saved
+       * @sa ::fc_save_cache
+       */
+      std::vector<uint8_t> cache() const {
+        std::vector<uint8_t> result(fc_save_cache(data, nullptr, 0));
+        if (!result.empty()) fc_save_cache(data, result.data(), result.size());
+        return result;
+      }
+
       /**
        * @brief Obtains a structure containing a pointer to the pixel data and it's dimensions
        *
@@ -170,6 +635,25 @@ namespace fc {
         return *fc_get_pixels(data);
       }
 
+      /**
+       * @brief Returns how many pages of pixels were produced when cooking
+       * @return The count of pages
+       * @sa ::fc_get_page_count
+       */
+      size_t page_count() const {
+        return fc_get_page_count(data);
+      }
+
+      /**
+       * @brief Obtains a structure containing a pointer to the pixel data of a page and it's dimensions
+       * @param index Which page to get, from `0` to page_count() - 1
+       * @return a ::fc_pixels value
+       * @sa ::fc_get_page
+       */
+      fc_pixels page(size_t index) const {
+        return *fc_get_page(data, index);
+      }
+
       /**
        * @brief Produces clipping and target rectangles to render specified text
        *
@@ -187,16 +671,108 @@ namespace fc {
        * @sa ::fc_render
        * @sa ::fc::render_result
        */
-      fc::render_result render(std::string const & text) const {
+      fc::render_result render(fc::text_view text) const {
         fc::render_result result(data);
         return std::move(render(text, result));
       }
 
+      /**
+       * @brief Renders text straight into vertex and index buffers, ready to be drawn by a GPU
+       *
+       * @param text The text to render
+       * @param layout Where each attribute goes in a vertex and which type of index to write
+       * @param buffer Where vertices and indices are written, after the ones already there
+       * @param left Where the text should start, horizontally
+       * @param baseline Where the text baseline should be, vertically
+       * @param color The color written to each vertex, if @p layout has a color attribute
+       * @return How many glyphs were written
+       * @sa ::fc_render_vertices
+       */
+      size_t render_vertices(
+          fc::text_view text,
+          fc_vertex_layout const & layout,
+          fc_vertex_buffer & buffer,
+          float left = 0.0f,
+          float baseline = 0.0f,
+          fc::color const & color = fc_color_white
+      ) const {
+        return fc_render_vertices(
+            data, text.data, text.size, left, baseline, color.data, &layout, &buffer
+        );
+      }
+
+      /**
+       * @brief Renders text straight into compact instance records, ready for instanced rendering
+       *
+       * @param text The text to render
+       * @param instances Where to store the instance records. Its previous contents are replaced
+       * @param left Where the text should start, horizontally
+       * @param baseline Where the text baseline should be, vertically
+       * @return The same vector passed in @p instances
+       * @sa ::fc_render_instances
+       * @sa fc::render_result::instances
+       */
+      std::vector<fc_glyph_instance> & render_instances(
+          fc::text_view text,
+          std::vector<fc_glyph_instance> & instances,
+          float left = 0.0f,
+          float baseline = 0.0f
+      ) const {
+        instances.resize(text.size);
+        instances.resize(fc_render_instances(
+            data, text.data, text.size, left, baseline, instances.data(), instances.size()
+        ));
+        return instances;
+      }
+
+      /**
+       * @brief Renders many texts at once, laying out each of them in its own box
+       *
+       * @param texts The texts to render
+       * @return An instance of fc::batch_result
+       * @sa ::fc_render_batch
+       */
+      fc::batch_result render_batch(std::vector<fc_batch_text> const & texts) const {
+        fc::batch_result result;
+        render_batch(texts, result);
+        return result;
+      }
+
+      /**
+       * @brief Renders many texts at once reusing an instance of fc::batch_result
+       *
+       * The vectors in @p result will be reallocated only if they are too small.
+       *
+       * @param texts The texts to render
+       * @param result An instance of fc::batch_result to reuse
+       * @return @p result
+       * @sa ::fc_render_batch
+       */
+      fc::batch_result & render_batch(std::vector<fc_batch_text> const & texts, fc::batch_result & result) const {
+        size_t byte_count = 0;
+        for (auto const & text : texts) byte_count += text.byte_count;
+        result.mapping.resize(byte_count);
+        result.spans.resize(texts.size());
+        size_t glyph_count = fc_render_batch(data, texts.data(), texts.size(), result.mapping.data(), result.spans.data());
+        result.mapping.resize(glyph_count);
+        return result;
+      }
+
       /**
        * @brief Produces clipping and target rectangles to render specified text reusing an instance of fc::render_result
        *
        * You can use this function if you already have an instance of fc::render_result and
-       * want to reuse it without allocating a new one. The vector will be reallocated if needed.
+       * want to reuse it without allocating a new one. The vector keeps its capacity from one call to
+       * the next and only grows when a text has more bytes than any before it, so rendering text that
+       * changes every frame does not allocate memory once the vector is large enough. Growing it does
+       * not zero the new mappings either (see fc::default_init_allocator).
+       *
+       * **Example**
+       * @code
+       * fc::render_result result; // reused every frame
+       * std::string_view line = ...; // or a std::string, a string literal, a std::u8string_view, etc.
+       * font.render(line, result).move(0.0f, 50.0f);
+       * @endcode
        *
        * @param text The text to render
        * @param result The fc::render_result instance to reuse
@@ -205,11 +781,72 @@ namespace fc {
        * @sa ::fc::render_result
        * @sa ::fc::font::render
        */
-      fc::render_result & render(std::string const & text, fc::render_result & result) const {
+      fc::render_result & render(fc::text_view text, fc::render_result & result) const {
         result.font = data;
-        std::vector<fc_character_mapping> & mapping = result.mapping;
-        if (mapping.size() < text.length()) mapping.resize(text.length());
-        struct fc_render_result r = fc_render(data, (uint8_t *) text.data(), text.size(), mapping.data());
+        fc::mapping_vector & mapping = result.mapping;
+        if (mapping.size() < text.size) mapping.resize(text.size);
+        struct fc_render_result r = fc_render(data, text.data, text.size, mapping.data());
+        mapping.resize(r.glyph_count);
+        result.line_count = r.line_count;
+        return result;
+      }
+
+      /**
+       * @brief Produces clipping and target rectangles to render specified text, as a structure of arrays
+       *
+       * @param text The text to render
+       * @return An instance of fc::glyph_arrays
+       * @sa ::fc_render_arrays
+       */
+      fc::glyph_arrays render_arrays(fc::text_view text) const {
+        fc::glyph_arrays result(data);
+        return std::move(render(text, result));
+      }
+
+      /**
+       * @brief Produces clipping and target rectangles to render specified text reusing an instance of fc::glyph_arrays
+       *
+       * The arrays are only reallocated when they are too small for @p text.
+       *
+       * @param text The text to render
+       * @param result The fc::glyph_arrays instance to reuse
+       * @return The same fc::glyph_arrays reference passed in @p result argument.
+       * @sa ::fc_render_arrays
+       */
+      fc::glyph_arrays & render(fc::text_view text, fc::glyph_arrays & result) const {
+        result.font = data;
+        result.line_count = fc_render_arrays(data, text.data, text.size, &result.data).line_count;
+        return result;
+      }
+
+      /**
+       * @brief Same as render, but first cooks the codepoints missing from a dynamic atlas
+       *
+       * @param text The text to render
+       * @return An instance of fc::render_result
+       * @sa ::fc_render_dynamic
+       * @sa ::fc::font::dynamic_atlas
+       */
+      fc::render_result render_dynamic(fc::text_view text) {
+        fc::render_result result(data);
+        return std::move(render_dynamic(text, result));
+      }
+
+      /**
+       * @brief Same as render, but first cooks the codepoints missing from a dynamic atlas, reusing an
+       * instance of fc::render_result
+       *
+       * @param text The text to render
+       * @param result The fc::render_result instance to reuse
+       * @return The same fc::render_result reference passed in @p result argument.
+       * @sa ::fc_render_dynamic
+       * @sa ::fc::font::dynamic_atlas
+       */
+      fc::render_result & render_dynamic(fc::text_view text, fc::render_result & result) {
+        result.font = data;
+        fc::mapping_vector & mapping = result.mapping;
+        if (mapping.size() < text.size) mapping.resize(text.size);
+        struct fc_render_result r = fc_render_dynamic(data, text.data, text.size, mapping.data());
         mapping.resize(r.glyph_count);
         result.line_count = r.line_count;
         return result;
@@ -239,6 +876,40 @@ namespace fc {
     font r(font_data, font_size, font_color);
     return r;
   }
+
+  /**
+   * @brief Same as fc::from, but maps a font file into memory instead of taking its data
+   * @ingroup cpp
+   *
+   * **Example**
+   * @code
+   * auto font = fc::from_file("times.ttf", fc::px(12), fc::rgb(255, 0, 0));
+   * if (font) font.add(fc_basic_latin).cook();
+   * @endcode
+   *
+   * @param path The path of the font file
+   * @param font_size The size of the font, either in fc::px or fc::pt
+   * @param font_color The color of the font
+   * @return A fc::font instance, which is empty (see fc::font::operator bool) if the file cannot be mapped or is not a font
+   * @sa ::fc_construct_from_file
+   */
+  FONT_CHEF_EXPORT inline font from_file(std::string const & path, fc::font_size const & font_size, fc::color const & font_color) {
+    return font(fc_construct_from_file(path.c_str(), font_size.data, font_color.data));
+  }
+
+  /**
+   * @brief Same as fc::from, but the font takes ownership of its data and frees it once it is no longer needed
+   * @ingroup cpp
+   * @param font_data The font data in memory, allocated with `malloc`
+   * @param size The size of @p font_data in bytes
+   * @param font_size The size of the font, either in fc::px or fc::pt
+   * @param font_color The color of the font
+   * @return A fc::font instance, which is empty (see fc::font::operator bool) if @p font_data is not a font
+   * @sa ::fc_construct_owned
+   */
+  FONT_CHEF_EXPORT inline font from_owned(uint8_t * font_data, size_t size, fc::font_size const & font_size, fc::color const & font_color) {
+    return font(fc_construct_owned(font_data, size, font_size.data, font_color.data));
+  }
 }
 
 #endif //FONT_CHEF_FONT_HPP
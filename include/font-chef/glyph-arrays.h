@@ -0,0 +1,166 @@
+#ifndef FONT_CHEF_GLYPH_ARRAYS_H
+#define FONT_CHEF_GLYPH_ARRAYS_H
+
+/**
+ * @file glyph-arrays.h
+ * This file contains the fc_glyph_arrays structure, which holds the same information as an array of
+ * ::fc_character_mapping, one field per array.
+ */
+
+#include "font-chef/font-chef-export.h"
+#include "font-chef/character-mapping.h"
+#include "font-chef/rect.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Render results stored as a structure of arrays
+ * @ingroup character-mapping
+ *
+ * Glyph `i` has its target rectangle in `left[i]`, `top[i]`, `right[i]` and `bottom[i]`, its source rectangle in
+ * `sources[i]`, its codepoint in `codepoints[i]` and its page in `pages[i]`, just like the fields of a
+ * ::fc_character_mapping.
+ *
+ * Moving, measuring and wrapping text only look at target rectangles. With an array of ::fc_character_mapping
+ * they have to read (and write) every mapping in full, while these arrays let them go through target
+ * coordinates alone, many glyphs at a time. Prefer them for long texts, that are laid out again often.
+ *
+ * Every array is aligned to 32 bytes. Use ::fc_render_arrays to fill them (which makes room as needed) and
+ * ::fc_free_arrays to release them.
+ *
+ * **Example**
+ * @code
+ * struct fc_glyph_arrays arrays = { 0 };
+ * struct fc_size space = fc_get_space_metrics(font);
+ * fc_render_arrays(font, text, byte_count, &arrays);
+ * fc_wrap_arrays(&arrays, 400, space.height, space.width, fc_align_left, NULL, 0);
+ * fc_move_arrays(&arrays, 20, 40);
+ * for (size_t i = 0; i < arrays.count; i++) {
+ *   draw(arrays.sources[i], arrays.left[i], arrays.top[i], arrays.right[i], arrays.bottom[i]);
+ * }
+ * fc_free_arrays(&arrays);
+ * @endcode
+ */
+struct fc_glyph_arrays {
+  /**
+   * @brief The left side of each target rectangle
+   */
+  float * left;
+
+  /**
+   * @brief The top side of each target rectangle
+   */
+  float * top;
+
+  /**
+   * @brief The right side of each target rectangle
+   */
+  float * right;
+
+  /**
+   * @brief The bottom side of each target rectangle
+   */
+  float * bottom;
+
+  /**
+   * @brief The source rectangle of each glyph, in pixels of its page
+   */
+  struct fc_rect * sources;
+
+  /**
+   * @brief The codepoint of each glyph
+   */
+  uint32_t * codepoints;
+
+  /**
+   * @brief The page of each glyph (see ::fc_get_page)
+   */
+  uint32_t * pages;
+
+  /**
+   * @brief How many glyphs there are
+   */
+  size_t count;
+
+  /**
+   * @brief How many glyphs fit in the arrays
+   */
+  size_t capacity;
+
+  /**
+   * @brief The memory that holds every array
+   */
+  void * memory;
+};
+
+/**
+ * @brief Makes sure there is room for at least @p capacity glyphs in @p arrays
+ * @ingroup character-mapping
+ *
+ * The glyphs already in @p arrays are kept. Zero-initialize a ::fc_glyph_arrays before using it for the first time.
+ *
+ * @param arrays A pointer to a ::fc_glyph_arrays
+ * @param capacity How many glyphs should fit in the arrays
+ * @return `1` if there is enough room, `0` if memory could not be allocated (@p arrays is left as it was)
+ */
+FONT_CHEF_EXPORT extern uint8_t fc_reserve_arrays(struct fc_glyph_arrays * arrays, size_t capacity);
+
+/**
+ * @brief Releases the memory of @p arrays, leaving it empty
+ * @ingroup character-mapping
+ * @param arrays A pointer to a ::fc_glyph_arrays
+ */
+FONT_CHEF_EXPORT extern void fc_free_arrays(struct fc_glyph_arrays * arrays);
+
+/**
+ * @brief Same as ::fc_move, for glyphs stored in a ::fc_glyph_arrays
+ * @ingroup character-mapping
+ * @param arrays The glyphs to move
+ * @param left Left position where the text should start rendering
+ * @param baseline Amount to add to the text baseline
+ */
+FONT_CHEF_EXPORT extern void fc_move_arrays(struct fc_glyph_arrays * arrays, float left, float baseline);
+
+/**
+ * @brief Same as ::fc_text_bounds, for glyphs stored in a ::fc_glyph_arrays
+ * @ingroup character-mapping
+ * @param arrays The glyphs to measure
+ * @return A `fc_rect` value with left, top, right and bottom values enclosing the text area
+ */
+FONT_CHEF_EXPORT extern struct fc_rect fc_text_bounds_arrays(struct fc_glyph_arrays const * arrays);
+
+/**
+ * @brief Same as ::fc_wrap_with_workspace, for glyphs stored in a ::fc_glyph_arrays
+ * @ingroup character-mapping
+ *
+ * This produces the same target rectangles as ::fc_wrap_with_workspace does with the same glyphs in an array of
+ * ::fc_character_mapping. The workspace is also the same, see ::fc_wrap_workspace_size.
+ *
+ * @param arrays The glyphs to wrap
+ * @param line_width The maximum line width, in target/screen size (e.g, pixels)
+ * @param line_height The space between the topmost pixel in the line to the bottomost pixel in the line (this includes characters in the line itself)
+ * @param space_width The width of a space character
+ * @param alignment Which aligment should lines follow
+ * @param workspace A buffer that this function can use as it sees fit while it runs, or `NULL`
+ * @param workspace_size The size of @p workspace in bytes
+ * @return The line count in the text
+ */
+FONT_CHEF_EXPORT extern uint32_t fc_wrap_arrays(
+    struct fc_glyph_arrays * arrays,
+    float line_width,
+    float line_height,
+    float space_width,
+    enum fc_alignment alignment,
+    void * workspace,
+    size_t workspace_size
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FONT_CHEF_GLYPH_ARRAYS_H */
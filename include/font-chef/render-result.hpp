@@ -1,8 +1,14 @@
 #ifndef FONT_CHEF_RENDER_RESULT_HPP
 #define FONT_CHEF_RENDER_RESULT_HPP
 
+#include "font-chef/blit.h"
 #include "font-chef/character-mapping.h"
+#include "font-chef/color.hpp"
 #include "font-chef/font.h"
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 
@@ -14,7 +20,74 @@
 namespace fc {
 
   /**
-   * @brief Wraps a `std::vector<fc_character_mapping>`.
+   * @brief An allocator that default-initializes elements instead of value-initializing them
+   * @ingroup cpp
+   *
+   * Growing a vector of plain structures with this allocator (e.g, with `resize`) leaves the new elements
+   * uninitialized instead of zeroing them, which is wasted work for buffers that are about to be overwritten.
+   * Everything else is left to @p Allocator.
+   *
+   * @tparam T The type of the elements
+   * @tparam Allocator The allocator that gets the memory
+   */
+  template <typename T, typename Allocator = std::allocator<T>>
+  struct default_init_allocator : Allocator {
+    /**
+     * @brief The same allocator, for elements of another type
+     * @tparam U The type of the elements
+     */
+    template <typename U>
+    struct rebind {
+      /** @brief The allocator for elements of type @p U */
+      using other = default_init_allocator<
+          U, typename std::allocator_traits<Allocator>::template rebind_alloc<U>
+      >;
+    };
+
+    using Allocator::Allocator;
+
+    /** @brief Constructs an allocator */
+    default_init_allocator() = default;
+
+    /**
+     * @brief Constructs an allocator from one for elements of another type
+     * @param other The allocator to construct from
+     */
+    template <typename U, typename OtherAllocator>
+    default_init_allocator(default_init_allocator<U, OtherAllocator> const & other) noexcept //NOLINT
+        : Allocator(static_cast<OtherAllocator const &>(other)) { }
+
+    /**
+     * @brief Default-initializes an element
+     * @param p Where to construct the element
+     */
+    template <typename U>
+    void construct(U * p) noexcept(std::is_nothrow_default_constructible<U>::value) {
+      ::new (static_cast<void *>(p)) U;
+    }
+
+    /**
+     * @brief Constructs an element from @p args, like @p Allocator would
+     * @param p Where to construct the element
+     * @param args The arguments of the constructor
+     */
+    template <typename U, typename... Args>
+    void construct(U * p, Args && ... args) {
+      std::allocator_traits<Allocator>::construct(static_cast<Allocator &>(*this), p, std::forward<Args>(args)...);
+    }
+  };
+
+  /**
+   * @brief The vector fc::render_result and fc::batch_result keep their glyphs in
+   * @ingroup cpp
+   *
+   * It only differs from a `std::vector<fc_character_mapping>` in its allocator (see fc::default_init_allocator),
+   * so that growing it does not zero mappings that are overwritten right away.
+   */
+  using mapping_vector = std::vector<::fc_character_mapping, default_init_allocator<::fc_character_mapping>>;
+
+  /**
+   * @brief Wraps a vector of ::fc_character_mapping (see fc::mapping_vector).
    * @ingroup character-mapping
    *
    * It's mainly a quality of life improvement over working with a vector directly. It supports move semantics
@@ -30,7 +103,7 @@ namespace fc {
     /**
      * @brief A vector of character mappings produced after calling fc::font::render
      */
-    std::vector<::fc_character_mapping> mapping;
+    fc::mapping_vector mapping;
 
     /**
      * @brief How many lines were produced
@@ -52,8 +125,8 @@ namespace fc {
      * @param mapping A movable reference to a vector of character mappings
      * @sa fc::font::render
      */
-    render_result(fc_font * font = nullptr, std::vector<fc_character_mapping> && mapping = {}) //NOLINT
-        : mapping(mapping), font(font), line_count(0) {
+    render_result(fc_font * font = nullptr, fc::mapping_vector && mapping = {}) //NOLINT
+        : mapping(std::move(mapping)), line_count(0), font(font) {
     };
 
     /**
@@ -61,7 +134,7 @@ namespace fc {
      * @param other A rvalue (moveable) ref to a fc::render_result instance
      */
     render_result(render_result && other) noexcept
-      : mapping(std::move(other.mapping)), font(other.font), line_count(other.line_count) {
+      : mapping(std::move(other.mapping)), line_count(other.line_count), font(other.font) {
       other.font = nullptr;
     };
 
@@ -151,6 +224,71 @@ namespace fc {
       return std::move(wrap(line_width, line_height_multiplier, alignment));
     }
 
+    /**
+     * @brief Calls ::fc_wrap_with_workspace on the vector of character mappings
+     *
+     * Same as the other fc::render_result::wrap, but @p workspace is used instead of allocating memory on every call.
+     * It is grown when it is too small, so reusing the same vector avoids memory allocations altogether.
+     *
+     * This is the lvalue version of this function.
+     *
+     * **Example**
+     * @code
+     * std::vector<uint8_t> workspace; // reused every frame
+     * fc::render_result result; // reused every frame
+     * font.render("Hello world!", result).wrap(workspace, 80.0f);
+     * @endcode
+     *
+     * @param workspace A vector used as a workspace while wrapping
+     * @param line_width The maximum line width, in target/screen size (e.g, pixels)
+     * @param line_height_multiplier A value that can be used to increase the line height/spacing
+     * @param alignment Which aligment should lines follow
+     * @return *this
+     */
+    render_result & wrap(
+        std::vector<uint8_t> & workspace,
+        float line_width,
+        float line_height_multiplier = 1.0f,
+        fc_alignment alignment = fc_align_left
+    ) & {
+      if (!font) return *this;
+      size_t workspace_size = fc_wrap_workspace_size(mapping.size());
+      if (workspace.size() < workspace_size) workspace.resize(workspace_size);
+      fc_size space_metrics = fc_get_space_metrics(font);
+      this->line_count = fc_wrap_with_workspace(
+          mapping.data(),
+          mapping.size(),
+          line_width,
+          space_metrics.height,
+          space_metrics.width * line_height_multiplier,
+          alignment,
+          workspace.data(),
+          workspace.size()
+      );
+      return *this;
+    }
+
+    /**
+     * @brief Calls ::fc_wrap_with_workspace on the vector of character mappings
+     *
+     * This is the rvalue version of this function and returns a moveable *this. It is here mainly to assist
+     * in method chaining.
+     *
+     * @param workspace A vector used as a workspace while wrapping
+     * @param line_width The maximum line width, in target/screen size (e.g, pixels)
+     * @param line_height_multiplier A value that can be used to increase the line height/spacing
+     * @param alignment Which aligment should lines follow
+     * @return *this
+     */
+    render_result && wrap(
+        std::vector<uint8_t> & workspace,
+        float line_width,
+        float line_height_multiplier = 1.0f,
+        fc_alignment alignment = fc_align_left
+    ) && {
+      return std::move(wrap(workspace, line_width, line_height_multiplier, alignment));
+    }
+
 
     /**
      * @brief This is a wrapper to ::fc_move. Consult its documentation for more information.
@@ -189,11 +327,104 @@ namespace fc {
       return std::move(move(left, baseline));
     }
 
+    /**
+     * @brief This is a wrapper to ::fc_scale. Consult its documentation for more information.
+     *
+     * This is the lvalue (non-moveable) version of this function
+     *
+     * **Example**
+     * @code
+     * fc::font font; // suppose a font cooked at 32 pixels as a signed distance field
+     * auto result = font.render("Hello world!").scale(96.0f / 32.0f).move(0.0f, 150.0f);
+     * @endcode
+     *
+     * @param scale How much bigger (or smaller, when less than `1`) the text should be
+     */
+    render_result & scale(float scale) & {
+      fc_scale(mapping.data(), mapping.size(), scale);
+      return *this;
+    }
+
+    /**
+     * @brief This is a wrapper to ::fc_scale. Consult its documentation for more information.
+     *
+     * This is the rvalue (moveable) version of this function mainly to be used with method chaining.
+     *
+     * @param scale How much bigger (or smaller, when less than `1`) the text should be
+     */
+    render_result && scale(float scale) && {
+      return std::move(this->scale(scale));
+    }
+
+    /**
+     * @brief This is a wrapper to ::fc_make_instances. Consult its documentation for more information.
+     *
+     * **Example**
+     * @code
+     * fc::font font; // suppose a font that has already been cooked
+     * std::vector<fc_glyph_instance> instances = font.render("Hello world!").wrap(80.0f).move(0.0f, 50.0f).instances();
+     * @endcode
+     *
+     * @return One compact instance record for each glyph with pixels
+     */
+    std::vector<::fc_glyph_instance> instances() const {
+      std::vector<::fc_glyph_instance> result;
+      instances(result);
+      return result;
+    }
+
+    /**
+     * @brief This is a wrapper to ::fc_make_instances, reusing the memory of @p result
+     * @param result Where to store the instance records. Its previous contents are replaced
+     * @return The same vector passed in @p result
+     */
+    std::vector<::fc_glyph_instance> & instances(std::vector<::fc_glyph_instance> & result) const {
+      result.resize(mapping.size());
+      result.resize(fc_make_instances(mapping.data(), mapping.size(), result.data()));
+      return result;
+    }
+
+    /**
+     * @brief This is a wrapper to ::fc_blit. Consult its documentation for more information.
+     *
+     * **Example**
+     * @code
+     * fc::font font; // suppose a font that has already been cooked
+     * std::vector<uint8_t> pixels(640 * 480 * 4);
+     * fc_framebuffer framebuffer = { pixels.data(), 640, 480, 0 };
+     * font.render("Hello world!").move(10.0f, 40.0f).blit(framebuffer);
+     * @endcode
+     *
+     * @param framebuffer Where to draw the glyphs
+     * @param color The color to tint glyphs with
+     * @return *this
+     */
+    render_result const & blit(::fc_framebuffer const & framebuffer, fc::color const & color = fc_color_white) const {
+      if (font) fc_blit(font, mapping.data(), mapping.size(), &framebuffer, nullptr, color.data);
+      return *this;
+    }
+
+    /**
+     * @brief This is a wrapper to ::fc_blit that only draws inside @p clip
+     * @param framebuffer Where to draw the glyphs
+     * @param clip Only pixels inside this rectangle are drawn
+     * @param color The color to tint glyphs with
+     * @return *this
+     */
+    render_result const & blit(
+        ::fc_framebuffer const & framebuffer,
+        ::fc_rect const & clip,
+        fc::color const & color = fc_color_white
+    ) const {
+      if (font) fc_blit(font, mapping.data(), mapping.size(), &framebuffer, &clip, color.data);
+      return *this;
+    }
+
     /**
      * @brief Returns an iterator pointing to the first character mapping
      * @return mapping.begin();
      */
-    std::vector<::fc_character_mapping>::iterator begin() {
+    fc::mapping_vector::iterator begin() {
       return mapping.begin();
     }
 
@@ -201,7 +432,7 @@ namespace fc {
      * @brief Returns an iterator pointing to the end+1 character mapping
      * @return mapping.end();
      */
-    std::vector<::fc_character_mapping>::iterator end() {
+    fc::mapping_vector::iterator end() {
       return mapping.end();
     }
 
@@ -213,6 +444,233 @@ namespace fc {
       return mapping.size();
     }
   };
+
+  /**
+   * @brief Wraps a ::fc_glyph_arrays, owning its memory
+   * @ingroup character-mapping
+   *
+   * This is the structure of arrays counterpart of fc::render_result: moving, measuring and wrapping go through
+   * target coordinates alone. It can be moved but not copied.
+   *
+   * **Example**
+   * @code
+   * fc::font font; // suppose a font that has already been cooked
+   * fc::glyph_arrays result = font.render_arrays(long_text).wrap(400.0f).move(0.0f, 50.0f);
+   * for (size_t i = 0; i < result.size(); i++) {
+   *   draw(result.data.sources[i], result.data.left[i], result.data.top[i], result.data.right[i], result.data.bottom[i]);
+   * }
+   * @endcode
+   */
+  struct FONT_CHEF_EXPORT glyph_arrays {
+    /**
+     * @brief The glyphs, one field per array
+     */
+    ::fc_glyph_arrays data;
+
+    /**
+     * @brief How many lines were produced
+     */
+    uint32_t line_count;
+
+    /**
+     * @brief A pointer to the ::fc_font used to render these glyphs
+     */
+    fc_font * font;
+
+    /**
+     * @brief Constructs an empty fc::glyph_arrays instance
+     * @param font The font used to render glyphs into it
+     */
+    explicit glyph_arrays(fc_font * font = nullptr) : data(), line_count(0), font(font) {
+    }
+
+    /**
+     * @brief Move constructor of fc::glyph_arrays
+     * @param other A rvalue (moveable) ref to a fc::glyph_arrays instance
+     */
+    glyph_arrays(glyph_arrays && other) noexcept : data(other.data), line_count(other.line_count), font(other.font) {
+      other.data = ::fc_glyph_arrays();
+      other.font = nullptr;
+    }
+
+    /**
+     * @brief Move assignment operator for fc::glyph_arrays
+     * @param other A rvalue (moveable) ref to a fc::glyph_arrays instance
+     * @return *this
+     */
+    glyph_arrays & operator=(glyph_arrays && other) noexcept {
+      if (this == &other) return *this;
+      fc_free_arrays(&data);
+      data = other.data;
+      line_count = other.line_count;
+      font = other.font;
+      other.data = ::fc_glyph_arrays();
+      other.font = nullptr;
+      return *this;
+    }
+
+    glyph_arrays(glyph_arrays const &) = delete;
+    glyph_arrays & operator=(glyph_arrays const &) = delete;
+
+    /**
+     * @brief Releases the arrays
+     */
+    ~glyph_arrays() {
+      fc_free_arrays(&data);
+    }
+
+    /**
+     * @brief Calls ::fc_wrap_arrays on the glyphs
+     *
+     * This produces the same target rectangles as fc::render_result::wrap.
+     *
+     * @param line_width The maximum line width, in target/screen size (e.g, pixels)
+     * @param line_height_multiplier A value that can be used to increase the line height/spacing
+     * @param alignment Which aligment should lines follow
+     * @return *this
+     */
+    glyph_arrays &
+    wrap(float line_width, float line_height_multiplier = 1.0f, fc_alignment alignment = fc_align_left) & {
+      if (!font) return *this;
+      fc_size space_metrics = fc_get_space_metrics(font);
+      line_count = fc_wrap_arrays(
+          &data, line_width, space_metrics.height, space_metrics.width * line_height_multiplier, alignment, nullptr, 0
+      );
+      return *this;
+    }
+
+    /**
+     * @brief Calls ::fc_wrap_arrays on the glyphs
+     *
+     * This is the rvalue version of this function and returns a moveable *this.
+     *
+     * @param line_width The maximum line width, in target/screen size (e.g, pixels)
+     * @param line_height_multiplier A value that can be used to increase the line height/spacing
+     * @param alignment Which aligment should lines follow
+     * @return *this
+     */
+    glyph_arrays &&
+    wrap(float line_width, float line_height_multiplier = 1.0f, fc_alignment alignment = fc_align_left) && {
+      return std::move(wrap(line_width, line_height_multiplier, alignment));
+    }
+
+    /**
+     * @brief Calls ::fc_wrap_arrays on the glyphs, using @p workspace instead of allocating memory
+     *
+     * @param workspace A vector used as a workspace while wrapping, grown when it is too small
+     * @param line_width The maximum line width, in target/screen size (e.g, pixels)
+     * @param line_height_multiplier A value that can be used to increase the line height/spacing
+     * @param alignment Which aligment should lines follow
+     * @return *this
+     */
+    glyph_arrays & wrap(
+        std::vector<uint8_t> & workspace,
+        float line_width,
+        float line_height_multiplier = 1.0f,
+        fc_alignment alignment = fc_align_left
+    ) & {
+      if (!font) return *this;
+      size_t workspace_size = fc_wrap_workspace_size(data.count);
+      if (workspace.size() < workspace_size) workspace.resize(workspace_size);
+      fc_size space_metrics = fc_get_space_metrics(font);
+      line_count = fc_wrap_arrays(
+          &data,
+          line_width,
+          space_metrics.height,
+          space_metrics.width * line_height_multiplier,
+          alignment,
+          workspace.data(),
+          workspace.size()
+      );
+      return *this;
+    }
+
+    /**
+     * @brief Calls ::fc_wrap_arrays on the glyphs, using @p workspace instead of allocating memory
+     *
+     * This is the rvalue version of this function and returns a moveable *this.
+     *
+     * @param workspace A vector used as a workspace while wrapping, grown when it is too small
+     * @param line_width The maximum line width, in target/screen size (e.g, pixels)
+     * @param line_height_multiplier A value that can be used to increase the line height/spacing
+     * @param alignment Which aligment should lines follow
+     * @return *this
+     */
+    glyph_arrays && wrap(
+        std::vector<uint8_t> & workspace,
+        float line_width,
+        float line_height_multiplier = 1.0f,
+        fc_alignment alignment = fc_align_left
+    ) && {
+      return std::move(wrap(workspace, line_width, line_height_multiplier, alignment));
+    }
+
+    /**
+     * @brief This is a wrapper to ::fc_move_arrays
+     * @param left Left position where the text should start rendering
+     * @param baseline Amount to add to the text baseline
+     * @return *this
+     */
+    glyph_arrays & move(float left = 0.0f, float baseline = 0.0f) & {
+      fc_move_arrays(&data, left, baseline);
+      return *this;
+    }
+
+    /**
+     * @brief This is a wrapper to ::fc_move_arrays
+     *
+     * This is the rvalue version of this function and returns a moveable *this.
+     *
+     * @param left Left position where the text should start rendering
+     * @param baseline Amount to add to the text baseline
+     * @return *this
+     */
+    glyph_arrays && move(float left = 0.0f, float baseline = 0.0f) && {
+      return std::move(move(left, baseline));
+    }
+
+    /**
+     * @brief This is a wrapper to ::fc_text_bounds_arrays
+     * @return A rectangle enclosing the text area
+     */
+    fc_rect bounds() const {
+      return fc_text_bounds_arrays(&data);
+    }
+
+    /**
+     * @brief Returns how many glyphs there are
+     * @return data.count
+     */
+    size_t size() const {
+      return data.count;
+    }
+  };
+
+  /**
+   * @brief Holds the result of fc::font::render_batch: the mappings of every text and where each of them are
+   * @ingroup character-mapping
+   *
+   * **Example**
+   * @code
+   * fc::font font; // suppose a font that has already been cooked
+   * fc::batch_result result = font.render_batch(texts);
+   * for (size_t i = 0; i < result.spans.size(); i++) {
+   *   fc_character_mapping const * text_mapping = result.mapping.data() + result.spans[i].first;
+   *   // draw result.spans[i].glyph_count mappings
+   * }
+   * @endcode
+   */
+  struct FONT_CHEF_EXPORT batch_result {
+    /**
+     * @brief The mappings of every text, one text right after the other
+     */
+    fc::mapping_vector mapping;
+
+    /**
+     * @brief Where the mappings of each text are
+     */
+    std::vector<::fc_batch_span> spans;
+  };
 }
 
 #endif
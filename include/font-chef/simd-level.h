@@ -0,0 +1,71 @@
+#ifndef FONT_CHEF_SIMD_LEVEL_H
+#define FONT_CHEF_SIMD_LEVEL_H
+
+/**
+ * @file simd-level.h
+ * This file provides functions to know (and choose) which vector instructions font-chef uses to lay out text.
+ */
+
+/**
+ * @defgroup simd-level SIMD level
+ * Functions and types that deal with the vector instructions used by font-chef
+ *
+ * Functions that go through many glyphs at once (::fc_move, ::fc_text_bounds, ::fc_move_arrays,
+ * ::fc_text_bounds_arrays and ::fc_wrap_arrays) have a scalar implementation and one for each of these
+ * instruction sets. The best one the CPU supports is picked the first time one of them runs. All of them produce
+ * exactly the same results.
+ */
+
+#include "font-chef/font-chef-export.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A set of vector instructions
+ * @ingroup simd-level
+ */
+enum fc_simd_level {
+  /** The best set the CPU supports */
+  fc_simd_auto = 0,
+
+  /** No vector instructions at all */
+  fc_simd_scalar,
+
+  /** SSE2, available on every x86-64 CPU */
+  fc_simd_sse2,
+
+  /** AVX2, if the CPU supports it */
+  fc_simd_avx2,
+
+  /** NEON, available on every AArch64 CPU */
+  fc_simd_neon
+};
+
+/**
+ * @brief Chooses which vector instructions to use
+ * @ingroup simd-level
+ *
+ * There is no need to call this, except to compare implementations (e.g, in benchmarks) or to rule out a
+ * faulty one. This setting is shared by every font, so call it before using font-chef from other threads.
+ *
+ * @param level Which vector instructions to use, or `fc_simd_auto` to go back to the best ones
+ * @return `1` if @p level is supported by both the CPU and this build of font-chef, `0` otherwise (and the
+ * setting is left as it was)
+ */
+FONT_CHEF_EXPORT extern uint8_t fc_set_simd_level(enum fc_simd_level level);
+
+/**
+ * @brief Returns which vector instructions are in use
+ * @ingroup simd-level
+ * @return The set of vector instructions in use, never `fc_simd_auto`
+ */
+FONT_CHEF_EXPORT extern enum fc_simd_level fc_get_simd_level(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FONT_CHEF_SIMD_LEVEL_H */
@@ -0,0 +1,97 @@
+#ifndef FONT_CHEF_TEXT_VIEW_HPP
+#define FONT_CHEF_TEXT_VIEW_HPP
+
+/**
+ * @file text-view.hpp
+ * This file contains fc::text_view, the UTF-8 text taken by the C++ rendering functions.
+ */
+
+#include "font-chef/font-chef-export.h"
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <string_view>
+#define FONT_CHEF_HAS_STRING_VIEW 1
+#endif
+
+namespace fc {
+  /**
+   * @brief A pointer to UTF-8 text and its size in bytes, without a copy of it
+   * @ingroup cpp
+   *
+   * It is implicitly constructed from whatever holds the text, so that functions like fc::font::render can take
+   * a `std::string`, a string literal, a `std::string_view` (C++17) or a `std::u8string_view` or `u8` literal
+   * (C++20) without copying it into a `std::string` first. Like a `std::string_view`, it must not outlive the text.
+   *
+   * **Example**
+   * @code
+   * std::string_view line = document.substr(offset, length); // no allocation
+   * font.render(line, result);
+   * font.render(u8"Déjà vu", result);
+   * @endcode
+   */
+  struct FONT_CHEF_EXPORT text_view {
+    /**
+     * @brief The first byte of the text
+     */
+    unsigned char const * data;
+
+    /**
+     * @brief How many bytes there are in the text
+     */
+    size_t size;
+
+    /**
+     * @brief Constructs a fc::text_view from a pointer and a size in bytes
+     * @param text The first byte of the text
+     * @param byte_count How many bytes there are in the text
+     */
+    text_view(char const * text, size_t byte_count)
+        : data(reinterpret_cast<unsigned char const *>(text)), size(byte_count) { }
+
+    /**
+     * @brief Constructs a fc::text_view from a null-terminated string
+     * @param text The text, which must not be `nullptr`
+     */
+    text_view(char const * text) : text_view(text, std::strlen(text)) { } //NOLINT
+
+    /**
+     * @brief Constructs a fc::text_view from a `std::string`
+     * @param text The text
+     */
+    text_view(std::string const & text) : text_view(text.data(), text.size()) { } //NOLINT
+
+#if defined(FONT_CHEF_HAS_STRING_VIEW)
+    /**
+     * @brief Constructs a fc::text_view from a `std::string_view`
+     * @param text The text
+     */
+    text_view(std::string_view text) : text_view(text.data(), text.size()) { } //NOLINT
+#endif
+
+#if defined(__cpp_lib_char8_t)
+    /**
+     * @brief Constructs a fc::text_view from a `std::u8string_view`
+     * @param text The text
+     */
+    text_view(std::u8string_view text) //NOLINT
+        : data(reinterpret_cast<unsigned char const *>(text.data())), size(text.size()) { }
+
+    /**
+     * @brief Constructs a fc::text_view from a `std::u8string`
+     * @param text The text
+     */
+    text_view(std::u8string const & text) : text_view(std::u8string_view(text)) { } //NOLINT
+
+    /**
+     * @brief Constructs a fc::text_view from a null-terminated `char8_t` string (e.g, a `u8` literal)
+     * @param text The text, which must not be `nullptr`
+     */
+    text_view(char8_t const * text) : text_view(std::u8string_view(text)) { } //NOLINT
+#endif
+  };
+}
+
+#endif //FONT_CHEF_TEXT_VIEW_HPP
@@ -0,0 +1,209 @@
+#ifndef FONT_CHEF_VERTEX_H
+#define FONT_CHEF_VERTEX_H
+
+/**
+ * @file vertex.h
+ * This file provides the structures used by ::fc_render_vertices and ::fc_render_instances to write
+ * vertex, index and instance data that can be handed to a GPU as it is.
+ */
+
+/**
+ * @defgroup vertex Vertex
+ * Types that describe vertex, index and instance buffers
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Marks a vertex attribute that should not be written
+ * @ingroup vertex
+ * @sa ::fc_vertex_layout
+ */
+#define FC_VERTEX_UNUSED ((size_t) -1)
+
+/**
+ * @brief The type of each index in an index buffer
+ * @ingroup vertex
+ */
+enum fc_index_type {
+  /** 16-bit unsigned indices: a buffer can have at most 65536 vertices */
+  fc_index_u16 = 0,
+
+  /** 32-bit unsigned indices */
+  fc_index_u32
+};
+
+/**
+ * @brief Describes where each attribute goes in an interleaved vertex
+ * @ingroup vertex
+ *
+ * Offsets are in bytes from the start of each vertex. Attributes that are not needed can be set to
+ * ::FC_VERTEX_UNUSED (position and uv are always written).
+ *
+ * **Example**
+ * @code
+ * struct vertex { float x, y, u, v; uint8_t color[4]; };
+ *
+ * struct fc_vertex_layout layout = {
+ *   sizeof(struct vertex),
+ *   offsetof(struct vertex, x),
+ *   offsetof(struct vertex, u),
+ *   offsetof(struct vertex, color),
+ *   FC_VERTEX_UNUSED,
+ *   fc_index_u16
+ * };
+ * @endcode
+ */
+struct fc_vertex_layout {
+  /**
+   * @brief How many bytes there are from one vertex to the next
+   */
+  size_t stride;
+
+  /**
+   * @brief Where the position goes, as two `float` values (x and y, in target/screen size)
+   */
+  size_t position;
+
+  /**
+   * @brief Where the texture coordinates go, as two `float` values from `0` to `1` (u and v)
+   */
+  size_t uv;
+
+  /**
+   * @brief Where the color goes, as four `uint8_t` values (r, g, b and a), or ::FC_VERTEX_UNUSED
+   */
+  size_t color;
+
+  /**
+   * @brief Where the page of the glyph goes, as an `uint32_t` value, or ::FC_VERTEX_UNUSED
+   * @sa ::fc_set_max_page_size
+   */
+  size_t page;
+
+  /**
+   * @brief The type of the indices written to the index buffer
+   */
+  enum fc_index_type index_type;
+};
+
+/**
+ * @brief Memory where ::fc_render_vertices writes vertices and indices
+ * @ingroup vertex
+ *
+ * Each glyph becomes four vertices (top-left, top-right, bottom-right and bottom-left) and six indices,
+ * forming two triangles. Vertices and indices are written after the ones already in the buffer, so many
+ * texts can share the same buffer; set the counts to zero to start over.
+ */
+struct fc_vertex_buffer {
+  /**
+   * @brief Memory for the vertices, at least `vertex_capacity * stride` bytes long
+   */
+  void * vertices;
+
+  /**
+   * @brief Memory for the indices, at least `vertex_capacity / 4 * 6` indices long, or `NULL` to skip them
+   */
+  void * indices;
+
+  /**
+   * @brief How many vertices fit in @p vertices
+   */
+  size_t vertex_capacity;
+
+  /**
+   * @brief How many vertices were written so far
+   */
+  size_t vertex_count;
+
+  /**
+   * @brief How many indices were written so far
+   */
+  size_t index_count;
+};
+
+/**
+ * @brief A compact record describing one glyph, meant to be drawn with instanced rendering
+ * @ingroup vertex
+ *
+ * Each record is 14 bytes, against the 40 bytes of a ::fc_character_mapping, and holds everything a
+ * vertex shader needs to expand a single quad into a glyph: where the quad goes, how big it is and where
+ * its pixels are. The quad covers `width` by `height` target pixels starting at `x` and `y`, and its
+ * texture coordinates are `u` to `u + uv_width` and `v` to `v + uv_height`, in pixels of page `page` (divide
+ * them by the page dimensions to get values from `0` to `1`). Both sizes differ whenever a glyph is not drawn
+ * at its cooked size, e.g. for oversampled glyphs (see ::fc_set_oversampling) or after ::fc_scale.
+ *
+ * **Example** (GLSL, drawing a quad with 4 vertices per instance)
+ * @code
+ * layout(location = 0) in ivec2 position;   // x, y
+ * layout(location = 1) in uvec2 offset;     // u, v
+ * layout(location = 2) in uvec2 size;       // width, height
+ * layout(location = 3) in uvec2 uv_size;    // uv_width, uv_height
+ * uniform vec2 page_size;
+ * void main() {
+ *   vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+ *   uv = (vec2(offset) + corner * vec2(uv_size)) / page_size;
+ *   gl_Position = projection * vec4(vec2(position) + corner * vec2(size), 0, 1);
+ * }
+ * @endcode
+ *
+ * @sa ::fc_render_instances
+ * @sa ::fc_make_instances
+ */
+struct fc_glyph_instance {
+  /**
+   * @brief Where the left side of the glyph goes, rounded to the nearest pixel
+   */
+  int16_t x;
+
+  /**
+   * @brief Where the top side of the glyph goes, rounded to the nearest pixel
+   */
+  int16_t y;
+
+  /**
+   * @brief The left side of the glyph pixels in its page
+   */
+  uint16_t u;
+
+  /**
+   * @brief The top side of the glyph pixels in its page
+   */
+  uint16_t v;
+
+  /**
+   * @brief The width of the quad, in target pixels
+   */
+  uint8_t width;
+
+  /**
+   * @brief The height of the quad, in target pixels
+   */
+  uint8_t height;
+
+  /**
+   * @brief The width of the glyph pixels in its page
+   */
+  uint8_t uv_width;
+
+  /**
+   * @brief The height of the glyph pixels in its page
+   */
+  uint8_t uv_height;
+
+  /**
+   * @brief Which page of pixels the glyph is in (see ::fc_get_page)
+   */
+  uint16_t page;
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FONT_CHEF_VERTEX_H */
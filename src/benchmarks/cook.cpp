@@ -0,0 +1,118 @@
+#include "font-chef/font-chef.hpp"
+#include "common/font.h"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/* every latin block at a large size, so most of the time goes to rasterizing glyphs */
+static fc::font latin_font() {
+  return fc
+      ::from(font_pacifico_ttf.data, fc::px(96), fc_color_white)
+      .add(fc_basic_latin)
+      .add(fc_latin_1_supplement)
+      .add(fc_latin_extended_a)
+      .add(fc_latin_extended_b)
+      .add(fc_latin_extended_additional);
+}
+
+static void cook(benchmark::State & state) {
+  for (auto _ : state) {
+    fc::font font = latin_font().threads(static_cast<size_t>(state.range(0))).cook();
+    benchmark::DoNotOptimize(font.pixels().data);
+  }
+}
+
+/* the glyphs a UI draws at many sizes, cooked once as bitmaps (0), single (1) or multi-channel (2)
+ * distance fields. Reports how many bytes the pages take (multi-channel pages are always RGBA) */
+static void cook_atlas(benchmark::State & state) {
+  size_t bytes = 0;
+  for (auto _ : state) {
+    fc::font font = fc
+        ::from(font_pacifico_ttf.data, fc::px(32), fc_color_white)
+        .add(fc_basic_latin)
+        .add(fc_latin_1_supplement)
+        .pixel_format(fc_pixel_format_alpha)
+        .threads(static_cast<size_t>(state.range(1)));
+    if (state.range(0) == 1) font.sdf(4);
+    if (state.range(0) == 2) font.msdf(4);
+    font.cook();
+    bytes = 0;
+    for (size_t i = 0; i < font.page_count(); i++) {
+      fc_pixels page = font.page(i);
+      bytes += static_cast<size_t>(page.dimensions.width * page.dimensions.height) * (page.format == fc_pixel_format_alpha ? 1 : 4);
+    }
+    benchmark::DoNotOptimize(font.pixels().data);
+  }
+  state.counters["atlas_bytes"] = static_cast<double>(bytes);
+}
+
+/* constructing a font parses the font tables, before anything is cooked */
+static void construct(benchmark::State & state) {
+  for (auto _ : state) {
+    fc_font * font = fc_construct(font_pacifico_ttf.data, fc_px(32), fc_color_white);
+    benchmark::DoNotOptimize(font);
+    fc_destruct(font);
+  }
+}
+
+/* the blocks a UI needs for latin (0), cyrillic (1) and CJK (2) text */
+static std::vector<fc_unicode_block> script_blocks(int64_t script) {
+  if (script == 0) return { fc_basic_latin, fc_latin_1_supplement, fc_latin_extended_a, fc_latin_extended_b };
+  if (script == 1) return { fc_basic_latin, fc_cyrillic, fc_cyrillic_supplement };
+  return { fc_basic_latin, fc_cjk_symbols_and_punctuation, fc_hiragana, fc_katakana, fc_cjk_unified_ideographs };
+}
+
+/* the blocks of a script at a given size. The embedded font has no CJK glyphs, so CJK runs take a
+ * font file from FONT_CHEF_BENCHMARK_CJK_FONT */
+static void cook_blocks(benchmark::State & state) {
+  char const * cjk_path = std::getenv("FONT_CHEF_BENCHMARK_CJK_FONT");
+  fc::font_size size = fc::px(static_cast<float>(state.range(1)));
+  std::vector<fc_unicode_block> blocks = script_blocks(state.range(0));
+  if (state.range(0) == 2 && (cjk_path == nullptr || !fc::from_file(cjk_path, size, fc_color_white))) {
+    state.SkipWithError("FONT_CHEF_BENCHMARK_CJK_FONT is not set to a font file");
+    return;
+  }
+  for (auto _ : state) {
+    fc::font font = state.range(0) == 2
+        ? fc::from_file(cjk_path, size, fc_color_white)
+        : fc::from(font_pacifico_ttf.data, size, fc_color_white);
+    for (auto const & block : blocks) font.add(block);
+    font.cook();
+    benchmark::DoNotOptimize(font.pixels().data);
+  }
+  size_t codepoints = 0;
+  for (auto const & block : blocks) codepoints += block.last - block.first + 1;
+  state.counters["codepoints"] = static_cast<double>(codepoints);
+}
+
+/* the same font, loaded from a cache file saved by a previous cook */
+static void load_cache(benchmark::State & state) {
+  char const * path = "benchmark-cook.fcc";
+  if (!latin_font().cook().save_cache(path)) {
+    state.SkipWithError("could not save the cache file");
+    return;
+  }
+  for (auto _ : state) {
+    fc::font font = latin_font();
+    if (!font.load_cache(path)) state.SkipWithError("could not load the cache file");
+    benchmark::DoNotOptimize(font.pixels().data);
+  }
+  std::remove(path);
+}
+
+BENCHMARK(construct)->Unit(benchmark::kMicrosecond);
+BENCHMARK(cook_blocks)
+    ->ArgNames({"script", "size"})
+    ->ArgsProduct({{0, 1, 2}, {16, 32, 64}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(cook)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(cook_atlas)
+    ->ArgNames({"mode", "threads"})
+    ->ArgsProduct({{0, 1, 2}, {1, 4}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(load_cache)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,82 @@
+#include "font-chef/font-chef.hpp"
+#include "common/font.h"
+#include <benchmark/benchmark.h>
+#include <string>
+
+/* a document of about 100k glyphs, like the ones a text editor scrolls through */
+static std::string document() {
+  std::string text;
+  while (text.size() < 100 * 1000) text += "The quick brown fox jumps over the lazy dog while the document keeps on going. ";
+  return text;
+}
+
+static fc::font document_font() {
+  return fc::from(font_pacifico_ttf.data, fc::px(18), fc_color_white).add(fc_basic_latin).cook();
+}
+
+/* picks the SIMD level given as the benchmark argument, skipping levels this machine lacks */
+static bool use_level(benchmark::State & state) {
+  auto level = static_cast<fc_simd_level>(state.range(0));
+  if (fc_set_simd_level(level)) return true;
+  state.SkipWithError("SIMD level not supported");
+  return false;
+}
+
+static void move_mapping(benchmark::State & state) {
+  if (!use_level(state)) return;
+  fc::font font = document_font();
+  fc::render_result result = font.render(document());
+  for (auto _ : state) {
+    fc_move(result.mapping.data(), result.size(), 0.5f, -0.5f);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * result.size()));
+  fc_set_simd_level(fc_simd_auto);
+}
+
+static void bounds_mapping(benchmark::State & state) {
+  if (!use_level(state)) return;
+  fc::font font = document_font();
+  fc::render_result result = font.render(document());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fc_text_bounds(result.mapping.data(), result.size()));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * result.size()));
+  fc_set_simd_level(fc_simd_auto);
+}
+
+static void move_arrays(benchmark::State & state) {
+  if (!use_level(state)) return;
+  fc::font font = document_font();
+  fc::glyph_arrays result = font.render_arrays(document());
+  for (auto _ : state) {
+    fc_move_arrays(&result.data, 0.5f, -0.5f);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * result.size()));
+  fc_set_simd_level(fc_simd_auto);
+}
+
+static void bounds_arrays(benchmark::State & state) {
+  if (!use_level(state)) return;
+  fc::font font = document_font();
+  fc::glyph_arrays result = font.render_arrays(document());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fc_text_bounds_arrays(&result.data));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * result.size()));
+  fc_set_simd_level(fc_simd_auto);
+}
+
+/* one run for each of fc_simd_scalar, fc_simd_sse2, fc_simd_avx2 and fc_simd_neon */
+static void simd_levels(benchmark::internal::Benchmark * benchmark) {
+  benchmark->ArgName("level");
+  for (int level = fc_simd_scalar; level <= fc_simd_neon; level++) benchmark->Arg(level);
+}
+
+BENCHMARK(move_mapping)->Apply(simd_levels)->Unit(benchmark::kMicrosecond);
+BENCHMARK(bounds_mapping)->Apply(simd_levels)->Unit(benchmark::kMicrosecond);
+BENCHMARK(move_arrays)->Apply(simd_levels)->Unit(benchmark::kMicrosecond);
+BENCHMARK(bounds_arrays)->Apply(simd_levels)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
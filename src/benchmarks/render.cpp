@@ -0,0 +1,170 @@
+#include "font-chef/font-chef.hpp"
+#include "common/font.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/* a frame worth of short labels, half of them wrapped in a box */
+static std::vector<std::string> labels() {
+  std::vector<std::string> result;
+  for (int i = 0; i < 2000; i++) result.push_back("Player " + std::to_string(i) + " - Level " + std::to_string(i % 60));
+  return result;
+}
+
+static std::vector<fc_batch_text> batch_texts(std::vector<std::string> const & labels) {
+  std::vector<fc_batch_text> texts(labels.size());
+  for (size_t i = 0; i < labels.size(); i++) {
+    float left = (float) (i % 20) * 100, top = (float) (i / 20) * 20;
+    texts[i].text = reinterpret_cast<unsigned char const *>(labels[i].data());
+    texts[i].byte_count = labels[i].size();
+    texts[i].box = { left, top, i % 2 ? left + 90 : left, top };
+    texts[i].alignment = fc_align_left;
+  }
+  return texts;
+}
+
+static fc::font label_font(size_t threads) {
+  return fc::from(font_pacifico_ttf.data, fc::px(18), fc_color_white).add(fc_basic_latin).threads(threads).cook();
+}
+
+/* one fc_render (and fc_wrap) call per label */
+static void render_each(benchmark::State & state) {
+  fc::font font = label_font(1);
+  std::vector<std::string> strings = labels();
+  std::vector<fc_batch_text> texts = batch_texts(strings);
+  fc::render_result result;
+  std::vector<uint8_t> workspace;
+  for (auto _ : state) {
+    for (auto const & text : texts) {
+      font.render(std::string(reinterpret_cast<char const *>(text.text), text.byte_count), result);
+      if (text.box.right > text.box.left) result.wrap(workspace, text.box.right - text.box.left);
+      result.move(text.box.left, text.box.top);
+      benchmark::DoNotOptimize(result.mapping.data());
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * texts.size()));
+}
+
+/* every label in a single fc_render_batch call */
+static void render_batch(benchmark::State & state) {
+  fc::font font = label_font(static_cast<size_t>(state.range(0)));
+  std::vector<std::string> strings = labels();
+  std::vector<fc_batch_text> texts = batch_texts(strings);
+  fc::batch_result result;
+  for (auto _ : state) {
+    font.render_batch(texts, result);
+    benchmark::DoNotOptimize(result.mapping.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * texts.size()));
+}
+
+/* one fc_render call per label, then a loop turning the glyphs into quads */
+static void render_quads(benchmark::State & state) {
+  fc::font font = label_font(1);
+  std::vector<std::string> strings = labels();
+  std::vector<fc_batch_text> texts = batch_texts(strings);
+  fc::render_result result;
+  std::vector<float> vertices(strings.size() * 32 * 16);
+  std::vector<uint32_t> indices(strings.size() * 32 * 6);
+  std::vector<fc_size> pages;
+  for (size_t i = 0; i < font.page_count(); i++) pages.push_back(font.page(i).dimensions);
+  for (auto _ : state) {
+    float * vertex = vertices.data();
+    uint32_t * index = indices.data(), count = 0;
+    for (auto const & text : texts) {
+      font.render(std::string(reinterpret_cast<char const *>(text.text), text.byte_count), result);
+      result.move(text.box.left, text.box.top);
+      for (auto const & m : result) {
+        fc_size const & page = pages[m.page];
+        float u0 = m.source.left / page.width, u1 = m.source.right / page.width;
+        float v0 = m.source.top / page.height, v1 = m.source.bottom / page.height;
+        float quad[16] = {
+            m.target.left, m.target.top, u0, v0, m.target.right, m.target.top, u1, v0,
+            m.target.right, m.target.bottom, u1, v1, m.target.left, m.target.bottom, u0, v1
+        };
+        uint32_t corners[6] = { count, count + 1, count + 2, count, count + 2, count + 3 };
+        std::copy(quad, quad + 16, vertex);
+        std::copy(corners, corners + 6, index);
+        vertex += 16;
+        index += 6;
+        count += 4;
+      }
+    }
+    benchmark::DoNotOptimize(vertices.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * texts.size()));
+}
+
+/* one fc_render_vertices call per label, writing quads straight into the buffers */
+static void render_vertices(benchmark::State & state) {
+  fc::font font = label_font(1);
+  std::vector<std::string> strings = labels();
+  std::vector<fc_batch_text> texts = batch_texts(strings);
+  std::vector<float> vertices(strings.size() * 32 * 16);
+  std::vector<uint32_t> indices(strings.size() * 32 * 6);
+  fc_vertex_layout layout = { sizeof(float) * 4, 0, sizeof(float) * 2, FC_VERTEX_UNUSED, FC_VERTEX_UNUSED, fc_index_u32 };
+  for (auto _ : state) {
+    fc_vertex_buffer buffer = { vertices.data(), indices.data(), vertices.size() / 4, 0, 0 };
+    for (size_t i = 0; i < texts.size(); i++) {
+      font.render_vertices(strings[i], layout, buffer, texts[i].box.left, texts[i].box.top);
+    }
+    benchmark::DoNotOptimize(vertices.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * texts.size()));
+}
+
+/* one fc_render_instances call per label, writing a compact record per glyph */
+static void render_instances(benchmark::State & state) {
+  fc::font font = label_font(1);
+  std::vector<std::string> strings = labels();
+  std::vector<fc_batch_text> texts = batch_texts(strings);
+  std::vector<fc_glyph_instance> instances;
+  for (auto _ : state) {
+    for (size_t i = 0; i < texts.size(); i++) {
+      font.render_instances(strings[i], instances, texts[i].box.left, texts[i].box.top);
+      benchmark::DoNotOptimize(instances.data());
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * texts.size()));
+}
+
+/* a long document, laid out again every iteration (e.g, a text area being resized) */
+static std::string document() {
+  std::string text;
+  while (text.size() < 64 * 1024) text += "The quick brown fox jumps over the lazy dog while the document keeps on going. ";
+  return text;
+}
+
+static void layout_mapping(benchmark::State & state) {
+  fc::font font = label_font(1);
+  fc::render_result result = font.render(document());
+  std::vector<uint8_t> workspace;
+  for (auto _ : state) {
+    result.wrap(workspace, 600.0f).move(1.0f, 1.0f);
+    benchmark::DoNotOptimize(fc_text_bounds(result.mapping.data(), result.size()));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * result.size()));
+}
+
+static void layout_arrays(benchmark::State & state) {
+  fc::font font = label_font(1);
+  fc::glyph_arrays result = font.render_arrays(document());
+  std::vector<uint8_t> workspace;
+  for (auto _ : state) {
+    result.wrap(workspace, 600.0f).move(1.0f, 1.0f);
+    benchmark::DoNotOptimize(result.bounds());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * result.size()));
+}
+
+BENCHMARK(render_each)->Unit(benchmark::kMicrosecond);
+BENCHMARK(render_batch)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+BENCHMARK(render_quads)->Unit(benchmark::kMicrosecond);
+BENCHMARK(render_vertices)->Unit(benchmark::kMicrosecond);
+BENCHMARK(render_instances)->Unit(benchmark::kMicrosecond);
+BENCHMARK(layout_mapping)->Unit(benchmark::kMicrosecond);
+BENCHMARK(layout_arrays)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,146 @@
+#include "font-chef/font-chef.hpp"
+#include "common/font.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+/* a paragraph of about 4k bytes, either plain ASCII (0) or mixing accented latin, cyrillic and
+ * codepoints the font does not have, which take two to four bytes each in UTF-8 (1) */
+static std::string paragraph(int64_t kind) {
+  char const * sentence = kind == 0
+      ? "The quick brown fox jumps over the lazy dog, then naps in the warm afternoon sun. "
+      : "D\xc3\xa9j\xc3\xa0 vu, na\xc3\xafve fa\xc3\xa7" "ade: \xd0\xa1\xd1\x8a\xd0\xb5\xd1\x88\xd1\x8c \xd0\xb6\xd0\xb5 "
+        "\xd0\xb5\xd1\x89\xd1\x91 \xd1\x8d\xd1\x82\xd0\xb8\xd1\x85 \xe6\x97\xa5\xe6\x9c\xac \xf0\x9f\x98\x80 stra\xc3\x9f" "e. ";
+  std::string text;
+  while (text.size() < 4 * 1024) text += sentence;
+  return text;
+}
+
+static fc::font text_font() {
+  return fc
+      ::from(font_pacifico_ttf.data, fc::px(24), fc_color_white)
+      .add(fc_basic_latin)
+      .add(fc_latin_1_supplement)
+      .add(fc_cyrillic)
+      .cook();
+}
+
+/* the same font, through the C interface */
+static fc_font * text_font_c() {
+  fc_font * font = fc_construct(font_pacifico_ttf.data, fc_px(24), fc_color_white);
+  fc_add(font, fc_basic_latin.first, fc_basic_latin.last);
+  fc_add(font, fc_latin_1_supplement.first, fc_latin_1_supplement.last);
+  fc_add(font, fc_cyrillic.first, fc_cyrillic.last);
+  fc_cook(font);
+  return font;
+}
+
+/* fc_render into a mapping buffer allocated once */
+static void render_c(benchmark::State & state) {
+  fc_font * font = text_font_c();
+  std::string text = paragraph(state.range(0));
+  std::vector<fc_character_mapping> mapping(text.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fc_render(font, reinterpret_cast<unsigned char const *>(text.data()), text.size(), mapping.data()));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+  fc_destruct(font);
+}
+
+/* fc::font::render, returning a new result every time (0), reusing the same one (1) or reusing it for a text
+ * whose length changes every time, as text updated every frame does (2) */
+static void render_cpp(benchmark::State & state) {
+  fc::font font = text_font();
+  std::string text = paragraph(state.range(0));
+  fc::render_result result;
+  size_t frame = 0, bytes = 0;
+  for (auto _ : state) {
+    if (state.range(1) == 0) {
+      fc::render_result fresh = font.render(text);
+      benchmark::DoNotOptimize(fresh.mapping.data());
+      bytes += text.size();
+    } else if (state.range(1) == 1) {
+      font.render(text, result);
+      benchmark::DoNotOptimize(result.mapping.data());
+      bytes += text.size();
+    } else {
+      size_t length = text.size() / 2 + frame++ % (text.size() / 2);
+      font.render(fc::text_view(text.data(), length), result);
+      benchmark::DoNotOptimize(result.mapping.data());
+      bytes += length;
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+
+/* fc_render_wrapped at a given line width in pixels: narrow widths make many short lines */
+static void render_wrapped(benchmark::State & state) {
+  fc_font * font = text_font_c();
+  std::string text = paragraph(state.range(0));
+  std::vector<fc_character_mapping> mapping(text.size());
+  auto line_width = static_cast<size_t>(state.range(1));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fc_render_wrapped(
+        font, reinterpret_cast<unsigned char const *>(text.data()), text.size(),
+        line_width, 1.0f, fc_align_left, mapping.data()
+    ));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+  fc_destruct(font);
+}
+
+/* one font shared by every thread of render_shared, cooked by the first of them */
+static fc_font * shared_font;
+
+/* fc_render_wrapped from several threads at once on the same font, to see how it scales. That every thread
+ * gets the glyphs a single thread would is checked by the render-shared test */
+static void render_shared(benchmark::State & state) {
+  std::string text = paragraph(1);
+  if (state.thread_index() == 0) shared_font = text_font_c();
+  std::vector<fc_character_mapping> mapping(text.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fc_render_wrapped(
+        shared_font, reinterpret_cast<unsigned char const *>(text.data()), text.size(),
+        480, 1.0f, fc_align_left, mapping.data()
+    ));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+  if (state.thread_index() == 0) fc_destruct(shared_font);
+}
+
+/* fc_blit of a wrapped ASCII paragraph into a 1920x1080 framebuffer, on one thread or more */
+static void blit(benchmark::State & state) {
+  fc_font * font = text_font_c();
+  std::string text = paragraph(0);
+  std::vector<fc_character_mapping> mapping(text.size());
+  std::vector<uint8_t> pixels(1920 * 1080 * 4);
+  fc_framebuffer framebuffer = { pixels.data(), 1920, 1080, 0 };
+  size_t glyph_count = fc_render_wrapped(
+      font, reinterpret_cast<unsigned char const *>(text.data()), text.size(),
+      1880, 1.0f, fc_align_left, mapping.data()
+  ).glyph_count;
+  fc_move(mapping.data(), glyph_count, 20, 40);
+  fc_set_thread_count(font, static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    fc_blit(font, mapping.data(), glyph_count, &framebuffer, nullptr, fc_color_white);
+    benchmark::ClobberMemory();
+  }
+  state.counters["glyphs"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * glyph_count), benchmark::Counter::kIsRate
+  );
+  fc_destruct(font);
+}
+
+BENCHMARK(render_c)->ArgName("utf8")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(render_cpp)->ArgNames({"utf8", "reuse"})->ArgsProduct({{0, 1}, {0, 1, 2}})->Unit(benchmark::kMicrosecond);
+BENCHMARK(render_wrapped)
+    ->ArgNames({"utf8", "width"})
+    ->ArgsProduct({{0, 1}, {120, 480, 1920}})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(render_shared)->ThreadRange(1, 8)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(blit)->ArgName("threads")->Arg(1)->Arg(4)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,57 @@
+#include "font-chef/font-chef.h"
+
+#include "common/font.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WIDTH 640
+#define HEIGHT 240
+
+int main(int argc, char const ** argv) {
+  char const * path = argc > 1 ? argv[1] : "example-headless.ppm";
+
+  struct fc_font * font = fc_construct(font_pacifico_ttf.data, fc_pt(30), fc_color_white);
+  fc_add(font, fc_basic_latin.first, fc_basic_latin.last);
+  fc_cook(font);
+
+  /* an opaque dark background, so that the image can be saved without its alpha channel */
+  uint8_t * pixels = malloc(WIDTH * HEIGHT * 4);
+  for (size_t i = 0; i < WIDTH * HEIGHT; i++) {
+    pixels[i * 4] = 32;
+    pixels[i * 4 + 1] = 36;
+    pixels[i * 4 + 2] = 48;
+    pixels[i * 4 + 3] = 255;
+  }
+  struct fc_framebuffer framebuffer = { pixels, WIDTH, HEIGHT, 0 };
+
+  struct fc_character_mapping mapping[256];
+  const char text[] = "Hello, handsome! I mean... world!";
+  struct fc_render_result result = fc_render_wrapped(
+      font,
+      (uint8_t *) text,
+      strlen(text),
+      WIDTH * 0.66f,
+      1.0f,
+      fc_align_left, mapping
+  );
+  fc_move(mapping, result.glyph_count, 20.0f, HEIGHT / 2 - 20);
+  fc_blit(font, mapping, result.glyph_count, &framebuffer, NULL, (struct fc_color) { 255, 200, 80, 255 });
+
+  FILE * file = fopen(path, "wb");
+  if (file == NULL) {
+    fprintf(stderr, "Cannot write %s\n", path);
+    free(pixels);
+    fc_destruct(font);
+    return 1;
+  }
+  fprintf(file, "P6\n%d %d\n255\n", WIDTH, HEIGHT);
+  for (size_t i = 0; i < WIDTH * HEIGHT; i++) fwrite(pixels + i * 4, 1, 3, file);
+  fclose(file);
+  printf("Wrote %s\n", path);
+
+  free(pixels);
+  fc_destruct(font);
+  return 0;
+}
@@ -0,0 +1,136 @@
+#include "font-chef/atlas.h"
+#include "font-internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct fc_atlas * fc_atlas_construct(void) {
+  struct fc_atlas * atlas = malloc(sizeof(*atlas));
+  if (atlas == NULL) return NULL;
+  if (!fc_pages_construct(&atlas->pages)) {
+    free(atlas);
+    return NULL;
+  }
+  atlas->fonts = NULL;
+  atlas->font_count = atlas->font_capacity = 0;
+  return atlas;
+}
+
+/* leaves a font as if it was never cooked: the glyphs it cooked are not in the pages it now
+ * reports, so none of them are found until it is cooked again */
+static int fc_atlas_uncook(struct fc_font * font) {
+  fc_cache_release(font);
+  fc_dynamic_clear(&font->dynamic);
+  fc_glyph_cache_clear(&font->glyph_cache);
+  fc_pages_clear(&font->pages);
+  return fc_index_build(&font->index, NULL, 0);
+}
+
+uint8_t fc_atlas_add_font(struct fc_atlas * atlas, struct fc_font * font) {
+  if (font->atlas == atlas) return 1;
+  if (font->atlas != NULL || font->metadata.font_data == NULL) return 0;
+  if (atlas->font_count >= atlas->font_capacity) {
+    size_t capacity = atlas->font_capacity ? atlas->font_capacity * 2 : 4;
+    struct fc_font ** fonts = realloc(atlas->fonts, sizeof(*fonts) * capacity);
+    if (fonts == NULL) return 0;
+    atlas->fonts = fonts;
+    atlas->font_capacity = capacity;
+  }
+  if (!fc_atlas_uncook(font)) return 0;
+  atlas->fonts[atlas->font_count++] = font;
+  font->atlas = atlas;
+  return 1;
+}
+
+void fc_atlas_forget(struct fc_atlas * atlas, struct fc_font const * font) {
+  size_t i;
+  for (i = 0; i < atlas->font_count; i++) {
+    if (atlas->fonts[i] != font) continue;
+    memmove(atlas->fonts + i, atlas->fonts + i + 1, sizeof(*atlas->fonts) * (atlas->font_count - i - 1));
+    atlas->font_count--;
+    return;
+  }
+}
+
+void fc_atlas_set_pixel_format(struct fc_atlas * atlas, enum fc_pixel_format format) {
+  atlas->pages.format = format;
+  if (atlas->pages.count == 0) atlas->pages.items[0].pixels.format = fc_pages_format(&atlas->pages);
+}
+
+void fc_atlas_set_max_page_size(struct fc_atlas * atlas, size_t max_size) {
+  atlas->pages.max_size = max_size;
+}
+
+uint8_t fc_atlas_cook(struct fc_atlas * atlas) {
+  stbtt_pack_context pack_context;
+  struct fc_font * const * fonts = atlas->fonts;
+  struct fc_size dimensions;
+  size_t f, char_count = 0, first = 0, max_size = atlas->pages.max_size;
+  float expected_size = 0;
+  uint8_t multi_channel = 0;
+  int result = 0;
+  stbrp_rect * rects;
+
+  /* multi-channel glyphs are rendered as RGBA, every other glyph as coverage */
+  for (f = 0; f < atlas->font_count; f++) {
+    uint8_t font_multi_channel = fonts[f]->sdf.padding > 0 && fonts[f]->sdf.channels == 3;
+    if (f > 0 && font_multi_channel != multi_channel) return 0;
+    multi_channel = font_multi_channel;
+  }
+
+  atlas->pages.multi_channel = multi_channel;
+  fc_pages_clear(&atlas->pages);
+  if (atlas->font_count == 0) return 1;
+
+  /* the first page has room for the glyphs of every font, as if each of them was cooked alone */
+  for (f = 0; f < atlas->font_count; f++) {
+    struct fc_font * font = fonts[f];
+    struct fc_size size = fc_calculate_pixel_buffer_size(font->packing.blocks, font->packing.count, font->metadata.size.value);
+    expected_size += size.width * size.height;
+    char_count += fc_cook_begin(font);
+  }
+  dimensions = fc_calculate_pixel_buffer_area(expected_size);
+  if (max_size > 0 && dimensions.width > (float) max_size) dimensions.width = (float) max_size;
+  if (max_size > 0 && dimensions.height > (float) max_size) dimensions.height = (float) max_size;
+
+  rects = malloc(sizeof(*rects) * (char_count ? char_count : 1));
+  stbtt_PackBegin(
+      &pack_context, NULL,
+      (int) dimensions.width, (int) dimensions.height,
+      0, 1, NULL
+  );
+  if (rects != NULL) {
+    for (f = 0; f < atlas->font_count; first += fonts[f]->packing.char_count, f++) {
+      struct fc_font * font = fonts[f];
+      stbtt_PackSetOversampling(&pack_context, font->sampling.horizontal, font->sampling.vertical);
+      fc_pack_gather(&pack_context, font->metadata.info, font->packing.blocks, font->packing.count, rects + first, &font->sdf);
+    }
+    result = fc_pack_pages(&atlas->pages, fonts, atlas->font_count, &pack_context, rects, 0);
+    free(rects);
+  }
+  stbtt_PackEnd(&pack_context);
+
+  for (f = 0; f < atlas->font_count; f++) {
+    if (!fc_cook_end(fonts[f])) result = 0;
+  }
+  return (uint8_t) result;
+}
+
+size_t fc_atlas_get_page_count(struct fc_atlas const * atlas) {
+  return atlas->pages.count;
+}
+
+struct fc_pixels const * fc_atlas_get_page(struct fc_atlas const * atlas, size_t index) {
+  if (index >= atlas->pages.count) return NULL;
+  return &atlas->pages.items[index].pixels;
+}
+
+void fc_atlas_destruct(struct fc_atlas * atlas) {
+  size_t i;
+  for (i = 0; i < atlas->font_count; i++) {
+    atlas->fonts[i]->atlas = NULL;
+    fc_atlas_uncook(atlas->fonts[i]);
+  }
+  fc_pages_destruct(&atlas->pages);
+  free(atlas->fonts);
+  free(atlas);
+}
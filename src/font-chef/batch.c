@@ -0,0 +1,114 @@
+#include "font-internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* state shared by all batch tasks. Each task renders a consecutive run of texts into the
+ * part of the output starting at its offset, which has room for every byte of them */
+struct fc_batch_work {
+  struct fc_font const * font;
+  struct fc_batch_text const * texts;
+  size_t text_count;
+  size_t texts_per_task;
+  size_t * task_offsets;
+  struct fc_character_mapping * mapping;
+  struct fc_batch_span * spans;
+  float space_width;
+};
+
+static void fc_batch_render_task(void * data, size_t index) {
+  struct fc_batch_work * work = data;
+  struct fc_font const * font = work->font;
+  size_t i, first = index * work->texts_per_task, longest = 0;
+  size_t last = first + work->texts_per_task < work->text_count ? first + work->texts_per_task : work->text_count;
+  size_t offset = work->task_offsets[index], workspace_size = 0;
+  void * workspace = NULL;
+
+  /* a single workspace, big enough for the longest text of this task, serves every text */
+  for (i = first; i < last; i++) {
+    if (work->texts[i].box.right > work->texts[i].box.left && work->texts[i].byte_count > longest) {
+      longest = work->texts[i].byte_count;
+    }
+  }
+  if (longest > 0) {
+    workspace_size = fc_wrap_workspace_size(longest);
+    workspace = malloc(workspace_size);
+  }
+
+  for (i = first; i < last; i++) {
+    struct fc_batch_text const * text = &work->texts[i];
+    struct fc_character_mapping * mapping = work->mapping + offset;
+    struct fc_render_result result = fc_render(font, text->text, text->byte_count, mapping);
+
+    if (result.glyph_count > 0 && text->box.right > text->box.left) {
+      result.line_count = fc_wrap_with_workspace(
+          mapping,
+          result.glyph_count,
+          text->box.right - text->box.left,
+          font->metrics.line_height,
+          work->space_width,
+          text->alignment,
+          workspace,
+          workspace_size
+      );
+    }
+    fc_move(mapping, result.glyph_count, text->box.left, text->box.top + font->metrics.ascent);
+
+    work->spans[i].first = offset;
+    work->spans[i].glyph_count = result.glyph_count;
+    work->spans[i].line_count = result.line_count;
+    offset += result.glyph_count;
+  }
+  free(workspace);
+}
+
+size_t fc_render_batch(
+    struct fc_font const * font,
+    struct fc_batch_text const * texts,
+    size_t text_count,
+    struct fc_character_mapping * mapping,
+    struct fc_batch_span * spans
+) {
+  struct fc_batch_work work;
+  size_t i, task_count, total = 0;
+  size_t single_offset = 0;
+  int parallel = font->settings.executor.run != NULL || font->settings.thread_count > 1;
+
+  if (text_count == 0) return 0;
+  work.font = font;
+  work.texts = texts;
+  work.text_count = text_count;
+  work.mapping = mapping;
+  work.spans = spans;
+  work.space_width = fc_get_space_metrics(font).width;
+
+  /* with a single task there are no gaps to close, as texts go right after one another */
+  work.texts_per_task = parallel ? FC_BATCH_TASK_SIZE : text_count;
+  task_count = (text_count + work.texts_per_task - 1) / work.texts_per_task;
+  work.task_offsets = task_count > 1 ? malloc(sizeof(*work.task_offsets) * task_count) : &single_offset;
+  if (work.task_offsets == NULL) {
+    work.texts_per_task = text_count;
+    work.task_offsets = &single_offset;
+    task_count = 1;
+  }
+
+  /* every task gets room for as many glyphs as its texts have bytes */
+  for (i = 0; i < task_count; i++) {
+    size_t k, last = (i + 1) * work.texts_per_task < text_count ? (i + 1) * work.texts_per_task : text_count;
+    work.task_offsets[i] = total;
+    for (k = i * work.texts_per_task; k < last; k++) total += texts[k].byte_count;
+  }
+  fc_run_tasks(&font->settings.executor, font->settings.thread_count, fc_batch_render_task, &work, task_count);
+
+  /* closes the gaps left between tasks, so mappings end up contiguous */
+  total = 0;
+  for (i = 0; i < text_count; i++) {
+    if (spans[i].first != total) {
+      memmove(mapping + total, mapping + spans[i].first, sizeof(*mapping) * spans[i].glyph_count);
+      spans[i].first = total;
+    }
+    total += spans[i].glyph_count;
+  }
+
+  if (work.task_offsets != &single_offset) free(work.task_offsets);
+  return total;
+}
@@ -0,0 +1,273 @@
+#include "font-chef/blit.h"
+#include "font-internal.h"
+#include "simd.h"
+#include <math.h>
+#include <string.h>
+
+/* How many pixels of a glyph row are blended at a time, through a buffer on the stack */
+#define FC_BLIT_CHUNK_SIZE 256
+
+/* How many rows each task draws when blitting in parallel */
+#define FC_BLIT_BAND_HEIGHT 64
+
+/* Blends `count` RGBA pixels of `src`, tinted by `color`, over those of `dst` */
+typedef void (* fc_blend_row)(uint8_t * dst, uint8_t const * src, size_t count, struct fc_color color);
+
+struct fc_blit_job {
+  struct fc_font const * font;
+  struct fc_character_mapping const * mapping;
+  size_t count;
+  struct fc_framebuffer const * framebuffer;
+  long left, top, right, bottom;
+  struct fc_color color;
+  fc_blend_row blend;
+};
+
+/* x / 255 rounded to the nearest integer, exact for every x up to 255 * 255 */
+static unsigned fc_div255(unsigned x) {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+static void fc_blend_scalar(uint8_t * dst, uint8_t const * src, size_t count, struct fc_color color) {
+  size_t i;
+  for (i = 0; i < count; i++, src += 4, dst += 4) {
+    unsigned alpha = fc_div255((unsigned) src[3] * color.a), inverse = 255 - alpha;
+    if (alpha == 0) continue;
+    dst[0] = (uint8_t) fc_div255(fc_div255((unsigned) src[0] * color.r) * alpha + dst[0] * inverse);
+    dst[1] = (uint8_t) fc_div255(fc_div255((unsigned) src[1] * color.g) * alpha + dst[1] * inverse);
+    dst[2] = (uint8_t) fc_div255(fc_div255((unsigned) src[2] * color.b) * alpha + dst[2] * inverse);
+    dst[3] = (uint8_t) fc_div255(255 * alpha + dst[3] * inverse);
+  }
+}
+
+/* The vector kernels work on pixels widened to 16 bits per channel, where every product and sum
+ * of the scalar kernel fits, so they give exactly the same results */
+
+#if defined(FC_SIMD_SSE2)
+static __m128i fc_div255_sse2(__m128i x) {
+  x = _mm_add_epi16(x, _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+static __m128i fc_blend_pair_sse2(__m128i src, __m128i dst, __m128i tint) {
+  __m128i color = fc_div255_sse2(_mm_mullo_epi16(src, tint));
+  __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(color, 0xFF), 0xFF);
+  __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+  __m128i opaque = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+  color = _mm_or_si128(_mm_andnot_si128(_mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0), color), opaque);
+  return fc_div255_sse2(_mm_add_epi16(_mm_mullo_epi16(color, alpha), _mm_mullo_epi16(dst, inverse)));
+}
+
+static void fc_blend_sse2(uint8_t * dst, uint8_t const * src, size_t count, struct fc_color color) {
+  __m128i zero = _mm_setzero_si128(), alphas = _mm_set1_epi32((int) 0xFF000000u);
+  __m128i tint = _mm_set_epi16(color.a, color.b, color.g, color.r, color.a, color.b, color.g, color.r);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i s = _mm_loadu_si128((__m128i const *) (src + i * 4)), d;
+    /* glyphs are mostly blank around their outline */
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, alphas), zero)) == 0xFFFF) continue;
+    d = _mm_loadu_si128((__m128i const *) (dst + i * 4));
+    _mm_storeu_si128((__m128i *) (dst + i * 4), _mm_packus_epi16(
+        fc_blend_pair_sse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), tint),
+        fc_blend_pair_sse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), tint)
+    ));
+  }
+  fc_blend_scalar(dst + i * 4, src + i * 4, count - i, color);
+}
+#endif
+
+#if defined(FC_SIMD_AVX2_DISPATCH)
+FC_TARGET_AVX2
+static __m256i fc_div255_avx2(__m256i x) {
+  x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+  return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+FC_TARGET_AVX2
+static __m256i fc_blend_pair_avx2(__m256i src, __m256i dst, __m256i tint) {
+  __m256i color = fc_div255_avx2(_mm256_mullo_epi16(src, tint));
+  __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(color, 0xFF), 0xFF);
+  __m256i inverse = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+  __m256i opaque = _mm256_set1_epi64x((long long) 0x00FF000000000000ull);
+  color = _mm256_or_si256(_mm256_andnot_si256(_mm256_set1_epi64x((long long) 0xFFFF000000000000ull), color), opaque);
+  return fc_div255_avx2(_mm256_add_epi16(_mm256_mullo_epi16(color, alpha), _mm256_mullo_epi16(dst, inverse)));
+}
+
+/* unpacking and packing both work within 128-bit lanes, so pixels come out where they were */
+FC_TARGET_AVX2
+static void fc_blend_avx2(uint8_t * dst, uint8_t const * src, size_t count, struct fc_color color) {
+  __m256i zero = _mm256_setzero_si256(), alphas = _mm256_set1_epi32((int) 0xFF000000u);
+  __m256i tint = _mm256_set1_epi64x((long long) (
+      (uint64_t) color.r | (uint64_t) color.g << 16 | (uint64_t) color.b << 32 | (uint64_t) color.a << 48
+  ));
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i s = _mm256_loadu_si256((__m256i const *) (src + i * 4)), d;
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(s, alphas), zero)) == -1) continue;
+    d = _mm256_loadu_si256((__m256i const *) (dst + i * 4));
+    _mm256_storeu_si256((__m256i *) (dst + i * 4), _mm256_packus_epi16(
+        fc_blend_pair_avx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), tint),
+        fc_blend_pair_avx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), tint)
+    ));
+  }
+  fc_blend_scalar(dst + i * 4, src + i * 4, count - i, color);
+}
+#endif
+
+#if defined(FC_SIMD_NEON)
+static uint16x8_t fc_div255_neon(uint16x8_t x) {
+  x = vaddq_u16(x, vdupq_n_u16(128));
+  return vshrq_n_u16(vaddq_u16(x, vshrq_n_u16(x, 8)), 8);
+}
+
+static uint16x8_t fc_blend_pair_neon(uint16x8_t src, uint16x8_t dst, uint16x8_t tint) {
+  static uint16_t const rgb[8] = { 0xFFFF, 0xFFFF, 0xFFFF, 0, 0xFFFF, 0xFFFF, 0xFFFF, 0 };
+  static uint16_t const opaque[8] = { 0, 0, 0, 255, 0, 0, 0, 255 };
+  uint16x8_t color = fc_div255_neon(vmulq_u16(src, tint));
+  uint16x8_t alpha = vcombine_u16(vdup_lane_u16(vget_low_u16(color), 3), vdup_lane_u16(vget_high_u16(color), 3));
+  uint16x8_t inverse = vsubq_u16(vdupq_n_u16(255), alpha);
+  color = vorrq_u16(vandq_u16(color, vld1q_u16(rgb)), vld1q_u16(opaque));
+  return fc_div255_neon(vaddq_u16(vmulq_u16(color, alpha), vmulq_u16(dst, inverse)));
+}
+
+static void fc_blend_neon(uint8_t * dst, uint8_t const * src, size_t count, struct fc_color color) {
+  uint16_t const channels[8] = { color.r, color.g, color.b, color.a, color.r, color.g, color.b, color.a };
+  uint16x8_t tint = vld1q_u16(channels);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    uint8x16_t s = vld1q_u8(src + i * 4), d = vld1q_u8(dst + i * 4);
+    uint16x8_t low = fc_blend_pair_neon(vmovl_u8(vget_low_u8(s)), vmovl_u8(vget_low_u8(d)), tint);
+    uint16x8_t high = fc_blend_pair_neon(vmovl_u8(vget_high_u8(s)), vmovl_u8(vget_high_u8(d)), tint);
+    vst1q_u8(dst + i * 4, vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+  }
+  fc_blend_scalar(dst + i * 4, src + i * 4, count - i, color);
+}
+#endif
+
+static fc_blend_row fc_blend_kernel(void) {
+  switch (fc_get_simd_level()) {
+#if defined(FC_SIMD_AVX2_DISPATCH)
+    case fc_simd_avx2:
+      return fc_blend_avx2;
+#endif
+#if defined(FC_SIMD_SSE2)
+    case fc_simd_sse2:
+      return fc_blend_sse2;
+#endif
+#if defined(FC_SIMD_NEON)
+    case fc_simd_neon:
+      return fc_blend_neon;
+#endif
+    default:
+      return fc_blend_scalar;
+  }
+}
+
+/* rounds to the nearest pixel, keeping values far off any framebuffer (and NaN) in range */
+static long fc_blit_round(float value) {
+  if (!(value > -1e8f)) return -100000000L;
+  if (value > 1e8f) return 100000000L;
+  return (long) floorf(value + 0.5f);
+}
+
+/* the source column or row of a target pixel: the one under its center */
+static long fc_blit_sample(long source_start, long source_size, long target_offset, long target_size) {
+  return source_start + (long) ((int64_t) (target_offset * 2 + 1) * source_size / (target_size * 2));
+}
+
+/* draws the rows of a glyph from `top` to `bottom` (exclusive) */
+static void fc_blit_glyph(struct fc_blit_job const * job, struct fc_character_mapping const * m, long top, long bottom) {
+  struct fc_framebuffer const * framebuffer = job->framebuffer;
+  struct fc_pixels const * page = fc_get_page(job->font, m->page);
+  size_t stride = framebuffer->stride ? framebuffer->stride : framebuffer->width * 4, bpp;
+  long target_left = fc_blit_round(m->target.left), target_top = fc_blit_round(m->target.top);
+  long target_width = fc_blit_round(m->target.right) - target_left, target_height = fc_blit_round(m->target.bottom) - target_top;
+  long source_left = (long) m->source.left, source_top = (long) m->source.top;
+  long source_width = (long) m->source.right - source_left, source_height = (long) m->source.bottom - source_top;
+  long left = target_left > job->left ? target_left : job->left;
+  long right = target_left + target_width < job->right ? target_left + target_width : job->right;
+  long x, y, i, count, page_width;
+  uint8_t buffer[FC_BLIT_CHUNK_SIZE * 4];
+
+  if (page == NULL || page->data == NULL || target_width <= 0 || target_height <= 0 || source_width <= 0 || source_height <= 0) return;
+  if (target_top > top) top = target_top;
+  if (target_top + target_height < bottom) bottom = target_top + target_height;
+  if (left >= right || top >= bottom) return;
+
+  bpp = page->format == fc_pixel_format_alpha ? 1 : 4;
+  page_width = (long) page->dimensions.width;
+  for (y = top; y < bottom; y++) {
+    long source_y = fc_blit_sample(source_top, source_height, y - target_top, target_height);
+    uint8_t const * row = page->data + (size_t) (source_y * page_width) * bpp;
+    uint8_t * target = framebuffer->data + (size_t) y * stride;
+    for (x = left; x < right; x += count) {
+      uint8_t const * src = buffer;
+      count = right - x < FC_BLIT_CHUNK_SIZE ? right - x : FC_BLIT_CHUNK_SIZE;
+      if (bpp == 4 && target_width == source_width) {
+        src = row + (size_t) (source_left + x - target_left) * 4;
+      } else if (bpp == 4) {
+        for (i = 0; i < count; i++) {
+          long source_x = fc_blit_sample(source_left, source_width, x + i - target_left, target_width);
+          memcpy(buffer + i * 4, row + (size_t) source_x * 4, 4);
+        }
+      } else {
+        for (i = 0; i < count; i++) {
+          long source_x = fc_blit_sample(source_left, source_width, x + i - target_left, target_width);
+          buffer[i * 4] = buffer[i * 4 + 1] = buffer[i * 4 + 2] = 255;
+          buffer[i * 4 + 3] = row[source_x];
+        }
+      }
+      job->blend(target + (size_t) x * 4, src, (size_t) count, job->color);
+    }
+  }
+}
+
+/* draws every glyph into one band of rows */
+static void fc_blit_band(void * data, size_t index) {
+  struct fc_blit_job const * job = data;
+  long top = job->top + (long) index * FC_BLIT_BAND_HEIGHT, bottom = top + FC_BLIT_BAND_HEIGHT;
+  size_t i;
+  if (bottom > job->bottom) bottom = job->bottom;
+  for (i = 0; i < job->count; i++) fc_blit_glyph(job, &job->mapping[i], top, bottom);
+}
+
+void fc_blit(
+    struct fc_font const * font,
+    struct fc_character_mapping const * mapping,
+    size_t count,
+    struct fc_framebuffer const * framebuffer,
+    struct fc_rect const * clip,
+    struct fc_color color
+) {
+  struct fc_blit_job job;
+  struct fc_settings const * settings = &font->settings;
+
+  job.font = font;
+  job.mapping = mapping;
+  job.count = count;
+  job.framebuffer = framebuffer;
+  job.color = color;
+  job.blend = fc_blend_kernel();
+  job.left = job.top = 0;
+  job.right = (long) framebuffer->width;
+  job.bottom = (long) framebuffer->height;
+  if (clip != NULL) {
+    long left = fc_blit_round(clip->left), top = fc_blit_round(clip->top);
+    long right = fc_blit_round(clip->right), bottom = fc_blit_round(clip->bottom);
+    if (left > job.left) job.left = left;
+    if (top > job.top) job.top = top;
+    if (right < job.right) job.right = right;
+    if (bottom < job.bottom) job.bottom = bottom;
+  }
+  if (count == 0 || color.a == 0 || job.left >= job.right || job.top >= job.bottom) return;
+
+  /* bands never share a pixel, so they can be drawn in any order and still give the same result */
+  if (settings->thread_count > 1 || settings->executor.run != NULL) {
+    size_t bands = (size_t) (job.bottom - job.top + FC_BLIT_BAND_HEIGHT - 1) / FC_BLIT_BAND_HEIGHT;
+    fc_run_tasks(&settings->executor, settings->thread_count, fc_blit_band, &job, bands);
+  } else {
+    size_t i;
+    for (i = 0; i < count; i++) fc_blit_glyph(&job, &mapping[i], job.top, job.bottom);
+  }
+}
@@ -0,0 +1,417 @@
+#include "font-chef/cache.h"
+#include "font-internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Bumped whenever the layout of the cache or what gets cooked changes */
+#define FC_CACHE_VERSION 3u
+#define FC_CACHE_MAGIC "FCHEFCCH"
+#define FC_CACHE_BYTE_ORDER 0x01020304u
+
+/* Every section starts at a multiple of this, so the arrays in it can be used in place */
+#define FC_CACHE_ALIGNMENT 16u
+
+/* How many blocks of how many bytes of the font data the key samples */
+#define FC_CACHE_SAMPLE_COUNT 64u
+#define FC_CACHE_SAMPLE_SIZE 64u
+
+/* The cache starts with this header, followed by a page table (one fc_cache_page per page)
+ * and then the sections it points to: packed chars, codepoints, the page of each char, the
+ * kerning table and the pixels of each page. Offsets are from the start of the cache */
+struct fc_cache_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t key;
+  uint64_t size;
+  struct fc_metrics metrics;
+  uint32_t format;
+  uint32_t kerning_built;
+  uint64_t page_count;
+  uint64_t char_count;
+  uint64_t kerning_capacity;
+  uint64_t kerning_count;
+  uint64_t pages;
+  uint64_t chars;
+  uint64_t codepoints;
+  uint64_t char_pages;
+  uint64_t kerning;
+};
+
+struct fc_cache_page {
+  uint64_t width;
+  uint64_t height;
+  uint64_t pixels;
+};
+
+/* Writes either to memory or to a file, keeping track of the offset so that sections can
+ * be aligned */
+struct fc_cache_writer {
+  unsigned char * buffer;
+  FILE * file;
+  size_t offset;
+  int ok;
+};
+
+static void fc_cache_put(struct fc_cache_writer * writer, void const * data, size_t size) {
+  if (size == 0) return;
+  if (writer->buffer != NULL) memcpy(writer->buffer + writer->offset, data, size);
+  if (writer->file != NULL && fwrite(data, 1, size, writer->file) != size) writer->ok = 0;
+  writer->offset += size;
+}
+
+static void fc_cache_align(struct fc_cache_writer * writer) {
+  static unsigned char const zeros[FC_CACHE_ALIGNMENT] = { 0 };
+  fc_cache_put(writer, zeros, (FC_CACHE_ALIGNMENT - writer->offset % FC_CACHE_ALIGNMENT) % FC_CACHE_ALIGNMENT);
+}
+
+static size_t fc_cache_aligned(size_t offset) {
+  return (offset + FC_CACHE_ALIGNMENT - 1) / FC_CACHE_ALIGNMENT * FC_CACHE_ALIGNMENT;
+}
+
+static uint64_t fc_cache_hash(uint64_t hash, void const * data, size_t size) {
+  unsigned char const * bytes = data;
+  size_t i;
+  for (i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 0x100000001B3u;
+  return hash;
+}
+
+/* The font data has no explicit size, so it is taken from its table directory: the font
+ * ends where its last table does */
+static size_t fc_cache_font_size(stbtt_fontinfo const * info) {
+  unsigned char const * directory = info->data + info->fontstart;
+  size_t i, end = (size_t) info->fontstart + 12, table_count = (size_t) ((directory[4] << 8) | directory[5]);
+  for (i = 0; i < table_count; i++) {
+    unsigned char const * table = directory + 12 + 16 * i;
+    size_t offset = ((size_t) table[8] << 24) | ((size_t) table[9] << 16) | ((size_t) table[10] << 8) | table[11];
+    size_t length = ((size_t) table[12] << 24) | ((size_t) table[13] << 16) | ((size_t) table[14] << 8) | table[15];
+    if (offset + length > end) end = offset + length;
+  }
+  return end;
+}
+
+/* Hashing every byte of the font would take longer than loading the rest of the cache, so the
+ * font is told apart by its size, its table directory (which has a checksum of each table), its
+ * head table (which has a checksum of the whole font and when it was modified) and a sample of
+ * blocks spread over it */
+static uint64_t fc_cache_font_hash(uint64_t hash, stbtt_fontinfo const * info) {
+  unsigned char const * directory = info->data + info->fontstart;
+  uint64_t size = fc_cache_font_size(info);
+  size_t i, table_count = (size_t) ((directory[4] << 8) | directory[5]);
+
+  hash = fc_cache_hash(hash, &size, sizeof(size));
+  hash = fc_cache_hash(hash, directory, 12 + 16 * table_count);
+  if (info->head) hash = fc_cache_hash(hash, info->data + info->head, 54);
+  if (size <= FC_CACHE_SAMPLE_COUNT * FC_CACHE_SAMPLE_SIZE) return fc_cache_hash(hash, info->data, (size_t) size);
+  for (i = 0; i < FC_CACHE_SAMPLE_COUNT; i++) {
+    size_t offset = (size_t) ((size - FC_CACHE_SAMPLE_SIZE) * i / (FC_CACHE_SAMPLE_COUNT - 1));
+    hash = fc_cache_hash(hash, info->data + offset, FC_CACHE_SAMPLE_SIZE);
+  }
+  return hash;
+}
+
+/* Hashes everything that changes what fc_cook produces, along with the layout of what is
+ * stored in place */
+static uint64_t fc_cache_key(struct fc_font const * font) {
+  uint64_t hash = 0xCBF29CE484222325u;
+  uint32_t values[11];
+  uint64_t max_size = font->pages.max_size;
+  size_t i;
+
+  values[0] = FC_CACHE_VERSION;
+  values[1] = (uint32_t) sizeof(stbtt_packedchar);
+  values[2] = (uint32_t) sizeof(struct fc_kerning_pair);
+  values[3] = (uint32_t) font->metadata.size.type;
+  values[4] = (uint32_t) fc_pages_format(&font->pages);
+  values[5] = font->kerning.enabled || font->metadata.subset;
+  values[6] = font->sdf.padding;
+  values[7] = font->sdf.on_edge_value;
+  values[8] = font->sdf.channels;
+  values[9] = font->sampling.horizontal;
+  values[10] = font->sampling.vertical;
+  hash = fc_cache_hash(hash, values, sizeof(values));
+  hash = fc_cache_hash(hash, &font->metadata.size.value, sizeof(font->metadata.size.value));
+  hash = fc_cache_hash(hash, &font->metadata.color, sizeof(font->metadata.color));
+  hash = fc_cache_hash(hash, &max_size, sizeof(max_size));
+  for (i = 0; i < font->packing.count; i++) {
+    stbtt_pack_range const * block = &font->packing.blocks[i];
+    hash = fc_cache_hash(hash, &block->first_unicode_codepoint_in_range, sizeof(block->first_unicode_codepoint_in_range));
+    hash = fc_cache_hash(hash, &block->num_chars, sizeof(block->num_chars));
+  }
+  return fc_cache_font_hash(hash, font->metadata.info);
+}
+
+static size_t fc_cache_bpp(enum fc_pixel_format format) {
+  return format == fc_pixel_format_alpha ? 1 : 4;
+}
+
+/* Lays out the header for the current cooked state, returning the total size */
+static size_t fc_cache_layout(struct fc_font const * font, struct fc_cache_header * header) {
+  struct fc_kerning const * kerning = &font->kerning;
+  size_t i, offset, char_count = font->packing.char_count;
+
+  memset(header, 0, sizeof(*header));
+  memcpy(header->magic, FC_CACHE_MAGIC, sizeof(header->magic));
+  header->version = FC_CACHE_VERSION;
+  header->byte_order = FC_CACHE_BYTE_ORDER;
+  header->key = fc_cache_key(font);
+  header->metrics = font->metrics;
+  header->format = (uint32_t) fc_pages_format(&font->pages);
+  header->kerning_built = kerning->built;
+  header->page_count = font->pages.count;
+  header->char_count = char_count;
+  header->kerning_capacity = kerning->count ? kerning->capacity : 0;
+  header->kerning_count = kerning->count;
+
+  offset = fc_cache_aligned(sizeof(*header));
+  header->pages = offset;
+  offset = fc_cache_aligned(offset + sizeof(struct fc_cache_page) * font->pages.count);
+  header->chars = offset;
+  offset = fc_cache_aligned(offset + sizeof(*font->packing.chars) * char_count);
+  header->codepoints = offset;
+  offset = fc_cache_aligned(offset + sizeof(*font->packing.codepoints) * char_count);
+  header->char_pages = offset;
+  offset = fc_cache_aligned(offset + sizeof(*font->packing.pages) * char_count);
+  header->kerning = offset;
+  offset = fc_cache_aligned(offset + sizeof(*kerning->pairs) * (size_t) header->kerning_capacity);
+  for (i = 0; i < font->pages.count; i++) {
+    struct fc_size dimensions = font->pages.items[i].pixels.dimensions;
+    offset = fc_cache_aligned(offset + (size_t) dimensions.width * (size_t) dimensions.height * fc_cache_bpp(fc_pages_format(&font->pages)));
+  }
+  header->size = offset;
+  return offset;
+}
+
+static size_t fc_cache_write(
+    struct fc_font const * font,
+    struct fc_cache_header const * header,
+    struct fc_cache_writer * writer
+) {
+  size_t i, pixels, char_count = font->packing.char_count, bpp = fc_cache_bpp(fc_pages_format(&font->pages));
+
+  fc_cache_put(writer, header, sizeof(*header));
+  fc_cache_align(writer);
+  pixels = (size_t) header->kerning + fc_cache_aligned(sizeof(*font->kerning.pairs) * (size_t) header->kerning_capacity);
+  for (i = 0; i < font->pages.count; i++) {
+    struct fc_size dimensions = font->pages.items[i].pixels.dimensions;
+    struct fc_cache_page page;
+    page.width = (uint64_t) dimensions.width;
+    page.height = (uint64_t) dimensions.height;
+    page.pixels = pixels;
+    pixels = fc_cache_aligned(pixels + (size_t) (page.width * page.height) * bpp);
+    fc_cache_put(writer, &page, sizeof(page));
+  }
+  fc_cache_align(writer);
+  fc_cache_put(writer, font->packing.chars, sizeof(*font->packing.chars) * char_count);
+  fc_cache_align(writer);
+  fc_cache_put(writer, font->packing.codepoints, sizeof(*font->packing.codepoints) * char_count);
+  fc_cache_align(writer);
+  fc_cache_put(writer, font->packing.pages, sizeof(*font->packing.pages) * char_count);
+  fc_cache_align(writer);
+  fc_cache_put(writer, font->kerning.pairs, sizeof(*font->kerning.pairs) * (size_t) header->kerning_capacity);
+  fc_cache_align(writer);
+  for (i = 0; i < font->pages.count; i++) {
+    struct fc_pixels const * page = &font->pages.items[i].pixels;
+    fc_cache_put(writer, page->data, (size_t) page->dimensions.width * (size_t) page->dimensions.height * bpp);
+    fc_cache_align(writer);
+  }
+  return writer->ok ? (size_t) header->size : 0;
+}
+
+size_t fc_save_cache(struct fc_font const * font, void * buffer, size_t size) {
+  struct fc_cache_header header;
+  struct fc_cache_writer writer;
+  size_t required;
+
+  /* only static atlases are saved: a dynamic one or a glyph cache can still change, a font in a
+   * shared atlas has no pages of its own and a subset font no longer has the font data to key it */
+  if (font->pages.count == 0 || font->dynamic.active || font->glyph_cache.active || font->metadata.font_data == NULL) return 0;
+  required = fc_cache_layout(font, &header);
+  if (buffer == NULL || size < required) return required;
+
+  writer.buffer = buffer;
+  writer.file = NULL;
+  writer.offset = 0;
+  writer.ok = 1;
+  return fc_cache_write(font, &header, &writer);
+}
+
+uint8_t fc_save_cache_file(struct fc_font const * font, char const * path) {
+  struct fc_cache_header header;
+  struct fc_cache_writer writer;
+  int written;
+
+  if (font->pages.count == 0 || font->dynamic.active || font->glyph_cache.active || font->metadata.font_data == NULL) return 0;
+  fc_cache_layout(font, &header);
+  writer.buffer = NULL;
+  writer.file = fopen(path, "wb");
+  writer.offset = 0;
+  writer.ok = writer.file != NULL;
+  if (!writer.ok) return 0;
+  written = fc_cache_write(font, &header, &writer) > 0;
+  if (fclose(writer.file) != 0) written = 0;
+
+  /* a partial file would only be rejected when loading, but there is no point keeping it */
+  if (!written) remove(path);
+  return (uint8_t) written;
+}
+
+/* checks that [offset, offset + length) lies within the cache */
+static int fc_cache_fits(uint64_t offset, uint64_t length, uint64_t size) {
+  return offset % FC_CACHE_ALIGNMENT == 0 && offset <= size && length <= size - offset;
+}
+
+/* checks that `count` items of `item_size` bytes starting at `offset` lie within the cache, without
+ * multiplying counts read from the cache, which could wrap around */
+static int fc_cache_fits_array(uint64_t offset, uint64_t count, uint64_t item_size, uint64_t size) {
+  return fc_cache_fits(offset, 0, size) && (item_size == 0 || count <= (size - offset) / item_size);
+}
+
+static int fc_cache_validate(struct fc_font const * font, unsigned char const * data, size_t size) {
+  struct fc_cache_header const * header = (struct fc_cache_header const *) data;
+  struct fc_cache_page const * pages;
+  stbtt_packedchar const * chars;
+  struct fc_kerning_pair const * pairs;
+  uint32_t const * char_pages;
+  uint64_t i, char_count = 0, used = 0, bpp;
+
+  if ((uintptr_t) data % FC_CACHE_ALIGNMENT != 0 || size < sizeof(*header)) return 0;
+  if (memcmp(header->magic, FC_CACHE_MAGIC, sizeof(header->magic)) != 0) return 0;
+  if (header->version != FC_CACHE_VERSION || header->byte_order != FC_CACHE_BYTE_ORDER) return 0;
+  if (header->size > size || header->page_count == 0) return 0;
+  if (header->format != (uint32_t) fc_pages_format(&font->pages)) return 0;
+
+  for (i = 0; i < font->packing.count; i++) char_count += (uint64_t) font->packing.blocks[i].num_chars;
+  if (header->char_count != char_count) return 0;
+  if (header->kerning_count > header->kerning_capacity / 2) return 0;
+  if (header->kerning_capacity & (header->kerning_capacity - 1)) return 0;
+
+  size = (size_t) header->size;
+  if (!fc_cache_fits_array(header->pages, header->page_count, sizeof(*pages), size)) return 0;
+  if (!fc_cache_fits_array(header->chars, char_count, sizeof(stbtt_packedchar), size)) return 0;
+  if (!fc_cache_fits_array(header->codepoints, char_count, sizeof(uint32_t), size)) return 0;
+  if (!fc_cache_fits_array(header->char_pages, char_count, sizeof(uint32_t), size)) return 0;
+  if (!fc_cache_fits_array(header->kerning, header->kerning_capacity, sizeof(struct fc_kerning_pair), size)) return 0;
+
+  /* lookups probe the kerning table until they reach an empty slot: there is one as long as the table holds
+   * as many pairs as the header says, since that is at most half of its slots */
+  pairs = (struct fc_kerning_pair const *) (data + header->kerning);
+  for (i = 0; i < header->kerning_capacity; i++) used += pairs[i].first != FC_KERNING_EMPTY;
+  if (used != header->kerning_count) return 0;
+
+  bpp = fc_cache_bpp(fc_pages_format(&font->pages));
+  pages = (struct fc_cache_page const *) (data + header->pages);
+  for (i = 0; i < header->page_count; i++) {
+    if (pages[i].width > UINT32_MAX || pages[i].height > UINT32_MAX) return 0;
+    if (!fc_cache_fits_array(pages[i].pixels, pages[i].width, pages[i].height * bpp, size)) return 0;
+  }
+
+  /* glyphs are drawn straight from these, so each one must lie within a page that exists */
+  chars = (stbtt_packedchar const *) (data + header->chars);
+  char_pages = (uint32_t const *) (data + header->char_pages);
+  for (i = 0; i < char_count; i++) {
+    struct fc_cache_page const * page;
+    if (char_pages[i] >= header->page_count) return 0;
+    page = &pages[char_pages[i]];
+    if (chars[i].x0 > chars[i].x1 || chars[i].x1 > page->width) return 0;
+    if (chars[i].y0 > chars[i].y1 || chars[i].y1 > page->height) return 0;
+  }
+
+  /* the key is checked last as it reads the font data */
+  return header->key == fc_cache_key(font);
+}
+
+void fc_cache_release(struct fc_font * font) {
+  size_t i;
+  if (!font->cache.loaded) return;
+
+  /* nothing that points into the cache is freed */
+  for (i = 0; i < font->pages.count; i++) font->pages.items[i].pixels.data = NULL;
+  font->packing.chars = NULL;
+  font->packing.codepoints = NULL;
+  font->packing.pages = NULL;
+  font->packing.char_count = font->packing.char_capacity = 0;
+  font->kerning.pairs = NULL;
+  font->kerning.capacity = font->kerning.count = 0;
+
+  if (font->cache.mapped) fc_unmap_file(font->cache.data, font->cache.size);
+  font->cache.data = NULL;
+  font->cache.size = 0;
+  font->cache.loaded = font->cache.mapped = 0;
+}
+
+uint8_t fc_load_cache(struct fc_font * font, void const * data, size_t size) {
+  unsigned char const * bytes = data;
+  struct fc_cache_header const * header = data;
+  struct fc_cache_page const * pages;
+  size_t i;
+
+  if (font->dynamic.enabled || font->glyph_cache.enabled || font->atlas != NULL || font->metadata.font_data == NULL) return 0;
+  if (!fc_cache_validate(font, bytes, size)) return 0;
+
+  fc_cache_release(font);
+  fc_dynamic_clear(&font->dynamic);
+  fc_pages_clear(&font->pages);
+  fc_kerning_clear(&font->kerning);
+  free(font->packing.chars);
+  free(font->packing.codepoints);
+  free(font->packing.pages);
+
+  /* everything is used in place, only the page list and the index are built */
+  pages = (struct fc_cache_page const *) (bytes + header->pages);
+  for (i = 0; i < header->page_count; i++) {
+    unsigned char * pixels = (unsigned char *) (bytes + pages[i].pixels);
+    if (!fc_pages_add_pixels(&font->pages, (size_t) pages[i].width, (size_t) pages[i].height, pixels)) break;
+  }
+  font->cache.data = data;
+  font->cache.size = size;
+  font->cache.loaded = 1;
+  font->cache.mapped = 0;
+
+  font->metrics = header->metrics;
+  font->packing.chars = (stbtt_packedchar *) (bytes + header->chars);
+  font->packing.codepoints = (uint32_t *) (bytes + header->codepoints);
+  font->packing.pages = (uint32_t *) (bytes + header->char_pages);
+  font->packing.char_count = font->packing.char_capacity = (size_t) header->char_count;
+  for (i = 0; i < font->packing.count; i++) font->packing.blocks[i].chardata_for_range = NULL;
+
+  font->kerning.pairs = (struct fc_kerning_pair *) (bytes + header->kerning);
+  font->kerning.capacity = (size_t) header->kerning_capacity;
+  font->kerning.count = (size_t) header->kerning_count;
+  font->kerning.built = (uint8_t) header->kerning_built;
+
+  if (font->pages.count < header->page_count || !fc_index_build(&font->index, font->packing.blocks, font->packing.count)) {
+    fc_cache_release(font);
+    fc_pages_clear(&font->pages);
+    fc_kerning_clear(&font->kerning);
+    return 0;
+  }
+  fc_subset_release(font);
+  return 1;
+}
+
+uint8_t fc_load_cache_file(struct fc_font * font, char const * path) {
+  void const * data = NULL;
+  size_t size = 0;
+
+  if (font->dynamic.enabled || font->glyph_cache.enabled || font->atlas != NULL || font->metadata.font_data == NULL) return 0;
+  data = fc_map_file(path, &size);
+  if (data == NULL) return 0;
+
+  /* the font now owns the mapping */
+  if (fc_load_cache(font, data, size)) {
+    font->cache.mapped = 1;
+    return 1;
+  }
+  fc_unmap_file(data, size);
+  return 0;
+}
+
+uint8_t fc_cook_cached(struct fc_font * font, char const * path) {
+  if (fc_load_cache_file(font, path)) return 1;
+  fc_cook_font(font);
+  fc_save_cache_file(font, path);
+  fc_subset_release(font);
+  return 0;
+}
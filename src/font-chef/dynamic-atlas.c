@@ -0,0 +1,298 @@
+#include "font-internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int fc_compare_codepoints(void const * a, void const * b) {
+  int x = *(int const *) a, y = *(int const *) b;
+  return (x > y) - (x < y);
+}
+
+/* marks a whole page as dirty: its texture has to be created again anyway */
+static void fc_dynamic_mark_page(struct fc_font * font, size_t index) {
+  struct fc_page * page = &font->pages.items[index];
+  struct fc_rect all;
+  all.left = all.top = 0;
+  all.right = page->pixels.dimensions.width;
+  all.bottom = page->pixels.dimensions.height;
+  page->dirty_count = 0;
+  fc_pages_mark_dirty(&font->pages, index, all);
+}
+
+/* doubles the height of the last page, keeping its width so that every rect cooked so far
+ * stays where it was. The new rows are blank (transparent font color in RGBA mode, zero
+ * distance everywhere for multi-channel pages) */
+static int fc_dynamic_grow(struct fc_font * font) {
+  stbtt_pack_context * context = &font->dynamic.context;
+  size_t index = font->pages.count - 1;
+  struct fc_pixels * page = &font->pages.items[index].pixels;
+  size_t bpp = page->format == fc_pixel_format_alpha ? 1 : 4;
+  size_t width = (size_t) context->width, height = (size_t) context->height;
+  size_t limit = font->pages.max_size ? font->pages.max_size : FC_DYNAMIC_ATLAS_MAX_HEIGHT;
+  size_t added = height * 2 > limit ? limit - height : height;
+  unsigned char * pixels, * rows;
+  struct fc_size dimensions;
+
+  if (height == 0 || height >= limit) return 0;
+  pixels = realloc(page->data, width * (height + added) * bpp);
+  if (pixels == NULL) return 0;
+
+  rows = pixels + width * height * bpp;
+  memset(rows, 0, width * added * bpp);
+  if (bpp == 4 && !font->pages.multi_channel) {
+    dimensions.width = (float) width;
+    dimensions.height = (float) added;
+    fc_colorify(rows + width * added * 3, rows, dimensions, font->metadata.color);
+  }
+
+  context->height = (int) (height + added);
+  ((stbrp_context *) context->pack_info)->height = context->height - context->padding;
+  page->data = pixels;
+  page->dimensions.width = (float) width;
+  page->dimensions.height = (float) context->height;
+  fc_dynamic_mark_page(font, index);
+  return 1;
+}
+
+/* starts a blank page once the last one is full and cannot grow anymore */
+static int fc_dynamic_add_page(struct fc_font * font) {
+  stbtt_pack_context * context = &font->dynamic.context;
+  int width = context->width, padding = context->padding;
+  unsigned char * coverage;
+
+  coverage = fc_pages_add(&font->pages, (size_t) width, font->dynamic.page_height);
+  if (coverage == NULL) return 0;
+  fc_pages_finish(&font->pages, font->pages.count - 1, coverage, font->metadata.color);
+  fc_dynamic_mark_page(font, font->pages.count - 1);
+
+  stbtt_PackEnd(context);
+  stbtt_PackBegin(context, NULL, width, (int) font->dynamic.page_height, 0, padding, NULL);
+  stbtt_PackSetOversampling(context, font->sampling.horizontal, font->sampling.vertical);
+  return 1;
+}
+
+/* packs rects into the last page, growing it (or adding pages) until they fit. Rects wider than
+ * a page never fit, so they do not make it grow. The page of each packed rect goes to `pages` */
+static void fc_dynamic_pack(struct fc_font * font, stbrp_rect * rects, uint32_t * pages, size_t count) {
+  stbtt_pack_context const * context = &font->dynamic.context;
+  size_t i, missing = count, fitting, packed;
+  int fresh = 0;
+  stbrp_rect * retry = malloc(sizeof(*retry) * count);
+  if (retry == NULL) return;
+
+  for (i = 0; i < count; i++) rects[i].was_packed = 0;
+  for (;;) {
+    /* only the rects still missing are packed again */
+    for (i = 0, missing = 0, fitting = 0; i < count; i++) {
+      if (rects[i].was_packed) continue;
+      retry[missing] = rects[i];
+      retry[missing++].id = (int) i;
+      fitting += rects[i].w <= context->width - context->padding;
+    }
+    if (fitting == 0) break;
+    stbtt_PackFontRangesPackRects(&font->dynamic.context, retry, (int) missing);
+    for (i = 0, packed = 0; i < missing; i++) {
+      int id = retry[i].id;
+      if (!retry[i].was_packed) continue;
+      rects[id] = retry[i];
+      pages[id] = (uint32_t) (font->pages.count - 1);
+      packed++;
+    }
+    if (packed == missing) break;
+    fresh = fresh && packed == 0;
+
+    /* an empty page that cannot grow will not take them either */
+    if (!fc_dynamic_grow(font)) {
+      if (fresh || !fc_dynamic_add_page(font)) break;
+      fresh = 1;
+    }
+  }
+  free(retry);
+}
+
+/* rasterizes the rects packed into one page into a scratch bitmap covering only their bounding
+ * box, then copies each rect into the page. The scratch bitmap keeps RGBA pages from needing a
+ * persistent coverage buffer. Multi-channel fields are rendered to it as RGBA already */
+static void fc_dynamic_render(
+    struct fc_font * font,
+    stbtt_pack_range * range,
+    stbrp_rect const * rects,
+    uint32_t const * pages,
+    size_t count,
+    uint32_t index
+) {
+  struct fc_pixels * page = &font->pages.items[index].pixels;
+  stbtt_pack_context context = font->dynamic.context;
+  size_t i, row, page_width = (size_t) page->dimensions.width, bpp = fc_pages_render_bpp(&font->pages);
+  int left = (int) page_width, top = (int) page->dimensions.height, right = 0, bottom = 0;
+  size_t width, height;
+  unsigned char * scratch;
+  stbrp_rect * local;
+  struct fc_size dimensions;
+  struct fc_rect bounds;
+
+  local = malloc(sizeof(*local) * count);
+  if (local == NULL) return;
+  for (i = 0; i < count; i++) {
+    local[i] = rects[i];
+    local[i].was_packed = rects[i].was_packed && pages[i] == index;
+    if (!local[i].was_packed) continue;
+    if (local[i].x < left) left = local[i].x;
+    if (local[i].y < top) top = local[i].y;
+    if (local[i].x + local[i].w > right) right = local[i].x + local[i].w;
+    if (local[i].y + local[i].h > bottom) bottom = local[i].y + local[i].h;
+  }
+
+  width = right > left ? (size_t) (right - left) : 0;
+  height = bottom > top ? (size_t) (bottom - top) : 0;
+  scratch = width && height ? calloc(width * height, bpp) : NULL;
+  if (scratch == NULL) {
+    free(local);
+    return;
+  }
+
+  for (i = 0; i < count; i++) {
+    if (!local[i].was_packed) continue;
+    local[i].x = (stbrp_coord) (local[i].x - left);
+    local[i].y = (stbrp_coord) (local[i].y - top);
+  }
+  context.pixels = scratch;
+  context.stride_in_bytes = (int) (width * bpp);
+  fc_pack_render(&context, font->metadata.info, range, 1, local, &font->sdf, &font->settings.executor, font->settings.thread_count);
+
+  dimensions.height = 1;
+  for (i = 0; i < count; i++) {
+    stbtt_packedchar * c = &range->chardata_for_range[i];
+    stbrp_rect const * r = &local[i];
+    if (!r->was_packed) continue;
+    c->x0 = (unsigned short) (c->x0 + left);
+    c->x1 = (unsigned short) (c->x1 + left);
+    c->y0 = (unsigned short) (c->y0 + top);
+    c->y1 = (unsigned short) (c->y1 + top);
+
+    dimensions.width = (float) r->w;
+    for (row = 0; row < (size_t) r->h; row++) {
+      unsigned char * src = scratch + ((r->y + row) * width + r->x) * bpp;
+      size_t target = (top + r->y + row) * page_width + left + r->x;
+      if (bpp == 4) {
+        memcpy(page->data + target * 4, src, (size_t) r->w * 4);
+      } else if (page->format == fc_pixel_format_alpha) {
+        memcpy(page->data + target, src, (size_t) r->w);
+      } else {
+        fc_colorify(src, page->data + target * 4, dimensions, font->metadata.color);
+      }
+    }
+  }
+  free(scratch);
+  free(local);
+
+  bounds.left = (float) left;
+  bounds.top = (float) top;
+  bounds.right = (float) right;
+  bounds.bottom = (float) bottom;
+  fc_pages_mark_dirty(&font->pages, index, bounds);
+}
+
+static int fc_dynamic_reserve(struct fc_packing * packing, size_t count) {
+  size_t i, capacity = packing->char_capacity ? packing->char_capacity : 64;
+  stbtt_packedchar * chars;
+  uint32_t * codepoints, * pages;
+
+  if (packing->char_count + count <= packing->char_capacity) return 1;
+  while (capacity < packing->char_count + count) capacity *= 2;
+  chars = realloc(packing->chars, sizeof(*chars) * capacity);
+  if (chars == NULL) return 0;
+  packing->chars = chars;
+  codepoints = realloc(packing->codepoints, sizeof(*codepoints) * capacity);
+  if (codepoints == NULL) return 0;
+  packing->codepoints = codepoints;
+  pages = realloc(packing->pages, sizeof(*pages) * capacity);
+  if (pages == NULL) return 0;
+  packing->pages = pages;
+  packing->char_capacity = capacity;
+
+  /* blocks only point at their chars while cooking, this keeps them from dangling */
+  for (i = 0; i < packing->count; i++) packing->blocks[i].chardata_for_range = NULL;
+  return 1;
+}
+
+static int fc_dynamic_is_missing(struct fc_font const * font, uint32_t codepoint) {
+  if (codepoint > 0x10FFFF || fc_index_find(&font->index, codepoint) != 0) return 0;
+  return stbtt_FindGlyphIndex(font->metadata.info, (int) codepoint) != 0;
+}
+
+size_t fc_dynamic_cook(struct fc_font * font, uint32_t const * codepoints, size_t count) {
+  struct fc_packing * packing = &font->packing;
+  stbtt_pack_range range;
+  stbrp_rect * rects = NULL;
+  int * points = NULL;
+  size_t i, missing = 0, added = 0, first_new = packing->char_count, first_page;
+  uint32_t * pages;
+
+  if (!font->dynamic.active) return 0;
+
+  /* codepoints that the font does not have are left out, so they are not cooked as the
+   * missing glyph over and over. The common case is that everything was cooked already,
+   * which must stay cheap and not allocate */
+  for (i = 0; i < count; i++) missing += fc_dynamic_is_missing(font, codepoints[i]);
+  if (missing == 0) return 0;
+
+  points = malloc(sizeof(*points) * missing);
+  if (points == NULL) return 0;
+  for (i = 0, missing = 0; i < count; i++) {
+    if (fc_dynamic_is_missing(font, codepoints[i])) points[missing++] = (int) codepoints[i];
+  }
+  qsort(points, missing, sizeof(*points), fc_compare_codepoints);
+  for (i = 0, count = 0; i < missing; i++) {
+    if (count == 0 || points[count - 1] != points[i]) points[count++] = points[i];
+  }
+  missing = count;
+
+  if (fc_dynamic_reserve(packing, missing)) rects = malloc(sizeof(*rects) * missing);
+  if (rects != NULL) {
+    range.font_size = fc_get_pack_size(font);
+    range.first_unicode_codepoint_in_range = 0;
+    range.array_of_unicode_codepoints = points;
+    range.num_chars = (int) missing;
+    range.chardata_for_range = packing->chars + first_new;
+    memset(range.chardata_for_range, 0, sizeof(*range.chardata_for_range) * missing);
+    pages = packing->pages + first_new;
+
+    fc_pack_gather(&font->dynamic.context, font->metadata.info, &range, 1, rects, &font->sdf);
+    first_page = font->pages.count - 1;
+    fc_dynamic_pack(font, rects, pages, missing);
+    for (i = first_page; i < font->pages.count; i++) {
+      fc_dynamic_render(font, &range, rects, pages, missing, (uint32_t) i);
+    }
+
+    /* glyphs that did not fit stay out of the index, the others are moved together */
+    for (i = 0; i < missing; i++) {
+      size_t position = first_new + added;
+      if (!rects[i].was_packed || !fc_index_insert(&font->index, (uint32_t) points[i], position)) continue;
+      packing->chars[position] = packing->chars[first_new + i];
+      packing->pages[position] = packing->pages[first_new + i];
+      packing->codepoints[position] = (uint32_t) points[i];
+      added++;
+    }
+    packing->char_count += added;
+
+    if (font->kerning.built) {
+      fc_kerning_extend(
+          &font->kerning,
+          font->metadata.info,
+          font->metrics.scale,
+          packing->codepoints,
+          packing->char_count,
+          first_new
+      );
+    }
+  }
+
+  free(rects);
+  free(points);
+  return added;
+}
+
+void fc_dynamic_clear(struct fc_dynamic_atlas * dynamic) {
+  if (dynamic->active) stbtt_PackEnd(&dynamic->context);
+  dynamic->active = 0;
+}
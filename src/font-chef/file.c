@@ -0,0 +1,53 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "font-internal.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+void const * fc_map_file(char const * path, size_t * size) {
+  void const * data = NULL;
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  HANDLE mapping = NULL;
+  LARGE_INTEGER file_size;
+  if (file == INVALID_HANDLE_VALUE) return NULL;
+  if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0 && (uint64_t) file_size.QuadPart <= SIZE_MAX) {
+    *size = (size_t) file_size.QuadPart;
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  }
+  if (mapping != NULL) {
+    data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+  }
+  CloseHandle(file);
+#else
+  struct stat info;
+  int file = open(path, O_RDONLY);
+  if (file < 0) return NULL;
+  if (fstat(file, &info) == 0 && info.st_size > 0) {
+    *size = (size_t) info.st_size;
+    data = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, file, 0);
+    if (data == MAP_FAILED) data = NULL;
+  }
+  close(file);
+#endif
+  return data;
+}
+
+void fc_unmap_file(void const * data, size_t size) {
+#if defined(_WIN32)
+  (void) size;
+  UnmapViewOfFile(data);
+#else
+  munmap((void *) data, size);
+#endif
+}
@@ -1,32 +1,74 @@
 #include "font-internal.h"
+#include "simd.h"
 #include "stb_truetype.h"
 #include <math.h>
 #include <stdio.h>
 
-/* converts 1bpp pixels generated by stbtt to 4bpp, applying the color value */
+/* converts 1bpp pixels generated by stbtt to 4bpp, applying the color value. Pixels are
+ * processed front to back and every block is loaded before it is stored, so old_pixels may
+ * be the last quarter of new_pixels and the expansion happens in place */
 void fc_colorify(
     unsigned char * old_pixels,
     unsigned char * new_pixels,
     struct fc_size dimensions,
     struct fc_color color
 ) {
-  unsigned char * src;
-  unsigned char * dst;
+  unsigned char const * src = old_pixels;
+  unsigned char * dst = new_pixels;
+  size_t i = 0, count = (size_t) dimensions.width * (size_t) dimensions.height;
 
-  int i, j, w = (int) dimensions.width, h = (int) dimensions.height;
+#if defined(FC_SIMD_AVX2)
+  __m256i rgb256 = _mm256_set1_epi32((int) (color.r | (uint32_t) color.g << 8u | (uint32_t) color.b << 16u));
+  for (; i + 32 <= count; i += 32) {
+    __m256i a0 = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const *) (src + i)));
+    __m256i a1 = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const *) (src + i + 8)));
+    __m256i a2 = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const *) (src + i + 16)));
+    __m256i a3 = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const *) (src + i + 24)));
+    _mm256_storeu_si256((__m256i *) (dst + i * 4), _mm256_or_si256(_mm256_slli_epi32(a0, 24), rgb256));
+    _mm256_storeu_si256((__m256i *) (dst + i * 4 + 32), _mm256_or_si256(_mm256_slli_epi32(a1, 24), rgb256));
+    _mm256_storeu_si256((__m256i *) (dst + i * 4 + 64), _mm256_or_si256(_mm256_slli_epi32(a2, 24), rgb256));
+    _mm256_storeu_si256((__m256i *) (dst + i * 4 + 96), _mm256_or_si256(_mm256_slli_epi32(a3, 24), rgb256));
+  }
+#endif
+#if defined(FC_SIMD_SSE2)
+  __m128i zero = _mm_setzero_si128();
+  __m128i rgb = _mm_set1_epi32((int) (color.r | (uint32_t) color.g << 8u | (uint32_t) color.b << 16u));
+  for (; i + 16 <= count; i += 16) {
+    /* interleaving zeroes below each alpha twice moves it to the top byte of a 32-bit pixel */
+    __m128i alpha = _mm_loadu_si128((__m128i const *) (src + i));
+    __m128i low = _mm_unpacklo_epi8(zero, alpha), high = _mm_unpackhi_epi8(zero, alpha);
+    _mm_storeu_si128((__m128i *) (dst + i * 4), _mm_or_si128(_mm_unpacklo_epi16(zero, low), rgb));
+    _mm_storeu_si128((__m128i *) (dst + i * 4 + 16), _mm_or_si128(_mm_unpackhi_epi16(zero, low), rgb));
+    _mm_storeu_si128((__m128i *) (dst + i * 4 + 32), _mm_or_si128(_mm_unpacklo_epi16(zero, high), rgb));
+    _mm_storeu_si128((__m128i *) (dst + i * 4 + 48), _mm_or_si128(_mm_unpackhi_epi16(zero, high), rgb));
+  }
+#elif defined(FC_SIMD_NEON)
+  uint8x16x4_t rgba;
+  rgba.val[0] = vdupq_n_u8(color.r);
+  rgba.val[1] = vdupq_n_u8(color.g);
+  rgba.val[2] = vdupq_n_u8(color.b);
+  for (; i + 16 <= count; i += 16) {
+    rgba.val[3] = vld1q_u8(src + i);
+    vst4q_u8(dst + i * 4, rgba);
+  }
+#endif
 
-  for (j = 0; j < h; ++j) {
-    src = old_pixels + j * w;
-    dst = new_pixels + j * w * 4;
-    for (i = w - 1; i >= 0; --i, src += 1, dst += 4) {
-      dst[0] = color.r;
-      dst[1] = color.g;
-      dst[2] = color.b;
-      dst[3] = src[0];
-    }
+  for (; i < count; i++) {
+    unsigned char alpha = src[i];
+    dst[i * 4] = color.r;
+    dst[i * 4 + 1] = color.g;
+    dst[i * 4 + 2] = color.b;
+    dst[i * 4 + 3] = alpha;
   }
 }
 
+float fc_get_pack_size(struct fc_font const * font) {
+  float size = font->metadata.size.value;
+  if (font->metadata.size.type == fc_size_type__pt)
+    size = STBTT_POINT_SIZE(size);
+  return size;
+}
+
 float fc_get_scale(struct fc_font const * font) {
   float scale;
   if (font->metadata.size.type == fc_size_type__pt) {
@@ -45,16 +87,8 @@ float fc_get_scale(struct fc_font const * font) {
 
 
 float fc_get_kern(struct fc_font const * font, uint32_t ch1, uint32_t ch2) {
-  return fc_get_scale(font) * (float) stbtt_GetCodepointKernAdvance(font->metadata.info, ch1, ch2);
-}
-
-stbtt_pack_range * fc_locate_block(struct fc_font const * font, uint32_t point) {
-  for (size_t i = 0; i < font->packing.count; i++) {
-    if (point >= (uint32_t) font->packing.blocks[i].first_unicode_codepoint_in_range &&
-        point <= (uint32_t) font->packing.blocks[i].first_unicode_codepoint_in_range + font->packing.blocks[i].num_chars)
-      return &font->packing.blocks[i];
-  }
-  return NULL;
+  if (font->kerning.built) return fc_kerning_find(&font->kerning, ch1, ch2);
+  return font->metrics.scale * (float) stbtt_GetCodepointKernAdvance(font->metadata.info, (int) ch1, (int) ch2);
 }
 
 /* http://graphics.stanford.edu/~seander/bithacks.html#RoundUpPowerOf2 */
@@ -76,20 +110,29 @@ struct fc_size fc_calculate_pixel_buffer_size(stbtt_pack_range * blocks, size_t
     expected_size += (float)(blocks[i].num_chars);
   }
   expected_size *= font_height * font_height;
+  return fc_calculate_pixel_buffer_area(expected_size);
+}
+
+struct fc_size fc_calculate_pixel_buffer_area(float expected_size) {
+  /* splits the power-of-two area in two power-of-two sides, the wider one being the width */
+  unsigned long area = upper_power_of_two(expected_size < 1 ? 1 : (unsigned long) expected_size), height = 1;
+  while (height * height * 4 <= area) height *= 2;
   struct fc_size size = {
-      .width = (float) sqrt((double)upper_power_of_two((int) expected_size)),
-      .height = size.width
+      .width = (float) (area / height),
+      .height = (float) height
   };
   return size;
 }
 
 void fc_generate_metrics(struct fc_font *font) {
   float scale = fc_get_scale(font);
-  int ascent, descent, line_gap;
+  int ascent, descent, line_gap, advance, bearing;
   font->metrics.scale = scale;
   stbtt_GetFontVMetrics(font->metadata.info, &ascent, &descent, &line_gap);
+  stbtt_GetCodepointHMetrics(font->metadata.info, 0x20, &advance, &bearing);
   font->metrics.ascent = (scale * (float) ascent);
   font->metrics.descent = (scale * (float) descent);
   font->metrics.line_gap = (scale * (float) line_gap);
   font->metrics.line_height = (float)(font->metrics.ascent - font->metrics.descent + font->metrics.line_gap);
+  font->metrics.space_width = (float) (advance + bearing) * scale;
 }
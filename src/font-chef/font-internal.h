@@ -5,6 +5,8 @@
 #include "font-chef/color.h"
 #include "font-chef/font-size.h"
 #include "font-chef/font.h"
+#include "font-chef/atlas.h"
+#include "font-chef/executor.h"
 
 #include <stdint.h>
 #include <stddef.h>
@@ -15,9 +17,21 @@
 extern "C" {
 #endif
 
-/* Global font metadata, including font info exctracted by stb_truetype */
+/* Font data that fonts own rather than borrow from the caller: a buffer to free or a mapped file
+ * to unmap. It is shared by the fonts constructed from one another and released with the last */
+struct fc_font_source {
+  unsigned char const * data;
+  size_t size;
+  size_t references;
+  uint8_t mapped;
+};
+
+/* Global font metadata, including font info exctracted by stb_truetype. With subset set, the font
+ * lets go of its font data once cooked. font_data is NULL from then on */
 struct fc_metadata {
   unsigned char const * font_data;
+  struct fc_font_source * source;
+  uint8_t subset;
   struct fc_font_size size;
   struct fc_color color;
   void *info;
@@ -30,25 +44,206 @@ struct fc_metrics {
   float descent;
   float line_gap;
   float line_height;
+  float space_width;
 };
 
 /* Before cooking, this structure holds all the blocks to be cooked. After cooking it also
- * holds the rects of everything that was cooked */
+ * holds the rects of everything that was cooked, in a single array shared by all blocks,
+ * and the codepoint and page of each of them */
 struct fc_packing {
   stbtt_pack_range * blocks;
   size_t count;
   size_t capacity;
+  stbtt_packedchar * chars;
+  uint32_t * codepoints;
+  uint32_t * pages;
+  size_t char_count;
+  size_t char_capacity;
+};
+
+/* Glyph index layout: codepoints below FC_INDEX_FLAT_SIZE are looked up directly, the
+ * rest of the unicode space is split in pages of FC_INDEX_PAGE_SIZE codepoints */
+#define FC_INDEX_FLAT_SIZE 0x800u
+#define FC_INDEX_PAGE_BITS 8u
+#define FC_INDEX_PAGE_SIZE (1u << FC_INDEX_PAGE_BITS)
+#define FC_INDEX_PAGE_MASK (FC_INDEX_PAGE_SIZE - 1u)
+#define FC_INDEX_DIRECTORY_SIZE (0x110000u >> FC_INDEX_PAGE_BITS)
+
+/* Maps a codepoint straight to its position in fc_packing.chars. Entries store that
+ * position plus one, so zero means the codepoint was not cooked. Pages are only allocated
+ * for the parts of the unicode space touched by a block; directory entries hold the
+ * page number plus one. */
+struct fc_index {
+  uint32_t * flat;
+  uint16_t * directory;
+  uint32_t * pages;
+  size_t page_count;
+};
+
+/* Marks an empty slot in the kerning table (no codepoint goes that far) */
+#define FC_KERNING_EMPTY UINT32_MAX
+
+struct fc_kerning_pair {
+  uint32_t first;
+  uint32_t second;
+  float kern;
+};
+
+/* Kerning between every pair of cooked codepoints, already scaled to pixels, kept in an
+ * open-addressing hash table. When it was not built (disabled or out of memory), kerning
+ * is queried from stb_truetype at render time instead. */
+struct fc_kerning {
+  struct fc_kerning_pair * pairs;
+  uint8_t * marks;
+  size_t capacity;
+  size_t count;
+  uint8_t enabled;
+  uint8_t built;
+};
+
+/* Dynamic atlases grow by doubling the height of their last page, up to this many pixels
+ * (or the maximum page size, if set) */
+#define FC_DYNAMIC_ATLAS_MAX_HEIGHT 16384
+
+/* State kept after cooking in dynamic atlas mode: the packer of the last page carries on
+ * from where fc_cook left it. New pages get page_height rows */
+struct fc_dynamic_atlas {
+  uint8_t enabled;
+  uint8_t active;
+  stbtt_pack_context context;
+  size_t page_height;
+};
+
+/* Marks the end of the glyph cache list, and cells that hold no glyph */
+#define FC_GLYPH_CACHE_NONE UINT32_MAX
+
+/* State of the glyph cache mode: a single page of `width` by `height` pixels split in cells as big
+ * as the largest glyph, each holding one glyph at the position of fc_packing.chars with the same
+ * number. Cells in use are kept in a doubly linked list from the most recently used one (`head`)
+ * to the least recently used one (`tail`), which is evicted to make room unless it was used in
+ * the current frame. Cells past `used` were never filled */
+struct fc_glyph_cache {
+  uint8_t enabled;
+  uint8_t active;
+  size_t width;
+  size_t height;
+  size_t cell_width;
+  size_t cell_height;
+  size_t columns;
+  size_t cell_count;
+  size_t used;
+  uint32_t * previous;
+  uint32_t * next;
+  uint32_t * frames;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t frame;
+  struct fc_glyph_cache_stats stats;
+};
+
+/* The largest oversampling stbtt_PackSetOversampling accepts (STBTT_MAX_OVERSAMPLE) */
+#define FC_MAX_OVERSAMPLING 8
+
+/* How glyphs are sampled: rasterized at `horizontal` by `vertical` times their size, and placed at
+ * fractional positions (instead of being snapped to whole pixels) when `subpixel` is set */
+struct fc_sampling {
+  uint8_t horizontal;
+  uint8_t vertical;
+  uint8_t subpixel;
+};
+
+/* How glyphs are rasterized: plain coverage when padding is zero, otherwise a signed distance
+ * field reaching `padding` pixels out of each glyph, with `on_edge_value` on its outline. With 3
+ * channels the field is a multi-channel one, rendered straight into RGBA pixels */
+struct fc_sdf {
+  uint8_t padding;
+  uint8_t on_edge_value;
+  uint8_t channels;
+};
+
+/* One texture worth of cooked glyphs. Every area of the pixels changed after cooking is
+ * recorded so it can be uploaded on its own */
+struct fc_page {
+  struct fc_pixels pixels;
+  struct fc_rect * dirty;
+  size_t dirty_count;
+  size_t dirty_capacity;
+};
+
+/* Cooked glyphs spill over to as many pages as needed, none of them larger than max_size
+ * (when not zero) on either side. There is always room for one page, so that page zero
+ * can be returned by fc_get_pixels even before cooking. Multi-channel pages are always RGBA,
+ * whatever the format */
+struct fc_pages {
+  struct fc_page * items;
+  size_t count;
+  size_t capacity;
+  size_t max_size;
+  enum fc_pixel_format format;
+  uint8_t multi_channel;
+};
+
+/* Pages shared by several fonts, cooked together. Each font keeps its own metrics, packed chars
+ * and kerning, with page numbers that point into these pages */
+struct fc_atlas {
+  struct fc_pages pages;
+  struct fc_font ** fonts;
+  size_t font_count;
+  size_t font_capacity;
+};
+
+/* A cooked state loaded from a cache. Packed chars, codepoints, pages, kerning pairs and
+ * pixels point straight into `data` while it is loaded, so they must not be freed; a mapped
+ * file is unmapped when the cache is released */
+struct fc_cache {
+  void const * data;
+  size_t size;
+  uint8_t loaded;
+  uint8_t mapped;
+};
+
+/* How many codepoints fc_render decodes at once into its stack buffer */
+#define FC_RENDER_CHUNK_SIZE 256
+
+/* How many glyphs each rasterization task renders while cooking */
+#define FC_PACK_TASK_SIZE 32
+
+/* Multi-channel distance fields take long enough to make each glyph a task of its own */
+#define FC_PACK_MSDF_TASK_SIZE 1
+
+/* How many texts each task renders in fc_render_batch */
+#define FC_BATCH_TASK_SIZE 64
+
+/* How work that can run in parallel is carried out. A set executor takes precedence over
+ * thread_count; with neither, everything runs on the calling thread */
+struct fc_settings {
+  size_t thread_count;
+  struct fc_executor executor;
 };
 
 /* main fc_font structure */
 struct fc_font {
   struct fc_metadata metadata;
+  struct fc_settings settings;
   struct fc_metrics metrics;
   struct fc_packing packing;
-  struct fc_pixels pixels;
+  struct fc_index index;
+  struct fc_kerning kerning;
+  struct fc_dynamic_atlas dynamic;
+  struct fc_glyph_cache glyph_cache;
+  struct fc_sampling sampling;
+  struct fc_sdf sdf;
+  struct fc_pages pages;
+  struct fc_atlas * atlas;
+  struct fc_cache cache;
 };
 
-/* Creates a 4bpp bitmap from a 1bpp bitmap */
+/* The pages glyphs of a font are in: its own, or those of the atlas it belongs to */
+static inline struct fc_pages const * fc_font_pages(struct fc_font const * font) {
+  return font->atlas != NULL ? &font->atlas->pages : &font->pages;
+}
+
+/* Creates a 4bpp bitmap from a 1bpp bitmap, old_pixels may be the last quarter of new_pixels */
 void fc_colorify(
     unsigned char * old_pixels,
     unsigned char * new_pixels,
@@ -57,11 +252,201 @@ void fc_colorify(
 );
 
 float fc_get_scale(struct fc_font const * font);
+/* The font size in the form stbtt pack ranges expect it */
+float fc_get_pack_size(struct fc_font const * font);
 float fc_get_kern(struct fc_font const * font, uint32_t ch1, uint32_t ch2);
-stbtt_pack_range * fc_locate_block(struct fc_font const * font, uint32_t point);
+
+/* Looks up a codepoint in the index, returning its position in fc_packing.chars plus one
+ * or zero if it was not cooked */
+static inline uint32_t fc_index_find(struct fc_index const * index, uint32_t point) {
+  uint16_t page;
+  if (point < FC_INDEX_FLAT_SIZE) return index->flat[point];
+  if (point >= FC_INDEX_DIRECTORY_SIZE << FC_INDEX_PAGE_BITS) return 0;
+  page = index->directory[point >> FC_INDEX_PAGE_BITS];
+  if (page == 0) return 0;
+  return index->pages[(size_t) (page - 1) * FC_INDEX_PAGE_SIZE + (point & FC_INDEX_PAGE_MASK)];
+}
+
+static inline size_t fc_kerning_hash(uint32_t first, uint32_t second) {
+  uint32_t h = first * 0x9E3779B1u ^ second * 0x85EBCA77u;
+  return (size_t) (h ^ (h >> 15u));
+}
+
+/* Returns the kerning between two codepoints or zero if that pair does not kern */
+static inline float fc_kerning_find(struct fc_kerning const * kerning, uint32_t first, uint32_t second) {
+  size_t i, mask;
+  if (kerning->count == 0) return 0;
+  mask = kerning->capacity - 1;
+  for (i = fc_kerning_hash(first, second) & mask; ; i = (i + 1) & mask) {
+    struct fc_kerning_pair const * pair = &kerning->pairs[i];
+    if (pair->first == first && pair->second == second) return pair->kern;
+    if (pair->first == FC_KERNING_EMPTY) return 0;
+  }
+}
+
+int fc_kerning_insert(struct fc_kerning * kerning, uint32_t first, uint32_t second, float kern);
+int fc_kerning_build(
+    struct fc_kerning * kerning,
+    stbtt_fontinfo const * info,
+    float scale,
+    uint32_t const * codepoints,
+    size_t count
+);
+/* Adds the pairs that involve codepoints from `first_new` onwards to an already built table */
+int fc_kerning_extend(
+    struct fc_kerning * kerning,
+    stbtt_fontinfo const * info,
+    float scale,
+    uint32_t const * codepoints,
+    size_t count,
+    size_t first_new
+);
+void fc_kerning_clear(struct fc_kerning * kerning);
+
+int fc_index_construct(struct fc_index * index);
+int fc_index_build(struct fc_index * index, stbtt_pack_range const * blocks, size_t block_count);
+/* Points a single codepoint at a position in fc_packing.chars, allocating its page if needed */
+int fc_index_insert(struct fc_index * index, uint32_t point, size_t position);
+/* Makes a single codepoint not cooked anymore */
+void fc_index_remove(struct fc_index * index, uint32_t point);
+void fc_index_destruct(struct fc_index * index);
+/* Picks power-of-two page dimensions with room for every block, from a rough estimate */
 struct fc_size fc_calculate_pixel_buffer_size(stbtt_pack_range * blocks, size_t block_count, float font_height);
+/* Picks power-of-two page dimensions with at least `expected_size` pixels */
+struct fc_size fc_calculate_pixel_buffer_area(float expected_size);
 void fc_generate_metrics(struct fc_font * font);
 
+/* Decodes UTF-8 text into at most `capacity` codepoints, returning how many were decoded. The
+ * amount of bytes consumed is stored in `consumed`. Runs of ASCII take a vectorized path,
+ * invalid sequences are decoded as U+FFFD */
+size_t fc_decode_utf8(
+    unsigned char const * text,
+    size_t byte_count,
+    uint32_t * codepoints,
+    size_t capacity,
+    size_t * consumed
+);
+
+/* Runs `count` tasks through the executor if it has one, otherwise on up to `thread_count`
+ * threads (the calling thread included). Returns after all tasks are done */
+void fc_run_tasks(
+    struct fc_executor const * executor,
+    size_t thread_count,
+    fc_task task,
+    void * data,
+    size_t count
+);
+
+/* Renders the multi-channel distance field of a glyph into `width` by `height` RGBA pixels, whose
+ * top-left one is at `left`, `top` from the glyph origin: the median of red, green and blue is the
+ * distance to the outline with sharp corners, alpha is the true distance. Returns 0 if out of memory */
+int fc_msdf_render(
+    stbtt_fontinfo const * info,
+    int glyph,
+    float scale,
+    struct fc_sdf const * sdf,
+    unsigned char * pixels,
+    size_t stride,
+    int left,
+    int top,
+    int width,
+    int height
+);
+
+/* Same as stbtt_PackFontRangesGatherRects, with rects sized for signed distance fields when
+ * `sdf` has padding */
+void fc_pack_gather(
+    stbtt_pack_context const * context,
+    stbtt_fontinfo const * info,
+    stbtt_pack_range * ranges,
+    size_t range_count,
+    stbrp_rect * rects,
+    struct fc_sdf const * sdf
+);
+
+/* Renders rects that were already gathered and packed for `ranges` into the context pixels,
+ * split in tasks run by fc_run_tasks */
+int fc_pack_render(
+    stbtt_pack_context const * context,
+    stbtt_fontinfo const * info,
+    stbtt_pack_range const * ranges,
+    size_t range_count,
+    stbrp_rect * rects,
+    struct fc_sdf const * sdf,
+    struct fc_executor const * executor,
+    size_t thread_count
+);
+
+int fc_pages_construct(struct fc_pages * pages);
+void fc_pages_clear(struct fc_pages * pages);
+void fc_pages_destruct(struct fc_pages * pages);
+/* The format pages actually have */
+enum fc_pixel_format fc_pages_format(struct fc_pages const * pages);
+/* How many bytes each pixel takes where glyphs are rendered: 4 for multi-channel pages, 1 otherwise */
+size_t fc_pages_render_bpp(struct fc_pages const * pages);
+/* Adds a page with blank pixels, returning where its 1 byte-per-pixel coverage should be
+ * rendered (the last quarter of the pixels in RGBA format, all of them for multi-channel
+ * pages) or NULL if out of memory */
+unsigned char * fc_pages_add(struct fc_pages * pages, size_t width, size_t height);
+/* Adds a page whose pixels are already there */
+int fc_pages_add_pixels(struct fc_pages * pages, size_t width, size_t height, unsigned char * data);
+/* Turns the coverage of a page into its final pixels, applying the color in RGBA format */
+void fc_pages_finish(struct fc_pages * pages, size_t index, unsigned char * coverage, struct fc_color color);
+int fc_pages_mark_dirty(struct fc_pages * pages, size_t index, struct fc_rect rect);
+
+/* Packs gathered rects into as many pages as needed, starting with the page of `context`,
+ * and renders them. The rects of each font follow those of the previous one, in the order of
+ * their packed chars, and each font renders its own with its settings. Every page is trimmed
+ * to the rows it uses, except the last one when `keep_last` is set (dynamic atlas mode) */
+int fc_pack_pages(
+    struct fc_pages * pages,
+    struct fc_font * const * fonts,
+    size_t font_count,
+    stbtt_pack_context * context,
+    stbrp_rect * rects,
+    uint8_t keep_last
+);
+
+/* Everything fc_cook does before packing glyphs: clears the cooked state, generates the metrics
+ * and gives every block its packed chars. Returns how many chars there are */
+size_t fc_cook_begin(struct fc_font * font);
+/* Everything fc_cook does after packing glyphs: builds the index and kerning table. Returns
+ * zero if the index could not be built, leaving the font without pages */
+int fc_cook_end(struct fc_font * font);
+/* Cooks a font without letting go of its font data, so that a cache can still be saved */
+void fc_cook_font(struct fc_font * font);
+/* Lets go of the font data of a cooked subset font, if nothing needs it anymore */
+void fc_subset_release(struct fc_font * font);
+
+/* Forgets a font that is being destructed, leaving its glyphs in the pages until the next cook */
+void fc_atlas_forget(struct fc_atlas * atlas, struct fc_font const * font);
+
+/* Rasterizes the codepoints that are in the font but not yet in the atlas into its free space,
+ * growing it if needed. Returns how many glyphs were added */
+size_t fc_dynamic_cook(struct fc_font * font, uint32_t const * codepoints, size_t count);
+void fc_dynamic_clear(struct fc_dynamic_atlas * dynamic);
+
+/* Cooks the blank page of a font in glyph cache mode, filling it with the glyphs of its blocks
+ * for as long as there are free cells */
+void fc_glyph_cache_cook(struct fc_font * font);
+/* Looks up codepoints in the glyph cache, rasterizing the ones that miss into free or evicted
+ * cells. Returns how many glyphs were added */
+size_t fc_glyph_cache_fetch(struct fc_font * font, uint32_t const * codepoints, size_t count);
+void fc_glyph_cache_clear(struct fc_glyph_cache * cache);
+
+/* Maps a whole file into memory read-only, returning NULL if it cannot be mapped or is empty */
+void const * fc_map_file(char const * path, size_t * size);
+void fc_unmap_file(void const * data, size_t size);
+
+/* Stops using a loaded cache, leaving the font as if it was never cooked */
+void fc_cache_release(struct fc_font * font);
+
+/* A run of glyphs, from first to last (inclusive), used by fc_wrap for words and lines */
+struct fc_text_segment {
+  size_t first;
+  size_t last;
+};
+
 #ifdef __cplusplus
 };
 #endif
@@ -1,11 +1,18 @@
 #include "font-chef/font.h"
 #include "stb_truetype.h"
-#include "utf8-decode.h"
 #include "font-internal.h"
 #include <math.h>
+#include <string.h>
 #include <font-chef/character-mapping.h>
 
 
+static void fc_font_source_release(struct fc_font_source * source) {
+  if (source == NULL || --source->references > 0) return;
+  if (source->mapped) fc_unmap_file(source->data, source->size);
+  else free((void *) source->data);
+  free(source);
+}
+
 struct fc_font * fc_construct(
     uint8_t const * font_data,
     struct fc_font_size font_size,
@@ -13,25 +20,125 @@ struct fc_font * fc_construct(
 ) {
   struct fc_font * font = malloc(sizeof(*font));
   font->metadata.font_data = font_data;
+  font->metadata.source = NULL;
+  font->metadata.subset = 0;
   font->metadata.size = font_size;
   font->metadata.color = font_color;
   font->metadata.info = malloc(sizeof(stbtt_fontinfo));
 
-  font->pixels.data = NULL;
-  font->pixels.dimensions.width = font->pixels.dimensions.height = .0f;
+  font->settings.thread_count = 1;
+  font->settings.executor.run = NULL;
+  font->settings.executor.context = NULL;
+
+  fc_pages_construct(&font->pages);
+  font->atlas = NULL;
 
   font->packing.count = 0;
   font->packing.blocks = malloc(sizeof(*font->packing.blocks) * 8);
   font->packing.capacity = 8;
+  font->packing.chars = NULL;
+  font->packing.codepoints = NULL;
+  font->packing.pages = NULL;
+  font->packing.char_count = font->packing.char_capacity = 0;
+
+  fc_index_construct(&font->index);
+
+  font->kerning.pairs = NULL;
+  font->kerning.marks = NULL;
+  font->kerning.capacity = font->kerning.count = 0;
+  font->kerning.enabled = 1;
+  font->kerning.built = 0;
+
+  font->dynamic.enabled = font->dynamic.active = 0;
+  font->dynamic.page_height = 0;
+
+  memset(&font->glyph_cache, 0, sizeof(font->glyph_cache));
+
+  font->sampling.horizontal = font->sampling.vertical = 1;
+  font->sampling.subpixel = 0;
+
+  font->sdf.padding = 0;
+  font->sdf.on_edge_value = 0;
+  font->sdf.channels = 1;
 
   font->metrics.ascent = font->metrics.descent = font->metrics.line_gap = 0;
-  font->metrics.scale = 0;
+  font->metrics.scale = font->metrics.line_height = font->metrics.space_width = 0;
+
+  font->cache.data = NULL;
+  font->cache.size = 0;
+  font->cache.loaded = font->cache.mapped = 0;
 
   stbtt_InitFont(font->metadata.info, font->metadata.font_data, 0);
 
   return font;
 }
 
+/* constructs a font that owns its data, releasing the source if that fails */
+static struct fc_font * fc_construct_with_source(
+    struct fc_font_source * source,
+    struct fc_font_size font_size,
+    struct fc_color font_color
+) {
+  struct fc_font * font;
+  stbtt_fontinfo info;
+
+  if (!stbtt_InitFont(&info, source->data, 0)) {
+    fc_font_source_release(source);
+    return NULL;
+  }
+  font = fc_construct(source->data, font_size, font_color);
+  font->metadata.source = source;
+  return font;
+}
+
+struct fc_font * fc_construct_owned(
+    uint8_t * font_data,
+    size_t size,
+    struct fc_font_size font_size,
+    struct fc_color font_color
+) {
+  struct fc_font_source * source = malloc(sizeof(*source));
+  if (source == NULL) {
+    free(font_data);
+    return NULL;
+  }
+  source->data = font_data;
+  source->size = size;
+  source->references = 1;
+  source->mapped = 0;
+  return fc_construct_with_source(source, font_size, font_color);
+}
+
+struct fc_font * fc_construct_from_file(
+    char const * path,
+    struct fc_font_size font_size,
+    struct fc_color font_color
+) {
+  struct fc_font_source * source = malloc(sizeof(*source));
+  if (source == NULL) return NULL;
+  source->data = fc_map_file(path, &source->size);
+  if (source->data == NULL) {
+    free(source);
+    return NULL;
+  }
+  source->references = 1;
+  source->mapped = 1;
+  return fc_construct_with_source(source, font_size, font_color);
+}
+
+struct fc_font * fc_construct_sharing(
+    struct fc_font const * other,
+    struct fc_font_size font_size,
+    struct fc_color font_color
+) {
+  struct fc_font * font;
+  if (other->metadata.font_data == NULL) return NULL;
+  font = fc_construct(other->metadata.font_data, font_size, font_color);
+  font->metadata.source = other->metadata.source;
+  if (font->metadata.source != NULL) font->metadata.source->references++;
+  return font;
+}
+
 void fc_add(struct fc_font * font, uint32_t first, uint32_t last) {
   /* handles the case when more memory needed to add block*/
   if (font->packing.count >= font->packing.capacity) {
@@ -41,9 +148,7 @@ void fc_add(struct fc_font * font, uint32_t first, uint32_t last) {
     /* TODO: handle and return out-of-memory */
   }
 
-  float size = font->metadata.size.value;
-  if (font->metadata.size.type == fc_size_type__pt)
-    size = STBTT_POINT_SIZE(size);
+  float size = fc_get_pack_size(font);
   size_t char_count_in_block;
   size_t block_count = font->packing.count;
   size_t i = block_count;
@@ -52,54 +157,229 @@ void fc_add(struct fc_font * font, uint32_t first, uint32_t last) {
   font->packing.blocks[i].num_chars = (int) char_count_in_block;
   font->packing.blocks[i].font_size = size;
   font->packing.blocks[i].array_of_unicode_codepoints = NULL;
-  font->packing.blocks[i].chardata_for_range = malloc(
-      sizeof(stbtt_packedchar) * (char_count_in_block)
-  );
+  font->packing.blocks[i].chardata_for_range = NULL;
   font->packing.count += 1;
+
+  /* a cooked dynamic atlas takes the new block in right away */
+  if (font->dynamic.active) {
+    uint32_t * codepoints = malloc(sizeof(*codepoints) * char_count_in_block);
+    if (codepoints == NULL) return;
+    size_t k;
+    for (k = 0; k < char_count_in_block; k++) codepoints[k] = first + (uint32_t) k;
+    fc_dynamic_cook(font, codepoints, char_count_in_block);
+    free(codepoints);
+  }
 }
 
-void fc_cook(struct fc_font * font) {
-  stbtt_pack_context pack_context;
+size_t fc_cook_begin(struct fc_font * font) {
   size_t block_count = font->packing.count;
   stbtt_pack_range * blocks = font->packing.blocks;
+  size_t i, char_count = 0;
+
+  fc_cache_release(font);
+  fc_dynamic_clear(&font->dynamic);
+  fc_glyph_cache_clear(&font->glyph_cache);
+  fc_pages_clear(&font->pages);
+  fc_generate_metrics(font);
+
+  /* all blocks share a single array of packed chars so that the index can point straight at it */
+  for (i = 0; i < block_count; i++) char_count += (size_t) blocks[i].num_chars;
+  free(font->packing.chars);
+  free(font->packing.codepoints);
+  free(font->packing.pages);
+  font->packing.chars = calloc(char_count ? char_count : 1, sizeof(*font->packing.chars));
+  font->packing.codepoints = malloc(sizeof(*font->packing.codepoints) * (char_count ? char_count : 1));
+  font->packing.pages = malloc(sizeof(*font->packing.pages) * (char_count ? char_count : 1));
+  font->packing.char_count = font->packing.char_capacity = char_count;
+  for (i = 0, char_count = 0; i < block_count; char_count += (size_t) blocks[i].num_chars, i++) {
+    blocks[i].chardata_for_range = font->packing.chars + char_count;
+    for (int j = 0; j < blocks[i].num_chars; j++) {
+      font->packing.codepoints[char_count + (size_t) j] = (uint32_t) (blocks[i].first_unicode_codepoint_in_range + j);
+    }
+  }
+  return char_count;
+}
+
+int fc_cook_end(struct fc_font * font) {
+  fc_kerning_clear(&font->kerning);
+
+  /* the index could not be allocated, so the font is left as if it was never cooked */
+  if (!fc_index_build(&font->index, font->packing.blocks, font->packing.count)) {
+    fc_dynamic_clear(&font->dynamic);
+    fc_pages_clear(&font->pages);
+    return 0;
+  }
+
+  if (font->kerning.enabled || font->metadata.subset) {
+    fc_kerning_build(
+        &font->kerning,
+        font->metadata.info,
+        font->metrics.scale,
+        font->packing.codepoints,
+        font->packing.char_count
+    );
+  }
+  return 1;
+}
+
+void fc_cook(struct fc_font * font) {
+  fc_cook_font(font);
+  fc_subset_release(font);
+}
+
+void fc_subset_release(struct fc_font * font) {
+  /* glyphs rasterized after cooking, other fonts of an atlas cooked again and kerning looked up in
+   * the font all need the font data */
+  if (!font->metadata.subset || font->metadata.font_data == NULL) return;
+  if (font->dynamic.enabled || font->glyph_cache.enabled || font->atlas != NULL || !font->kerning.built) return;
+  fc_font_source_release(font->metadata.source);
+  font->metadata.source = NULL;
+  font->metadata.font_data = NULL;
+  memset(font->metadata.info, 0, sizeof(stbtt_fontinfo));
+}
+
+void fc_cook_font(struct fc_font * font) {
+  stbtt_pack_context pack_context;
   struct fc_size dimensions = fc_calculate_pixel_buffer_size(
-      blocks,
-      block_count,
+      font->packing.blocks,
+      font->packing.count,
       font->metadata.size.value
   );
-  size_t pixel_count = (size_t) (dimensions.width * dimensions.height);
-  unsigned char * pixels_1bpp = malloc(pixel_count);
-  unsigned char * pixels_4bpp = malloc(pixel_count * 4);
+  size_t char_count, max_size = font->pages.max_size;
+  stbrp_rect * rects;
 
-  fc_generate_metrics(font);
+  /* a subset font keeps what it cooked once it let go of its font data */
+  if (font->metadata.font_data == NULL) return;
+
+  /* fonts in an atlas are cooked along with every other font in it */
+  if (font->atlas != NULL) {
+    fc_atlas_cook(font->atlas);
+    return;
+  }
+  if (font->glyph_cache.enabled) {
+    fc_glyph_cache_cook(font);
+    return;
+  }
+
+  char_count = fc_cook_begin(font);
 
-  stbtt_pack_range * ranges = font->packing.blocks;
+  /* pages are never larger than the maximum page size, glyphs that do not fit go to the next one */
+  if (max_size > 0 && dimensions.width > (float) max_size) dimensions.width = (float) max_size;
+  if (max_size > 0 && dimensions.height > (float) max_size) dimensions.height = (float) max_size;
 
+  rects = malloc(sizeof(*rects) * (char_count ? char_count : 1));
   stbtt_PackBegin(
-      &pack_context, pixels_1bpp,
+      &pack_context, NULL,
       (int) dimensions.width, (int) dimensions.height,
       0, 1, NULL
   );
-  stbtt_PackFontRanges(
-      &pack_context,
-      font->metadata.font_data,
-      0,
-      ranges,
-      (int) block_count
-  );
+  stbtt_PackSetOversampling(&pack_context, font->sampling.horizontal, font->sampling.vertical);
+  if (rects != NULL) {
+    fc_pack_gather(&pack_context, font->metadata.info, font->packing.blocks, font->packing.count, rects, &font->sdf);
+    fc_pack_pages(&font->pages, &font, 1, &pack_context, rects, font->dynamic.enabled);
+    free(rects);
+  }
 
-  stbtt_PackEnd(&pack_context);
+  /* a dynamic atlas keeps the packer of the last page around to add glyphs later on */
+  if (font->dynamic.enabled) {
+    font->dynamic.context = pack_context;
+    font->dynamic.page_height = (size_t) dimensions.height;
+    font->dynamic.active = 1;
+  } else {
+    stbtt_PackEnd(&pack_context);
+  }
 
-  fc_colorify(
-      pixels_1bpp,
-      pixels_4bpp,
-      dimensions,
-      font->metadata.color
-  );
+  fc_cook_end(font);
+}
 
-  font->pixels.data = pixels_4bpp;
-  font->pixels.dimensions = dimensions;
-  free(pixels_1bpp);
+/* Walks a text glyph by glyph, laying out each of them. The text is decoded once, a chunk at a
+ * time, into the codepoint buffer. The last codepoint of a chunk is carried over to the next one
+ * because it is needed to look up kerning */
+struct fc_glyph_cursor {
+  unsigned char const * text;
+  size_t byte_count;
+  size_t offset;
+  size_t count;
+  size_t end;
+  size_t k;
+  float x, y, kern;
+  uint32_t codepoints[FC_RENDER_CHUNK_SIZE];
+};
+
+static void fc_glyph_cursor_begin(struct fc_glyph_cursor * cursor, unsigned char const * text, size_t byte_count) {
+  cursor->text = text;
+  cursor->byte_count = byte_count;
+  cursor->offset = cursor->count = cursor->end = cursor->k = 0;
+  cursor->x = cursor->y = cursor->kern = 0;
+}
+
+/* lays out the next glyph into `m`, returning zero once the text is over */
+static inline int fc_glyph_cursor_next(
+    struct fc_font const * font,
+    struct fc_glyph_cursor * cursor,
+    struct fc_character_mapping * m
+) {
+  struct fc_rect * src, * dst;
+  size_t consumed, k;
+  uint32_t glyph;
+
+  while (cursor->k >= cursor->end) {
+    if (cursor->end < cursor->count) cursor->codepoints[0] = cursor->codepoints[cursor->end];
+    cursor->count -= cursor->end;
+    cursor->k = cursor->end = 0;
+    if (cursor->offset >= cursor->byte_count) return 0;
+    cursor->count += fc_decode_utf8(
+        cursor->text + cursor->offset,
+        cursor->byte_count - cursor->offset,
+        cursor->codepoints + cursor->count,
+        FC_RENDER_CHUNK_SIZE - cursor->count,
+        &consumed
+    );
+    cursor->offset += consumed;
+    cursor->end = cursor->offset < cursor->byte_count ? cursor->count - 1 : cursor->count;
+  }
+
+  /* find the codepoint in the index, gets its rendering parameters, adds kerning */
+  k = cursor->k++;
+  src = &m->source;
+  dst = &m->target;
+  m->codepoint = cursor->codepoints[k];
+  glyph = fc_index_find(&font->index, m->codepoint);
+
+  /* skips half the pixel "height" if the codepoint was not cooked, leaving an empty mapping */
+  if (glyph == 0) {
+    m->page = 0;
+    src->left = src->top = src->right = src->bottom = 0;
+    dst->left = dst->right = cursor->x;
+    dst->top = dst->bottom = cursor->y;
+    cursor->x += font->metadata.size.value / 2;
+    return 1;
+  }
+
+  cursor->x += cursor->kern;
+
+  /* the quad texture coordinates are not used, the source rect is taken straight from the
+   * packed char instead so that it does not depend on the page dimensions. Distance fields are
+   * meant to be scaled, so their quads are not snapped to whole pixels of the cooked size */
+  stbtt_aligned_quad quad;
+  stbtt_packedchar const * packed = &font->packing.chars[glyph - 1];
+  stbtt_GetPackedQuad(packed, 1, 1, 0, &cursor->x, &cursor->y, &quad, !font->sampling.subpixel && font->sdf.padding == 0);
+
+  m->page = font->packing.pages[glyph - 1];
+  src->left = packed->x0;
+  src->top = packed->y0;
+  src->right = packed->x1;
+  src->bottom = packed->y1;
+
+  dst->left = quad.x0;
+  dst->top = quad.y0;
+  dst->right = quad.x1;
+  dst->bottom = quad.y1;
+
+  /* checks to see if there is kerning to add to the next character, and
+   * sets it to be used in the next iteration */
+  cursor->kern = k + 1 < cursor->count ? fc_get_kern(font, cursor->codepoints[k], cursor->codepoints[k + 1]) : 0;
+  return 1;
 }
 
 struct fc_render_result fc_render(
@@ -108,69 +388,178 @@ struct fc_render_result fc_render(
     size_t byte_count,
     struct fc_character_mapping * mapping
 ) {
+  struct fc_glyph_cursor cursor;
   size_t target_index = 0;
-  stbtt_pack_range * block;
-  float x = 0, y = 0, kern = 0/*, top_offset = 0.0f*/;
-  struct utf8_decode_result decode;
-  float pw = font->pixels.dimensions.width, ph = font->pixels.dimensions.height;
-
-  /* decode all utf8 characters into unicode codepoints, find their
-   * block, gets their rendering parameters, adds kerning */
-  for (size_t i = 0; i < byte_count; i += decode.skip, target_index++) {
-    decode = utf8_decode(text + i, byte_count - i);
-    block = fc_locate_block(font, decode.codepoint);
-    /* skips half the pixel "height" if block was not found */
-    if (block == NULL) {
-      x += font->metadata.size.value / 2;
-      continue;
-    }
-
-    x += kern;
 
-    stbtt_aligned_quad quad;
-    stbtt_GetPackedQuad(
-        block->chardata_for_range,
-        (int) pw,
-        (int) ph,
-        (int) (decode.codepoint - block->first_unicode_codepoint_in_range),
-        &x, &y, &quad, 1
-    );
+  fc_glyph_cursor_begin(&cursor, text, byte_count);
+  while (fc_glyph_cursor_next(font, &cursor, &mapping[target_index])) target_index++;
 
-    struct fc_character_mapping * m = &mapping[target_index];
-    struct fc_rect * src = &m->source, * dst = &m->target;
+  /* end of the loop, target_index will be the amount of decoded glyphs */
+  struct fc_render_result result = {
+      .line_count = 1,
+      .glyph_count = (uint32_t) target_index
+  };
 
+  return result;
+}
 
-    src->left = quad.s0 * pw;
-    src->top = quad.t0 * ph;
-    src->right = quad.s1 * pw;
-    src->bottom = quad.t1 * ph;
+struct fc_render_result fc_render_arrays(
+    struct fc_font const * font,
+    unsigned char const * text,
+    size_t byte_count,
+    struct fc_glyph_arrays * arrays
+) {
+  struct fc_glyph_cursor cursor;
+  struct fc_character_mapping m;
+  struct fc_render_result result = { .line_count = 1, .glyph_count = 0 };
+  size_t i = 0;
+
+  arrays->count = 0;
+  if (!fc_reserve_arrays(arrays, byte_count)) return result;
+
+  fc_glyph_cursor_begin(&cursor, text, byte_count);
+  while (fc_glyph_cursor_next(font, &cursor, &m)) {
+    arrays->left[i] = m.target.left;
+    arrays->top[i] = m.target.top;
+    arrays->right[i] = m.target.right;
+    arrays->bottom[i] = m.target.bottom;
+    arrays->sources[i] = m.source;
+    arrays->codepoints[i] = m.codepoint;
+    arrays->pages[i] = m.page;
+    i++;
+  }
+  arrays->count = i;
+  result.glyph_count = (uint32_t) i;
+  return result;
+}
 
-    dst->left = quad.x0;
-    dst->top = quad.y0;
-    dst->right = quad.x1;
-    dst->bottom = quad.y1;
+static void fc_write_vertex(
+    unsigned char * vertex,
+    struct fc_vertex_layout const * layout,
+    float x,
+    float y,
+    float u,
+    float v
+) {
+  float position[2], uv[2];
+  position[0] = x;
+  position[1] = y;
+  uv[0] = u;
+  uv[1] = v;
+  memcpy(vertex + layout->position, position, sizeof(position));
+  memcpy(vertex + layout->uv, uv, sizeof(uv));
+}
 
-    m->codepoint = decode.codepoint;
+size_t fc_render_vertices(
+    struct fc_font const * font,
+    unsigned char const * text,
+    size_t byte_count,
+    float left,
+    float baseline,
+    struct fc_color color,
+    struct fc_vertex_layout const * layout,
+    struct fc_vertex_buffer * buffer
+) {
+  struct fc_glyph_cursor cursor;
+  struct fc_character_mapping m;
+  size_t capacity = buffer->vertex_capacity, quads = 0, i;
+  unsigned char rgba[4];
+
+  rgba[0] = color.r;
+  rgba[1] = color.g;
+  rgba[2] = color.b;
+  rgba[3] = color.a;
+
+  /* 16-bit indices cannot point past the 65536th vertex */
+  if (buffer->indices != NULL && layout->index_type == fc_index_u16 && capacity > 65536) capacity = 65536;
+
+  fc_glyph_cursor_begin(&cursor, text, byte_count);
+  while (buffer->vertex_count + 4 <= capacity && fc_glyph_cursor_next(font, &cursor, &m)) {
+    struct fc_pixels const * page = &fc_font_pages(font)->items[m.page].pixels;
+    unsigned char * vertex = (unsigned char *) buffer->vertices + buffer->vertex_count * layout->stride;
+    size_t first = buffer->vertex_count;
+    float u0, v0, u1, v1;
+
+    /* glyphs without pixels (e.g, spaces) only move the pen */
+    if (m.source.right <= m.source.left || m.source.bottom <= m.source.top) continue;
+
+    u0 = m.source.left / page->dimensions.width;
+    v0 = m.source.top / page->dimensions.height;
+    u1 = m.source.right / page->dimensions.width;
+    v1 = m.source.bottom / page->dimensions.height;
+    m.target.left += left;
+    m.target.right += left;
+    m.target.top += baseline;
+    m.target.bottom += baseline;
+
+    fc_write_vertex(vertex, layout, m.target.left, m.target.top, u0, v0);
+    fc_write_vertex(vertex + layout->stride, layout, m.target.right, m.target.top, u1, v0);
+    fc_write_vertex(vertex + layout->stride * 2, layout, m.target.right, m.target.bottom, u1, v1);
+    fc_write_vertex(vertex + layout->stride * 3, layout, m.target.left, m.target.bottom, u0, v1);
+    for (i = 0; i < 4; i++, vertex += layout->stride) {
+      if (layout->color != FC_VERTEX_UNUSED) memcpy(vertex + layout->color, rgba, sizeof(rgba));
+      if (layout->page != FC_VERTEX_UNUSED) memcpy(vertex + layout->page, &m.page, sizeof(m.page));
+    }
 
-    /* checks to see if there is kerning to add to the next character, and
-     * sets it to be used in the next iteration */
-    kern = 0;
-    if (i + decode.skip < byte_count) {
-      struct utf8_decode_result next = utf8_decode(
-          text + i + decode.skip,
-          byte_count - (i + decode.skip)
-      );
-      kern = fc_get_kern(font, decode.codepoint, next.codepoint);
+    /* two triangles: top-left, top-right, bottom-right and top-left, bottom-right, bottom-left */
+    if (buffer->indices != NULL) {
+      size_t const corners[6] = { 0, 1, 2, 0, 2, 3 };
+      for (i = 0; i < 6; i++) {
+        if (layout->index_type == fc_index_u16) {
+          ((uint16_t *) buffer->indices)[buffer->index_count + i] = (uint16_t) (first + corners[i]);
+        } else {
+          ((uint32_t *) buffer->indices)[buffer->index_count + i] = (uint32_t) (first + corners[i]);
+        }
+      }
+      buffer->index_count += 6;
     }
+    buffer->vertex_count += 4;
+    quads++;
   }
+  return quads;
+}
 
-  /* end of the loop, target_index will be the amount of decoded glyphs */
-  struct fc_render_result result = {
-      .line_count = 1,
-      .glyph_count = (uint32_t) target_index
-  };
+size_t fc_render_instances(
+    struct fc_font const * font,
+    unsigned char const * text,
+    size_t byte_count,
+    float left,
+    float baseline,
+    struct fc_glyph_instance * instances,
+    size_t capacity
+) {
+  struct fc_glyph_cursor cursor;
+  struct fc_character_mapping m;
+  size_t count = 0;
+
+  fc_glyph_cursor_begin(&cursor, text, byte_count);
+  while (count < capacity && fc_glyph_cursor_next(font, &cursor, &m)) {
+    m.target.left += left;
+    m.target.right += left;
+    m.target.top += baseline;
+    m.target.bottom += baseline;
+    count += fc_make_instances(&m, 1, instances + count);
+  }
+  return count;
+}
 
-  return result;
+struct fc_render_result fc_render_dynamic(
+    struct fc_font * font,
+    unsigned char const * text,
+    size_t byte_count,
+    struct fc_character_mapping * mapping
+) {
+  size_t offset = 0, consumed, count;
+  uint32_t codepoints[FC_RENDER_CHUNK_SIZE];
+
+  /* cooks whatever is missing, a chunk at a time, then renders as usual */
+  while ((font->dynamic.active || font->glyph_cache.active) && offset < byte_count) {
+    count = fc_decode_utf8(text + offset, byte_count - offset, codepoints, FC_RENDER_CHUNK_SIZE, &consumed);
+    offset += consumed;
+    if (font->glyph_cache.active) fc_glyph_cache_fetch(font, codepoints, count);
+    else fc_dynamic_cook(font, codepoints, count);
+  }
+  return fc_render(font, text, byte_count, mapping);
 }
 
 struct fc_font_size fc_get_font_size(struct fc_font const * font) {
@@ -198,22 +587,130 @@ struct fc_unicode_block fc_get_block_at(struct fc_font const * font, size_t inde
   if (index >= font->packing.count) return r;
   r.first = font->packing.blocks[index].first_unicode_codepoint_in_range;
   r.count = font->packing.blocks[index].num_chars;
-  r.last = r.first + r.count;
+  r.last = r.first + r.count - 1;
   return r;
 }
 
 
+void fc_set_kerning_table(struct fc_font * font, uint8_t enabled) {
+  font->kerning.enabled = enabled;
+}
+
+void fc_set_subset(struct fc_font * font, uint8_t enabled) {
+  font->metadata.subset = enabled;
+}
+
+void fc_set_pixel_format(struct fc_font * font, enum fc_pixel_format format) {
+  font->pages.format = format;
+  if (font->pages.count == 0) font->pages.items[0].pixels.format = fc_pages_format(&font->pages);
+}
+
+void fc_set_max_page_size(struct fc_font * font, size_t max_size) {
+  font->pages.max_size = max_size;
+}
+
+void fc_set_thread_count(struct fc_font * font, size_t thread_count) {
+  font->settings.thread_count = thread_count;
+}
+
+void fc_set_executor(struct fc_font * font, struct fc_executor executor) {
+  font->settings.executor = executor;
+}
+
+void fc_set_dynamic_atlas(struct fc_font * font, uint8_t enabled) {
+  font->dynamic.enabled = enabled;
+}
+
+void fc_set_glyph_cache(struct fc_font * font, size_t width, size_t height) {
+  font->glyph_cache.enabled = width > 0 && height > 0;
+  font->glyph_cache.width = width;
+  font->glyph_cache.height = height;
+}
+
+void fc_next_frame(struct fc_font * font) {
+  if (!font->glyph_cache.active) return;
+  font->glyph_cache.frame++;
+  memset(&font->glyph_cache.stats, 0, sizeof(font->glyph_cache.stats));
+}
+
+struct fc_glyph_cache_stats fc_get_glyph_cache_stats(struct fc_font const * font) {
+  struct fc_glyph_cache_stats stats = font->glyph_cache.stats;
+  stats.used = font->glyph_cache.used;
+  stats.capacity = font->glyph_cache.cell_count;
+  return stats;
+}
+
+void fc_set_oversampling(struct fc_font * font, uint8_t horizontal, uint8_t vertical) {
+  font->sampling.horizontal = horizontal < 1 ? 1 : horizontal > FC_MAX_OVERSAMPLING ? FC_MAX_OVERSAMPLING : horizontal;
+  font->sampling.vertical = vertical < 1 ? 1 : vertical > FC_MAX_OVERSAMPLING ? FC_MAX_OVERSAMPLING : vertical;
+}
+
+void fc_set_subpixel_positioning(struct fc_font * font, uint8_t enabled) {
+  font->sampling.subpixel = enabled;
+}
+
+/* single and multi-channel fields share their settings, setting either replaces the other */
+static void fc_set_distance_field(struct fc_font * font, uint8_t padding, uint8_t on_edge_value, uint8_t channels) {
+  font->sdf.padding = padding;
+  font->sdf.on_edge_value = on_edge_value;
+  font->sdf.channels = channels;
+  font->pages.multi_channel = padding > 0 && channels == 3;
+  if (font->pages.count == 0) font->pages.items[0].pixels.format = fc_pages_format(&font->pages);
+}
+
+void fc_set_sdf(struct fc_font * font, uint8_t padding, uint8_t on_edge_value) {
+  fc_set_distance_field(font, padding, on_edge_value, 1);
+}
+
+void fc_set_msdf(struct fc_font * font, uint8_t padding, uint8_t on_edge_value) {
+  fc_set_distance_field(font, padding, on_edge_value, 3);
+}
+
+struct fc_rect const * fc_get_dirty_rects(struct fc_font const * font, size_t page, size_t * count) {
+  struct fc_pages const * pages = fc_font_pages(font);
+  *count = 0;
+  if (page >= pages->count) return NULL;
+  *count = pages->items[page].dirty_count;
+  return pages->items[page].dirty;
+}
+
+void fc_clear_dirty_rects(struct fc_font * font) {
+  size_t i;
+  for (i = 0; i < font->pages.count; i++) font->pages.items[i].dirty_count = 0;
+}
+
+size_t fc_get_kerning_pair_count(struct fc_font const * font) {
+  return font->kerning.count;
+}
+
 struct fc_pixels const * fc_get_pixels(struct fc_font const * font) {
-  return &font->pixels;
+  return &fc_font_pages(font)->items[0].pixels;
+}
+
+size_t fc_get_page_count(struct fc_font const * font) {
+  return fc_font_pages(font)->count;
+}
+
+struct fc_pixels const * fc_get_page(struct fc_font const * font, size_t index) {
+  struct fc_pages const * pages = fc_font_pages(font);
+  if (index >= pages->count) return NULL;
+  return &pages->items[index].pixels;
 }
 
 void fc_destruct(struct fc_font * font) {
-  free(font->pixels.data);
+  if (font->atlas != NULL) fc_atlas_forget(font->atlas, font);
+  fc_cache_release(font);
   free(font->metadata.info);
-  for (size_t i = 0; i < font->packing.count; i++) {
-    free(font->packing.blocks[i].chardata_for_range);
-  }
+  free(font->packing.chars);
+  free(font->packing.codepoints);
+  free(font->packing.pages);
   free(font->packing.blocks);
+  fc_dynamic_clear(&font->dynamic);
+  fc_glyph_cache_clear(&font->glyph_cache);
+  fc_pages_destruct(&font->pages);
+  fc_index_destruct(&font->index);
+  fc_kerning_clear(&font->kerning);
+  fc_font_source_release(font->metadata.source);
   free(font);
 }
 
@@ -225,21 +722,39 @@ struct fc_render_result fc_render_wrapped(
     float line_height_multiplier,
     enum fc_alignment alignment,
     struct fc_character_mapping * mapping
+) {
+  return fc_render_wrapped_with_workspace(font, text, byte_count, line_width, line_height_multiplier, alignment, mapping, NULL, 0);
+}
+
+struct fc_render_result fc_render_wrapped_with_workspace(
+    struct fc_font const * font,
+    unsigned char const * text,
+    size_t byte_count,
+    size_t line_width,
+    float line_height_multiplier,
+    enum fc_alignment alignment,
+    struct fc_character_mapping * mapping,
+    void * workspace,
+    size_t workspace_size
 ) {
   struct fc_render_result result = fc_render(font, text, byte_count, mapping);
   struct fc_size space_metrics = fc_get_space_metrics(font);
-  result.line_count = fc_wrap(mapping, result.glyph_count, (float) line_width, font->metrics.line_height * line_height_multiplier, space_metrics.width, alignment);
+  result.line_count = fc_wrap_with_workspace(
+      mapping,
+      result.glyph_count,
+      (float) line_width,
+      font->metrics.line_height * line_height_multiplier,
+      space_metrics.width,
+      alignment,
+      workspace,
+      workspace_size
+  );
   return result;
 }
 
 struct fc_size fc_get_space_metrics(struct fc_font const * font) {
-  int aw, lsb;
-  float space_width;
   struct fc_size r;
-
-  stbtt_GetCodepointHMetrics(font->metadata.info, 0x20, &aw, &lsb);
-  space_width = (float) (aw + lsb) * font->metrics.scale;
-  r.width = space_width;
+  r.width = font->metrics.space_width;
   r.height = font->metrics.line_height;
   return r;
 }
@@ -0,0 +1,411 @@
+#include "font-internal.h"
+#include "font-chef/glyph-arrays.h"
+#include "simd.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Every array starts at a multiple of this many bytes, so vector loads can be aligned */
+#define FC_ARRAYS_ALIGNMENT 32
+
+static size_t fc_arrays_align(size_t size) {
+  return (size + FC_ARRAYS_ALIGNMENT - 1) / FC_ARRAYS_ALIGNMENT * FC_ARRAYS_ALIGNMENT;
+}
+
+uint8_t fc_reserve_arrays(struct fc_glyph_arrays * arrays, size_t capacity) {
+  struct fc_glyph_arrays grown;
+  size_t floats, rects, words;
+  unsigned char * base;
+
+  if (capacity <= arrays->capacity) return 1;
+  if (capacity < arrays->capacity * 2) capacity = arrays->capacity * 2;
+  if (capacity > SIZE_MAX / (sizeof(float) * 4 + sizeof(struct fc_rect) + sizeof(uint32_t) * 2) / 2) return 0;
+
+  /* all arrays share a single allocation, one after the other */
+  floats = fc_arrays_align(sizeof(float) * capacity);
+  rects = fc_arrays_align(sizeof(struct fc_rect) * capacity);
+  words = fc_arrays_align(sizeof(uint32_t) * capacity);
+  grown.memory = malloc(floats * 4 + rects + words * 2 + FC_ARRAYS_ALIGNMENT - 1);
+  if (grown.memory == NULL) return 0;
+
+  base = grown.memory;
+  base += (FC_ARRAYS_ALIGNMENT - (uintptr_t) base % FC_ARRAYS_ALIGNMENT) % FC_ARRAYS_ALIGNMENT;
+  grown.left = (float *) base;
+  grown.top = (float *) (base + floats);
+  grown.right = (float *) (base + floats * 2);
+  grown.bottom = (float *) (base + floats * 3);
+  grown.sources = (struct fc_rect *) (base + floats * 4);
+  grown.codepoints = (uint32_t *) (base + floats * 4 + rects);
+  grown.pages = (uint32_t *) (base + floats * 4 + rects + words);
+  grown.count = arrays->count;
+  grown.capacity = capacity;
+
+  if (arrays->count > 0) {
+    memcpy(grown.left, arrays->left, sizeof(float) * arrays->count);
+    memcpy(grown.top, arrays->top, sizeof(float) * arrays->count);
+    memcpy(grown.right, arrays->right, sizeof(float) * arrays->count);
+    memcpy(grown.bottom, arrays->bottom, sizeof(float) * arrays->count);
+    memcpy(grown.sources, arrays->sources, sizeof(struct fc_rect) * arrays->count);
+    memcpy(grown.codepoints, arrays->codepoints, sizeof(uint32_t) * arrays->count);
+    memcpy(grown.pages, arrays->pages, sizeof(uint32_t) * arrays->count);
+  }
+  free(arrays->memory);
+  *arrays = grown;
+  return 1;
+}
+
+void fc_free_arrays(struct fc_glyph_arrays * arrays) {
+  free(arrays->memory);
+  memset(arrays, 0, sizeof(*arrays));
+}
+
+/* Kernels that move the target rects of `count` glyphs starting at `first` */
+
+static void fc_arrays_shift_scalar(struct fc_glyph_arrays * arrays, size_t first, size_t count, float dx, float dy) {
+  float * left = arrays->left + first, * right = arrays->right + first;
+  float * top = arrays->top + first, * bottom = arrays->bottom + first;
+  for (size_t i = 0; i < count; i++) {
+    left[i] += dx;
+    right[i] += dx;
+    top[i] += dy;
+    bottom[i] += dy;
+  }
+}
+
+#if defined(FC_SIMD_SSE2)
+static void fc_arrays_shift_sse2(struct fc_glyph_arrays * arrays, size_t first, size_t count, float dx, float dy) {
+  float * left = arrays->left + first, * right = arrays->right + first;
+  float * top = arrays->top + first, * bottom = arrays->bottom + first;
+  __m128 dx4 = _mm_set1_ps(dx), dy4 = _mm_set1_ps(dy);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_ps(left + i, _mm_add_ps(_mm_loadu_ps(left + i), dx4));
+    _mm_storeu_ps(right + i, _mm_add_ps(_mm_loadu_ps(right + i), dx4));
+    _mm_storeu_ps(top + i, _mm_add_ps(_mm_loadu_ps(top + i), dy4));
+    _mm_storeu_ps(bottom + i, _mm_add_ps(_mm_loadu_ps(bottom + i), dy4));
+  }
+  fc_arrays_shift_scalar(arrays, first + i, count - i, dx, dy);
+}
+#endif
+
+#if defined(FC_SIMD_AVX2_DISPATCH)
+FC_TARGET_AVX2
+static void fc_arrays_shift_avx2(struct fc_glyph_arrays * arrays, size_t first, size_t count, float dx, float dy) {
+  float * left = arrays->left + first, * right = arrays->right + first;
+  float * top = arrays->top + first, * bottom = arrays->bottom + first;
+  __m256 dx8 = _mm256_set1_ps(dx), dy8 = _mm256_set1_ps(dy);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(left + i, _mm256_add_ps(_mm256_loadu_ps(left + i), dx8));
+    _mm256_storeu_ps(right + i, _mm256_add_ps(_mm256_loadu_ps(right + i), dx8));
+    _mm256_storeu_ps(top + i, _mm256_add_ps(_mm256_loadu_ps(top + i), dy8));
+    _mm256_storeu_ps(bottom + i, _mm256_add_ps(_mm256_loadu_ps(bottom + i), dy8));
+  }
+  fc_arrays_shift_scalar(arrays, first + i, count - i, dx, dy);
+}
+#endif
+
+#if defined(FC_SIMD_NEON)
+static void fc_arrays_shift_neon(struct fc_glyph_arrays * arrays, size_t first, size_t count, float dx, float dy) {
+  float * left = arrays->left + first, * right = arrays->right + first;
+  float * top = arrays->top + first, * bottom = arrays->bottom + first;
+  float32x4_t dx4 = vdupq_n_f32(dx), dy4 = vdupq_n_f32(dy);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(left + i, vaddq_f32(vld1q_f32(left + i), dx4));
+    vst1q_f32(right + i, vaddq_f32(vld1q_f32(right + i), dx4));
+    vst1q_f32(top + i, vaddq_f32(vld1q_f32(top + i), dy4));
+    vst1q_f32(bottom + i, vaddq_f32(vld1q_f32(bottom + i), dy4));
+  }
+  fc_arrays_shift_scalar(arrays, first + i, count - i, dx, dy);
+}
+#endif
+
+static void fc_arrays_shift(struct fc_glyph_arrays * arrays, size_t first, size_t count, float dx, float dy) {
+  switch (fc_get_simd_level()) {
+#if defined(FC_SIMD_AVX2_DISPATCH)
+    case fc_simd_avx2:
+      fc_arrays_shift_avx2(arrays, first, count, dx, dy);
+      break;
+#endif
+#if defined(FC_SIMD_SSE2)
+    case fc_simd_sse2:
+      fc_arrays_shift_sse2(arrays, first, count, dx, dy);
+      break;
+#endif
+#if defined(FC_SIMD_NEON)
+    case fc_simd_neon:
+      fc_arrays_shift_neon(arrays, first, count, dx, dy);
+      break;
+#endif
+    default:
+      fc_arrays_shift_scalar(arrays, first, count, dx, dy);
+      break;
+  }
+}
+
+/* Kernels that find the bounds of the target rects of `count` glyphs starting at `first`,
+ * starting from `r`. Each vector lane goes through its own glyphs keeping minimums and
+ * maximums as `new < old ? new : old` and `new > old ? new : old`, like the scalar loop */
+
+static struct fc_rect fc_arrays_bounds_scalar(
+    struct fc_glyph_arrays const * arrays,
+    size_t first,
+    size_t count,
+    struct fc_rect r
+) {
+  for (size_t i = first; i < first + count; i++) {
+    if (arrays->top[i] < r.top) r.top = arrays->top[i];
+    if (arrays->bottom[i] > r.bottom) r.bottom = arrays->bottom[i];
+    if (arrays->left[i] < r.left) r.left = arrays->left[i];
+    if (arrays->right[i] > r.right) r.right = arrays->right[i];
+  }
+  return r;
+}
+
+#if defined(FC_SIMD_SSE2)
+static struct fc_rect fc_arrays_bounds_sse2(
+    struct fc_glyph_arrays const * arrays,
+    size_t first,
+    size_t count,
+    struct fc_rect r
+) {
+  float const * left = arrays->left + first, * right = arrays->right + first;
+  float const * top = arrays->top + first, * bottom = arrays->bottom + first;
+  struct fc_rect const start = r;
+  size_t i = 0;
+
+  if (count >= 4) {
+    float lanes[4][4];
+    __m128 l4 = _mm_set1_ps(r.left), t4 = _mm_set1_ps(r.top);
+    __m128 r4 = _mm_set1_ps(r.right), b4 = _mm_set1_ps(r.bottom);
+    for (; i + 4 <= count; i += 4) {
+      l4 = _mm_min_ps(_mm_loadu_ps(left + i), l4);
+      t4 = _mm_min_ps(_mm_loadu_ps(top + i), t4);
+      r4 = _mm_max_ps(_mm_loadu_ps(right + i), r4);
+      b4 = _mm_max_ps(_mm_loadu_ps(bottom + i), b4);
+    }
+    _mm_storeu_ps(lanes[0], l4);
+    _mm_storeu_ps(lanes[1], t4);
+    _mm_storeu_ps(lanes[2], r4);
+    _mm_storeu_ps(lanes[3], b4);
+    if (!fc_bounds_merge_lanes(&r, lanes[0], lanes[1], lanes[2], lanes[3], 4)) {
+      return fc_arrays_bounds_scalar(arrays, first, count, start);
+    }
+  }
+  return fc_arrays_bounds_scalar(arrays, first + i, count - i, r);
+}
+#endif
+
+#if defined(FC_SIMD_AVX2_DISPATCH)
+FC_TARGET_AVX2
+static struct fc_rect fc_arrays_bounds_avx2(
+    struct fc_glyph_arrays const * arrays,
+    size_t first,
+    size_t count,
+    struct fc_rect r
+) {
+  float const * left = arrays->left + first, * right = arrays->right + first;
+  float const * top = arrays->top + first, * bottom = arrays->bottom + first;
+  struct fc_rect const start = r;
+  size_t i = 0;
+
+  if (count >= 8) {
+    float lanes[4][8];
+    __m256 l8 = _mm256_set1_ps(r.left), t8 = _mm256_set1_ps(r.top);
+    __m256 r8 = _mm256_set1_ps(r.right), b8 = _mm256_set1_ps(r.bottom);
+    for (; i + 8 <= count; i += 8) {
+      l8 = _mm256_min_ps(_mm256_loadu_ps(left + i), l8);
+      t8 = _mm256_min_ps(_mm256_loadu_ps(top + i), t8);
+      r8 = _mm256_max_ps(_mm256_loadu_ps(right + i), r8);
+      b8 = _mm256_max_ps(_mm256_loadu_ps(bottom + i), b8);
+    }
+    _mm256_storeu_ps(lanes[0], l8);
+    _mm256_storeu_ps(lanes[1], t8);
+    _mm256_storeu_ps(lanes[2], r8);
+    _mm256_storeu_ps(lanes[3], b8);
+    if (!fc_bounds_merge_lanes(&r, lanes[0], lanes[1], lanes[2], lanes[3], 8)) {
+      return fc_arrays_bounds_scalar(arrays, first, count, start);
+    }
+  }
+  return fc_arrays_bounds_scalar(arrays, first + i, count - i, r);
+}
+#endif
+
+#if defined(FC_SIMD_NEON)
+static struct fc_rect fc_arrays_bounds_neon(
+    struct fc_glyph_arrays const * arrays,
+    size_t first,
+    size_t count,
+    struct fc_rect r
+) {
+  float const * left = arrays->left + first, * right = arrays->right + first;
+  float const * top = arrays->top + first, * bottom = arrays->bottom + first;
+  struct fc_rect const start = r;
+  size_t i = 0;
+
+  if (count >= 4) {
+    float lanes[4][4];
+    float32x4_t l4 = vdupq_n_f32(r.left), t4 = vdupq_n_f32(r.top);
+    float32x4_t r4 = vdupq_n_f32(r.right), b4 = vdupq_n_f32(r.bottom);
+    for (; i + 4 <= count; i += 4) {
+      float32x4_t l = vld1q_f32(left + i), t = vld1q_f32(top + i);
+      float32x4_t rr = vld1q_f32(right + i), b = vld1q_f32(bottom + i);
+      l4 = vbslq_f32(vcltq_f32(l, l4), l, l4);
+      t4 = vbslq_f32(vcltq_f32(t, t4), t, t4);
+      r4 = vbslq_f32(vcgtq_f32(rr, r4), rr, r4);
+      b4 = vbslq_f32(vcgtq_f32(b, b4), b, b4);
+    }
+    vst1q_f32(lanes[0], l4);
+    vst1q_f32(lanes[1], t4);
+    vst1q_f32(lanes[2], r4);
+    vst1q_f32(lanes[3], b4);
+    if (!fc_bounds_merge_lanes(&r, lanes[0], lanes[1], lanes[2], lanes[3], 4)) {
+      return fc_arrays_bounds_scalar(arrays, first, count, start);
+    }
+  }
+  return fc_arrays_bounds_scalar(arrays, first + i, count - i, r);
+}
+#endif
+
+/* same as fc_text_bounds over the target rects of `count` glyphs starting at `first` */
+static struct fc_rect fc_arrays_bounds(struct fc_glyph_arrays const * arrays, size_t first, size_t count) {
+  struct fc_rect r = { .left = 0, .top = 0, .right = 0, .bottom = 0 };
+  if (count < 1) return r;
+  r.left = arrays->left[first];
+  r.top = arrays->top[first];
+  r.right = arrays->right[first + count - 1];
+  r.bottom = arrays->bottom[first];
+
+  switch (fc_get_simd_level()) {
+#if defined(FC_SIMD_AVX2_DISPATCH)
+    case fc_simd_avx2:
+      return fc_arrays_bounds_avx2(arrays, first, count, r);
+#endif
+#if defined(FC_SIMD_SSE2)
+    case fc_simd_sse2:
+      return fc_arrays_bounds_sse2(arrays, first, count, r);
+#endif
+#if defined(FC_SIMD_NEON)
+    case fc_simd_neon:
+      return fc_arrays_bounds_neon(arrays, first, count, r);
+#endif
+    default:
+      return fc_arrays_bounds_scalar(arrays, first, count, r);
+  }
+}
+
+void fc_move_arrays(struct fc_glyph_arrays * arrays, float left, float baseline) {
+  fc_arrays_shift(arrays, 0, arrays->count, left, baseline);
+}
+
+struct fc_rect fc_text_bounds_arrays(struct fc_glyph_arrays const * arrays) {
+  return fc_arrays_bounds(arrays, 0, arrays->count);
+}
+
+/* how many glyphs a segment has. Segments can end before they start (e.g, the word before
+ * a leading space), those have none */
+static size_t fc_segment_length(struct fc_text_segment const * segment) {
+  return segment->last + 1 > segment->first ? segment->last + 1 - segment->first : 0;
+}
+
+/* this follows fc_wrap_with_workspace step by step, so both produce the same rects */
+uint32_t fc_wrap_arrays(
+    struct fc_glyph_arrays * arrays,
+    float line_width,
+    float line_height,
+    float space_width,
+    enum fc_alignment alignment,
+    void * workspace,
+    size_t workspace_size
+) {
+  size_t glyph_count = arrays->count;
+  uint32_t const * codepoints = arrays->codepoints;
+  void * allocated = NULL;
+  uintptr_t address;
+  struct fc_text_segment * words, * lines;
+  size_t word_count = 0, line_count = 1, i;
+  float space_left = line_width;
+
+  if (glyph_count == 0) return 1;
+
+  /* a workspace that is missing or too small is replaced by a temporary one */
+  if (workspace == NULL || workspace_size < fc_wrap_workspace_size(glyph_count)) {
+    allocated = workspace = malloc(fc_wrap_workspace_size(glyph_count));
+    if (workspace == NULL) return 0;
+  }
+  address = (uintptr_t) workspace;
+  address += (sizeof(*words) - address % sizeof(*words)) % sizeof(*words);
+  words = (struct fc_text_segment *) address;
+  lines = words + glyph_count;
+  memset(words, 0, sizeof(*words) * glyph_count * 2);
+
+  /* identify words */
+  for (i = 0; i < glyph_count; i++) {
+    struct fc_text_segment * current_word = &words[word_count];
+    if (current_word->first == 0 && word_count > 0) current_word->first = i;
+
+    if (codepoints[i] == 0x20 || codepoints[i] == '\0') {
+      if (arrays->right[i] - arrays->left[i] < 0.01f) arrays->right[i] = arrays->left[i] + space_width;
+      current_word->last = i - 1;
+      word_count += 1;
+      while (i + 1 < glyph_count && codepoints[i + 1] == 0x20) {
+        i++;
+        fc_arrays_shift(arrays, current_word->first, fc_segment_length(current_word), space_width, 0);
+      }
+    }
+
+    if (i + 1 == glyph_count) {
+      current_word->last = i;
+      word_count += 1;
+    }
+  }
+
+  /* identify lines */
+  for (i = 0; i < word_count; i++) {
+    struct fc_text_segment const * word = &words[i];
+    struct fc_rect bounds = fc_arrays_bounds(arrays, word->first, fc_segment_length(word));
+    float word_width = bounds.right - bounds.left;
+    if (((word_width + space_width) > space_left) && i > 0) {
+      line_count++;
+      lines[line_count - 1].first = word->first;
+      space_left = line_width - word_width;
+    } else {
+      space_left -= word_width + space_width;
+    }
+    lines[line_count - 1].last = word->last;
+  }
+
+  /* moves lines according to alignment */
+  for (i = 0; i < line_count; i++) {
+    struct fc_text_segment const * line = &lines[i];
+    float xadd = -arrays->left[line->first], yadd = i * line_height;
+    float width = arrays->right[line->last] - arrays->left[line->first];
+    switch (alignment) {
+      default:
+      case fc_align_left:
+        break;
+      case fc_align_center:
+        xadd += (line_width - width) / 2;
+        break;
+      case fc_align_right:
+        xadd += line_width - width;
+        break;
+    }
+    fc_arrays_shift(arrays, line->first, fc_segment_length(line), xadd, yadd);
+  }
+
+  /* spaces take the rect of the first glyph that is not a space, so they do not widen bounds */
+  for (i = 0; i < glyph_count && codepoints[i] == 0x20; i++);
+  if (i < glyph_count) {
+    size_t first_non_space = i;
+    for (i = 0; i < glyph_count; i++) {
+      if (codepoints[i] != 0x20) continue;
+      arrays->left[i] = arrays->left[first_non_space];
+      arrays->top[i] = arrays->top[first_non_space];
+      arrays->right[i] = arrays->right[first_non_space];
+      arrays->bottom[i] = arrays->bottom[first_non_space];
+    }
+  }
+  free(allocated);
+  return (uint32_t) line_count;
+}
@@ -0,0 +1,311 @@
+#include "font-internal.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void fc_glyph_cache_unlink(struct fc_glyph_cache * cache, uint32_t cell) {
+  uint32_t previous = cache->previous[cell], next = cache->next[cell];
+  if (previous != FC_GLYPH_CACHE_NONE) cache->next[previous] = next;
+  else cache->head = next;
+  if (next != FC_GLYPH_CACHE_NONE) cache->previous[next] = previous;
+  else cache->tail = previous;
+}
+
+/* makes a cell the most recently used one, used in the current frame */
+static void fc_glyph_cache_push(struct fc_glyph_cache * cache, uint32_t cell) {
+  cache->previous[cell] = FC_GLYPH_CACHE_NONE;
+  cache->next[cell] = cache->head;
+  if (cache->head != FC_GLYPH_CACHE_NONE) cache->previous[cache->head] = cell;
+  else cache->tail = cell;
+  cache->head = cell;
+  cache->frames[cell] = cache->frame;
+}
+
+static void fc_glyph_cache_touch(struct fc_glyph_cache * cache, uint32_t cell) {
+  if (cache->head == cell) {
+    cache->frames[cell] = cache->frame;
+    return;
+  }
+  fc_glyph_cache_unlink(cache, cell);
+  fc_glyph_cache_push(cache, cell);
+}
+
+/* gives up on the glyph of a cell, which becomes the least recently used one so that it is the
+ * first to be taken again */
+static void fc_glyph_cache_drop(struct fc_font * font, uint32_t cell) {
+  struct fc_glyph_cache * cache = &font->glyph_cache;
+  uint32_t codepoint = font->packing.codepoints[cell];
+  if (codepoint != FC_GLYPH_CACHE_NONE) fc_index_remove(&font->index, codepoint);
+  font->packing.codepoints[cell] = FC_GLYPH_CACHE_NONE;
+  memset(&font->packing.chars[cell], 0, sizeof(font->packing.chars[cell]));
+
+  fc_glyph_cache_unlink(cache, cell);
+  cache->previous[cell] = cache->tail;
+  cache->next[cell] = FC_GLYPH_CACHE_NONE;
+  if (cache->tail != FC_GLYPH_CACHE_NONE) cache->next[cache->tail] = cell;
+  else cache->head = cell;
+  cache->tail = cell;
+  cache->frames[cell] = cache->frame - 1;
+  cache->stats.overflows++;
+}
+
+/* finds a cell for a new glyph: one that was never filled, otherwise the least recently used one
+ * unless it was used in the current frame. Returns FC_GLYPH_CACHE_NONE if there is none */
+static uint32_t fc_glyph_cache_take(struct fc_font * font) {
+  struct fc_glyph_cache * cache = &font->glyph_cache;
+  uint32_t cell = cache->tail, codepoint;
+
+  if (cache->used < cache->cell_count) {
+    cell = (uint32_t) cache->used++;
+    font->packing.char_count = cache->used;
+    fc_glyph_cache_push(cache, cell);
+    return cell;
+  }
+  if (cell == FC_GLYPH_CACHE_NONE || cache->frames[cell] == cache->frame) return FC_GLYPH_CACHE_NONE;
+
+  codepoint = font->packing.codepoints[cell];
+  if (codepoint != FC_GLYPH_CACHE_NONE) {
+    fc_index_remove(&font->index, codepoint);
+    cache->stats.evictions++;
+  }
+  fc_glyph_cache_touch(cache, cell);
+  return cell;
+}
+
+/* rasterizes new glyphs into a scratch bitmap laid out as a grid of cells, then copies each cell
+ * to its place in the page, covering whatever glyph was there before */
+static void fc_glyph_cache_render(struct fc_font * font, int * points, uint32_t const * cells, size_t count) {
+  struct fc_glyph_cache * cache = &font->glyph_cache;
+  struct fc_pixels * page = &font->pages.items[0].pixels;
+  size_t cell_width = cache->cell_width, cell_height = cache->cell_height;
+  size_t columns = (size_t) ceil(sqrt((double) count)), rows = (count + columns - 1) / columns;
+  size_t width = columns * cell_width, page_width = (size_t) page->dimensions.width;
+  size_t i, row, bpp = fc_pages_render_bpp(&font->pages);
+  unsigned char * scratch = calloc(width * rows * cell_height, bpp);
+  stbtt_packedchar * chars = calloc(count, sizeof(*chars));
+  stbrp_rect * rects = malloc(sizeof(*rects) * count);
+  stbtt_pack_context context;
+  stbtt_pack_range range;
+  struct fc_size dimensions;
+
+  if (scratch == NULL || chars == NULL || rects == NULL) {
+    for (i = 0; i < count; i++) {
+      fc_glyph_cache_drop(font, cells[i]);
+      cache->stats.misses--;
+    }
+    free(scratch);
+    free(chars);
+    free(rects);
+    return;
+  }
+
+  range.font_size = fc_get_pack_size(font);
+  range.first_unicode_codepoint_in_range = 0;
+  range.array_of_unicode_codepoints = points;
+  range.num_chars = (int) count;
+  range.chardata_for_range = chars;
+
+  stbtt_PackBegin(&context, NULL, (int) width, (int) (rows * cell_height), 0, 1, NULL);
+  stbtt_PackSetOversampling(&context, font->sampling.horizontal, font->sampling.vertical);
+  context.pixels = scratch;
+  context.stride_in_bytes = (int) (width * bpp);
+  fc_pack_gather(&context, font->metadata.info, &range, 1, rects, &font->sdf);
+  for (i = 0; i < count; i++) {
+    rects[i].x = (stbrp_coord) (i % columns * cell_width);
+    rects[i].y = (stbrp_coord) (i / columns * cell_height);
+    rects[i].was_packed = (size_t) rects[i].w <= cell_width && (size_t) rects[i].h <= cell_height;
+  }
+  fc_pack_render(&context, font->metadata.info, &range, 1, rects, &font->sdf, &font->settings.executor, font->settings.thread_count);
+  stbtt_PackEnd(&context);
+
+  dimensions.width = (float) cell_width;
+  dimensions.height = 1;
+  for (i = 0; i < count; i++) {
+    uint32_t cell = cells[i];
+    size_t left = cell % cache->columns * cell_width, top = cell / cache->columns * cell_height;
+    size_t x = i % columns * cell_width, y = i / columns * cell_height;
+    stbtt_packedchar * c = &font->packing.chars[cell];
+    struct fc_rect bounds;
+
+    /* glyphs larger than every glyph of the blocks do not fit in a cell */
+    if (!rects[i].was_packed) {
+      fc_glyph_cache_drop(font, cell);
+      cache->stats.misses--;
+      continue;
+    }
+
+    *c = chars[i];
+    c->x0 = (unsigned short) (c->x0 - x + left);
+    c->x1 = (unsigned short) (c->x1 - x + left);
+    c->y0 = (unsigned short) (c->y0 - y + top);
+    c->y1 = (unsigned short) (c->y1 - y + top);
+    for (row = 0; row < cell_height; row++) {
+      unsigned char * src = scratch + ((y + row) * width + x) * bpp;
+      size_t target = (top + row) * page_width + left;
+      if (bpp == 4) {
+        memcpy(page->data + target * 4, src, cell_width * 4);
+      } else if (page->format == fc_pixel_format_alpha) {
+        memcpy(page->data + target, src, cell_width);
+      } else {
+        fc_colorify(src, page->data + target * 4, dimensions, font->metadata.color);
+      }
+    }
+
+    bounds.left = (float) left;
+    bounds.top = (float) top;
+    bounds.right = (float) (left + cell_width);
+    bounds.bottom = (float) (top + cell_height);
+    fc_pages_mark_dirty(&font->pages, 0, bounds);
+  }
+
+  free(scratch);
+  free(chars);
+  free(rects);
+}
+
+size_t fc_glyph_cache_fetch(struct fc_font * font, uint32_t const * codepoints, size_t count) {
+  struct fc_glyph_cache * cache = &font->glyph_cache;
+  int * points = NULL;
+  uint32_t * cells = NULL;
+  size_t i, missing = 0;
+
+  if (!cache->active) return 0;
+  for (i = 0; i < count; i++) {
+    uint32_t codepoint = codepoints[i], glyph = fc_index_find(&font->index, codepoint), cell;
+    if (glyph != 0) {
+      cache->stats.hits++;
+      fc_glyph_cache_touch(cache, glyph - 1);
+      continue;
+    }
+
+    /* codepoints that the font does not have are not cached, just like in a dynamic atlas */
+    if (codepoint > 0x10FFFF || stbtt_FindGlyphIndex(font->metadata.info, (int) codepoint) == 0) continue;
+
+    /* the common case is that everything hits, which must stay cheap and not allocate */
+    if (points == NULL) {
+      points = malloc(sizeof(*points) * count);
+      cells = malloc(sizeof(*cells) * count);
+      if (points == NULL || cells == NULL) break;
+    }
+
+    cell = fc_glyph_cache_take(font);
+    if (cell == FC_GLYPH_CACHE_NONE) {
+      cache->stats.overflows++;
+      continue;
+    }
+    font->packing.codepoints[cell] = FC_GLYPH_CACHE_NONE;
+    if (!fc_index_insert(&font->index, codepoint, cell)) {
+      fc_glyph_cache_drop(font, cell);
+      continue;
+    }
+    font->packing.codepoints[cell] = codepoint;
+    points[missing] = (int) codepoint;
+    cells[missing++] = cell;
+    cache->stats.misses++;
+  }
+
+  if (missing > 0) fc_glyph_cache_render(font, points, cells, missing);
+  free(points);
+  free(cells);
+  return missing;
+}
+
+void fc_glyph_cache_cook(struct fc_font * font) {
+  struct fc_glyph_cache * cache = &font->glyph_cache;
+  struct fc_packing * packing = &font->packing;
+  struct fc_rect all;
+  unsigned char * coverage;
+  uint32_t codepoints[FC_RENDER_CHUNK_SIZE];
+  size_t i, j, k, count, cell_count, padding = font->sdf.padding;
+  size_t horizontal = padding ? 1 : font->sampling.horizontal, vertical = padding ? 1 : font->sampling.vertical;
+  int x0, y0, x1, y1;
+
+  fc_cache_release(font);
+  fc_dynamic_clear(&font->dynamic);
+  fc_glyph_cache_clear(cache);
+  fc_pages_clear(&font->pages);
+  fc_generate_metrics(font);
+  fc_kerning_clear(&font->kerning);
+  if (!fc_index_build(&font->index, NULL, 0)) return;
+
+  /* every cell has room for the largest glyph of the blocks, as gathered for packing. Without
+   * blocks, it has room for the font bounding box: rounded out to whole pixels, plus the packing
+   * padding, the oversampling filter and the distance field */
+  cache->cell_width = cache->cell_height = 0;
+  for (i = 0, count = 0; i < packing->count; i++) count += (size_t) packing->blocks[i].num_chars;
+  if (count > 0) {
+    stbtt_pack_context context;
+    stbrp_rect * rects = malloc(sizeof(*rects) * count);
+    if (rects == NULL) return;
+    stbtt_PackBegin(&context, NULL, 16, 16, 0, 1, NULL);
+    stbtt_PackSetOversampling(&context, font->sampling.horizontal, font->sampling.vertical);
+    fc_pack_gather(&context, font->metadata.info, packing->blocks, packing->count, rects, &font->sdf);
+    stbtt_PackEnd(&context);
+    for (i = 0; i < count; i++) {
+      if (rects[i].w > cache->cell_width) cache->cell_width = rects[i].w;
+      if (rects[i].h > cache->cell_height) cache->cell_height = rects[i].h;
+    }
+    free(rects);
+  }
+  if (cache->cell_width == 0 || cache->cell_height == 0) {
+    stbtt_GetFontBoundingBox(font->metadata.info, &x0, &y0, &x1, &y1);
+    cache->cell_width = (size_t) ceilf((float) (x1 - x0) * font->metrics.scale * (float) horizontal) + horizontal + 2 + 2 * padding;
+    cache->cell_height = (size_t) ceilf((float) (y1 - y0) * font->metrics.scale * (float) vertical) + vertical + 2 + 2 * padding;
+  }
+  cache->columns = cache->width / cache->cell_width;
+  cell_count = cache->columns * (cache->height / cache->cell_height);
+  if (cell_count >= FC_GLYPH_CACHE_NONE) cell_count = FC_GLYPH_CACHE_NONE - 1;
+
+  free(packing->chars);
+  free(packing->codepoints);
+  free(packing->pages);
+  packing->chars = calloc(cell_count ? cell_count : 1, sizeof(*packing->chars));
+  packing->codepoints = malloc(sizeof(*packing->codepoints) * (cell_count ? cell_count : 1));
+  packing->pages = calloc(cell_count ? cell_count : 1, sizeof(*packing->pages));
+  packing->char_count = 0;
+  packing->char_capacity = cell_count;
+  for (i = 0; i < packing->count; i++) packing->blocks[i].chardata_for_range = NULL;
+  cache->previous = malloc(sizeof(*cache->previous) * (cell_count ? cell_count : 1));
+  cache->next = malloc(sizeof(*cache->next) * (cell_count ? cell_count : 1));
+  cache->frames = malloc(sizeof(*cache->frames) * (cell_count ? cell_count : 1));
+  if (packing->chars == NULL || packing->codepoints == NULL || packing->pages == NULL) return;
+  if (cache->previous == NULL || cache->next == NULL || cache->frames == NULL) return;
+
+  coverage = fc_pages_add(&font->pages, cache->width, cache->height);
+  if (coverage == NULL) return;
+  fc_pages_finish(&font->pages, 0, coverage, font->metadata.color);
+  all.left = all.top = 0;
+  all.right = (float) cache->width;
+  all.bottom = (float) cache->height;
+  fc_pages_mark_dirty(&font->pages, 0, all);
+
+  cache->cell_count = cell_count;
+  cache->used = 0;
+  cache->head = cache->tail = FC_GLYPH_CACHE_NONE;
+  cache->frame = 0;
+  cache->active = 1;
+
+  /* blocks are cooked up front while there are free cells. They all go in frame zero, so none of
+   * them is evicted for another, and they can all be evicted from the first frame on */
+  for (i = 0; i < packing->count && cache->used < cache->cell_count; i++) {
+    stbtt_pack_range const * block = &packing->blocks[i];
+    for (j = 0; j < (size_t) block->num_chars && cache->used < cache->cell_count; j += count) {
+      count = (size_t) block->num_chars - j;
+      if (count > FC_RENDER_CHUNK_SIZE) count = FC_RENDER_CHUNK_SIZE;
+      for (k = 0; k < count; k++) codepoints[k] = (uint32_t) block->first_unicode_codepoint_in_range + (uint32_t) (j + k);
+      fc_glyph_cache_fetch(font, codepoints, count);
+    }
+  }
+  memset(&cache->stats, 0, sizeof(cache->stats));
+  cache->frame = 1;
+}
+
+void fc_glyph_cache_clear(struct fc_glyph_cache * cache) {
+  free(cache->previous);
+  free(cache->next);
+  free(cache->frames);
+  cache->previous = cache->next = cache->frames = NULL;
+  cache->cell_count = cache->used = 0;
+  memset(&cache->stats, 0, sizeof(cache->stats));
+  cache->active = 0;
+}
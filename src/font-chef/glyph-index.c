@@ -0,0 +1,110 @@
+#include "font-internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+int fc_index_construct(struct fc_index * index) {
+  index->flat = calloc(FC_INDEX_FLAT_SIZE, sizeof(*index->flat));
+  index->directory = calloc(FC_INDEX_DIRECTORY_SIZE, sizeof(*index->directory));
+  index->pages = NULL;
+  index->page_count = 0;
+  return index->flat != NULL && index->directory != NULL;
+}
+
+/* first pass allocates a page for every part of the unicode space touched by a block,
+ * second pass fills entries. The first block containing a codepoint wins, matching the
+ * order in which blocks were added. On failure the index is left empty */
+int fc_index_build(struct fc_index * index, stbtt_pack_range const * blocks, size_t block_count) {
+  size_t i, page_count = 0, offset = 0;
+  uint32_t point, first, last;
+
+  if (index->flat == NULL || index->directory == NULL) return 0;
+  memset(index->flat, 0, FC_INDEX_FLAT_SIZE * sizeof(*index->flat));
+  memset(index->directory, 0, FC_INDEX_DIRECTORY_SIZE * sizeof(*index->directory));
+  free(index->pages);
+  index->pages = NULL;
+  index->page_count = 0;
+
+  for (i = 0; i < block_count; i++) {
+    if (blocks[i].num_chars <= 0) continue;
+    first = (uint32_t) blocks[i].first_unicode_codepoint_in_range;
+    last = first + (uint32_t) blocks[i].num_chars - 1;
+    if (last < FC_INDEX_FLAT_SIZE) continue;
+    if (first < FC_INDEX_FLAT_SIZE) first = FC_INDEX_FLAT_SIZE;
+    if (last >= FC_INDEX_DIRECTORY_SIZE << FC_INDEX_PAGE_BITS)
+      last = (FC_INDEX_DIRECTORY_SIZE << FC_INDEX_PAGE_BITS) - 1;
+    for (point = first >> FC_INDEX_PAGE_BITS; point <= last >> FC_INDEX_PAGE_BITS; point++) {
+      if (index->directory[point] != 0) continue;
+      index->directory[point] = (uint16_t) ++page_count;
+    }
+  }
+
+  if (page_count > 0) {
+    index->pages = calloc(page_count * FC_INDEX_PAGE_SIZE, sizeof(*index->pages));
+    if (index->pages == NULL) {
+      /* the directory already points at pages, while the flat table has no entries yet */
+      memset(index->directory, 0, FC_INDEX_DIRECTORY_SIZE * sizeof(*index->directory));
+      return 0;
+    }
+    index->page_count = page_count;
+  }
+
+  for (i = 0; i < block_count; offset += (size_t) blocks[i].num_chars, i++) {
+    int j;
+    for (j = 0; j < blocks[i].num_chars; j++) {
+      uint32_t * entry;
+      point = (uint32_t) blocks[i].first_unicode_codepoint_in_range + (uint32_t) j;
+      if (point < FC_INDEX_FLAT_SIZE) {
+        entry = &index->flat[point];
+      } else if (point < FC_INDEX_DIRECTORY_SIZE << FC_INDEX_PAGE_BITS) {
+        entry = &index->pages[
+          (size_t) (index->directory[point >> FC_INDEX_PAGE_BITS] - 1) * FC_INDEX_PAGE_SIZE
+          + (point & FC_INDEX_PAGE_MASK)
+        ];
+      } else break;
+      if (*entry == 0) *entry = (uint32_t) (offset + (size_t) j + 1);
+    }
+  }
+  return 1;
+}
+
+int fc_index_insert(struct fc_index * index, uint32_t point, size_t position) {
+  uint32_t * entry;
+  if (point < FC_INDEX_FLAT_SIZE) {
+    entry = &index->flat[point];
+  } else if (point < FC_INDEX_DIRECTORY_SIZE << FC_INDEX_PAGE_BITS) {
+    uint16_t page = index->directory[point >> FC_INDEX_PAGE_BITS];
+    if (page == 0) {
+      uint32_t * pages = realloc(index->pages, sizeof(*pages) * (index->page_count + 1) * FC_INDEX_PAGE_SIZE);
+      if (pages == NULL) return 0;
+      memset(pages + index->page_count * FC_INDEX_PAGE_SIZE, 0, sizeof(*pages) * FC_INDEX_PAGE_SIZE);
+      index->pages = pages;
+      page = (uint16_t) ++index->page_count;
+      index->directory[point >> FC_INDEX_PAGE_BITS] = page;
+    }
+    entry = &index->pages[(size_t) (page - 1) * FC_INDEX_PAGE_SIZE + (point & FC_INDEX_PAGE_MASK)];
+  } else return 0;
+  *entry = (uint32_t) (position + 1);
+  return 1;
+}
+
+void fc_index_remove(struct fc_index * index, uint32_t point) {
+  uint16_t page;
+  if (point < FC_INDEX_FLAT_SIZE) {
+    index->flat[point] = 0;
+    return;
+  }
+  if (point >= FC_INDEX_DIRECTORY_SIZE << FC_INDEX_PAGE_BITS) return;
+  page = index->directory[point >> FC_INDEX_PAGE_BITS];
+  if (page == 0) return;
+  index->pages[(size_t) (page - 1) * FC_INDEX_PAGE_SIZE + (point & FC_INDEX_PAGE_MASK)] = 0;
+}
+
+void fc_index_destruct(struct fc_index * index) {
+  free(index->flat);
+  free(index->directory);
+  free(index->pages);
+  index->flat = NULL;
+  index->directory = NULL;
+  index->pages = NULL;
+  index->page_count = 0;
+}
@@ -0,0 +1,459 @@
+#include "font-internal.h"
+#include <stdlib.h>
+
+/* Marks a glyph that can be the first of a kerning pair */
+#define FC_KERNING_FIRST 1u
+
+/* Marks a slot of a kerning row that has no value yet */
+#define FC_KERNING_NONE ((size_t) -1)
+
+static uint16_t fc_read_u16(uint8_t const * p) {
+  return (uint16_t) ((p[0] << 8) | p[1]);
+}
+
+static int16_t fc_read_i16(uint8_t const * p) {
+  return (int16_t) fc_read_u16(p);
+}
+
+static void fc_mark_glyph(uint8_t * marks, int glyph_count, int glyph) {
+  if (glyph >= 0 && glyph < glyph_count) marks[glyph] |= FC_KERNING_FIRST;
+}
+
+static void fc_mark_coverage(uint8_t * marks, int glyph_count, uint8_t const * coverage) {
+  uint16_t i, count = fc_read_u16(coverage + 2);
+  int glyph;
+  if (fc_read_u16(coverage) == 1) {
+    for (i = 0; i < count; i++) fc_mark_glyph(marks, glyph_count, fc_read_u16(coverage + 4 + 2 * i));
+  } else if (fc_read_u16(coverage) == 2) {
+    for (i = 0; i < count; i++) {
+      uint8_t const * range = coverage + 4 + 6 * i;
+      for (glyph = fc_read_u16(range); glyph <= fc_read_u16(range + 2); glyph++) fc_mark_glyph(marks, glyph_count, glyph);
+    }
+  }
+}
+
+/* The position of a glyph in a coverage table, or -1 if it is not covered (as stb_truetype finds it) */
+static long fc_coverage_index(uint8_t const * coverage, int glyph) {
+  long l = 0, r, m;
+  if (fc_read_u16(coverage) == 1) {
+    r = (long) fc_read_u16(coverage + 2) - 1;
+    while (l <= r) {
+      int straw;
+      m = (l + r) >> 1;
+      straw = fc_read_u16(coverage + 4 + 2 * m);
+      if (glyph < straw) r = m - 1;
+      else if (glyph > straw) l = m + 1;
+      else return m;
+    }
+  } else if (fc_read_u16(coverage) == 2) {
+    r = (long) fc_read_u16(coverage + 2) - 1;
+    while (l <= r) {
+      uint8_t const * range;
+      m = (l + r) >> 1;
+      range = coverage + 4 + 6 * m;
+      if (glyph < fc_read_u16(range)) r = m - 1;
+      else if (glyph > fc_read_u16(range + 2)) l = m + 1;
+      else return fc_read_u16(range + 4) + glyph - fc_read_u16(range);
+    }
+  }
+  return -1;
+}
+
+/* The class a class definition table gives a glyph, or -1 if it does not list it (as stb_truetype finds it) */
+static long fc_glyph_class(uint8_t const * class_def, int glyph) {
+  long l = 0, r, m;
+  if (fc_read_u16(class_def) == 1) {
+    int start = fc_read_u16(class_def + 2), count = fc_read_u16(class_def + 4);
+    if (glyph >= start && glyph < start + count) return fc_read_u16(class_def + 6 + 2 * (glyph - start));
+  } else if (fc_read_u16(class_def) == 2) {
+    r = (long) fc_read_u16(class_def + 2) - 1;
+    while (l <= r) {
+      uint8_t const * range;
+      m = (l + r) >> 1;
+      range = class_def + 4 + 6 * m;
+      if (glyph < fc_read_u16(range)) r = m - 1;
+      else if (glyph > fc_read_u16(range + 2)) l = m + 1;
+      else return fc_read_u16(range + 4);
+    }
+  }
+  return -1;
+}
+
+/* marks every glyph that appears on the left side of a pair in the 'kern' table, reading it
+ * the same way stb_truetype does (first table, horizontal, format 0) */
+static void fc_mark_kern_table(stbtt_fontinfo const * info, uint8_t * marks) {
+  uint8_t const * data = info->data + info->kern;
+  uint16_t i, count;
+  if (!info->kern) return;
+  if (fc_read_u16(data + 2) < 1 || fc_read_u16(data + 8) != 1) return;
+  count = fc_read_u16(data + 10);
+  for (i = 0; i < count; i++) fc_mark_glyph(marks, info->numGlyphs, fc_read_u16(data + 18 + i * 6));
+}
+
+/* marks every glyph that can start a pair in the pair adjustment lookups of the 'GPOS' table.
+ * Only the formats stb_truetype understands are considered */
+static void fc_mark_gpos_table(stbtt_fontinfo const * info, uint8_t * marks) {
+  uint8_t const * data = info->data + info->gpos;
+  uint8_t const * lookup_list;
+  uint16_t i, lookup_count;
+  if (!info->gpos) return;
+  if (fc_read_u16(data) != 1 || fc_read_u16(data + 2) != 0) return;
+
+  lookup_list = data + fc_read_u16(data + 8);
+  lookup_count = fc_read_u16(lookup_list);
+  for (i = 0; i < lookup_count; i++) {
+    uint8_t const * lookup = lookup_list + fc_read_u16(lookup_list + 2 + 2 * i);
+    uint16_t j, subtable_count = fc_read_u16(lookup + 4);
+    if (fc_read_u16(lookup) != 2) continue;
+    for (j = 0; j < subtable_count; j++) {
+      uint8_t const * table = lookup + fc_read_u16(lookup + 6 + 2 * j);
+      if (fc_read_u16(table + 4) != 4 || fc_read_u16(table + 6) != 0) continue;
+      fc_mark_coverage(marks, info->numGlyphs, table + fc_read_u16(table + 2));
+    }
+  }
+}
+
+/* A cooked glyph on the second side of a class-based pair subtable, along with its class */
+struct fc_kerning_class {
+  size_t slot;
+  uint16_t value;
+};
+
+/* A pair adjustment subtable of the 'GPOS' table. Class-based ones keep the class of every
+ * cooked glyph their second class definition lists, so that it is only looked up once */
+struct fc_kerning_subtable {
+  uint8_t const * table;
+  struct fc_kerning_class * classes;
+  size_t class_count;
+};
+
+/* Every distinct cooked glyph has a slot. The codepoints of a slot are chained through `next`,
+ * starting at `heads`. A row holds the kerning between the glyph of one slot and every other */
+struct fc_kerning_work {
+  stbtt_fontinfo const * info;
+  int * slots;
+  int * glyphs;
+  size_t * heads;
+  size_t * next;
+  uint8_t * fresh;
+  size_t slot_count;
+  struct fc_kerning_subtable * subtables;
+  size_t subtable_count;
+  int * row;
+  size_t * row_owner;
+  size_t * touched;
+  size_t touched_count;
+};
+
+static void fc_kerning_work_destruct(struct fc_kerning_work * work) {
+  size_t i;
+  for (i = 0; i < work->subtable_count; i++) free(work->subtables[i].classes);
+  free(work->subtables);
+  free(work->slots);
+  free(work->glyphs);
+  free(work->heads);
+  free(work->next);
+  free(work->fresh);
+  free(work->row);
+  free(work->row_owner);
+  free(work->touched);
+}
+
+static int fc_kerning_add_class(struct fc_kerning_subtable * subtable, size_t * capacity, size_t slot, uint16_t value) {
+  if (subtable->class_count >= *capacity) {
+    size_t grown = *capacity ? *capacity * 2 : 16;
+    struct fc_kerning_class * classes = realloc(subtable->classes, sizeof(*classes) * grown);
+    if (classes == NULL) return 0;
+    subtable->classes = classes;
+    *capacity = grown;
+  }
+  subtable->classes[subtable->class_count].slot = slot;
+  subtable->classes[subtable->class_count].value = value;
+  subtable->class_count++;
+  return 1;
+}
+
+/* walks a class definition table, keeping the classes of cooked glyphs that are below `class_count` */
+static int fc_kerning_gather_classes(struct fc_kerning_work * work, struct fc_kerning_subtable * subtable, uint8_t const * class_def, uint16_t class_count) {
+  size_t capacity = 0;
+  uint16_t i, count;
+  int glyph, glyph_count = work->info->numGlyphs;
+  if (fc_read_u16(class_def) == 1) {
+    int start = fc_read_u16(class_def + 2);
+    count = fc_read_u16(class_def + 4);
+    for (i = 0; i < count && start + i < glyph_count; i++) {
+      uint16_t value = fc_read_u16(class_def + 6 + 2 * i);
+      if (work->slots[start + i] >= 0 && value < class_count &&
+          !fc_kerning_add_class(subtable, &capacity, (size_t) work->slots[start + i], value)) return 0;
+    }
+  } else if (fc_read_u16(class_def) == 2) {
+    count = fc_read_u16(class_def + 2);
+    for (i = 0; i < count; i++) {
+      uint8_t const * range = class_def + 4 + 6 * i;
+      uint16_t value = fc_read_u16(range + 4);
+      if (value >= class_count) continue;
+      for (glyph = fc_read_u16(range); glyph <= fc_read_u16(range + 2) && glyph < glyph_count; glyph++) {
+        if (work->slots[glyph] >= 0 && !fc_kerning_add_class(subtable, &capacity, (size_t) work->slots[glyph], value)) return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+/* lists the pair adjustment subtables of the 'GPOS' table, in the order stb_truetype looks at them */
+static int fc_kerning_gather_subtables(struct fc_kerning_work * work) {
+  stbtt_fontinfo const * info = work->info;
+  uint8_t const * data = info->data + info->gpos;
+  uint8_t const * lookup_list;
+  uint16_t i, lookup_count;
+  size_t capacity = 0;
+  if (!info->gpos) return 1;
+  if (fc_read_u16(data) != 1 || fc_read_u16(data + 2) != 0) return 1;
+
+  lookup_list = data + fc_read_u16(data + 8);
+  lookup_count = fc_read_u16(lookup_list);
+  for (i = 0; i < lookup_count; i++) {
+    uint8_t const * lookup = lookup_list + fc_read_u16(lookup_list + 2 + 2 * i);
+    uint16_t j, subtable_count = fc_read_u16(lookup + 4);
+    if (fc_read_u16(lookup) != 2) continue;
+    for (j = 0; j < subtable_count; j++) {
+      uint8_t const * table = lookup + fc_read_u16(lookup + 6 + 2 * j);
+      struct fc_kerning_subtable * subtable;
+      if (fc_read_u16(table) != 1 && fc_read_u16(table) != 2) continue;
+      if (work->subtable_count >= capacity) {
+        size_t grown = capacity ? capacity * 2 : 16;
+        struct fc_kerning_subtable * subtables = realloc(work->subtables, sizeof(*subtables) * grown);
+        if (subtables == NULL) return 0;
+        work->subtables = subtables;
+        capacity = grown;
+      }
+      subtable = &work->subtables[work->subtable_count++];
+      subtable->table = table;
+      subtable->classes = NULL;
+      subtable->class_count = 0;
+      if (fc_read_u16(table) == 2 && fc_read_u16(table + 4) == 4 && fc_read_u16(table + 6) == 0 &&
+          !fc_kerning_gather_classes(work, subtable, table + fc_read_u16(table + 10), fc_read_u16(table + 14))) return 0;
+    }
+  }
+  return 1;
+}
+
+/* whether the row being filled for `owner` already has a value for `slot`. Pairs of glyphs
+ * cooked before the ones being added are skipped, they are in the table already */
+static int fc_kerning_row_has(struct fc_kerning_work const * work, size_t owner, size_t slot) {
+  return work->row_owner[slot] == owner || (!work->fresh[owner] && !work->fresh[slot]);
+}
+
+static void fc_kerning_row_set(struct fc_kerning_work * work, size_t owner, size_t slot, int value) {
+  work->row_owner[slot] = owner;
+  work->row[slot] = value;
+  work->touched[work->touched_count++] = slot;
+}
+
+/* fills the row of a glyph with what stb_truetype would return for it, but a table at a time
+ * rather than a pair at a time: in 'GPOS', the first pair subtable that covers the glyph and has
+ * a value for the second one wins, and 'kern' adds its own value to it */
+static void fc_kerning_fill_row(struct fc_kerning_work * work, size_t owner) {
+  stbtt_fontinfo const * info = work->info;
+  int glyph = work->glyphs[owner];
+  size_t i, k;
+
+  work->touched_count = 0;
+  for (i = 0; i < work->subtable_count; i++) {
+    struct fc_kerning_subtable const * subtable = &work->subtables[i];
+    uint8_t const * table = subtable->table;
+    long coverage_index = fc_coverage_index(table + fc_read_u16(table + 2), glyph);
+    if (coverage_index < 0) continue;
+    /* stb_truetype gives up on 'GPOS' altogether for value formats other than a first advance */
+    if (fc_read_u16(table + 4) != 4 || fc_read_u16(table + 6) != 0) break;
+
+    if (fc_read_u16(table) == 1) {
+      uint8_t const * set = table + fc_read_u16(table + 10 + 2 * coverage_index);
+      uint16_t count = fc_read_u16(set);
+      for (k = 0; k < count; k++) {
+        int second = fc_read_u16(set + 2 + 4 * k);
+        int slot = second < info->numGlyphs ? work->slots[second] : -1;
+        if (slot < 0 || fc_kerning_row_has(work, owner, (size_t) slot)) continue;
+        fc_kerning_row_set(work, owner, (size_t) slot, fc_read_i16(set + 4 + 4 * k));
+      }
+    } else {
+      long first_class = fc_glyph_class(table + fc_read_u16(table + 8), glyph);
+      uint16_t second_count = fc_read_u16(table + 14);
+      uint8_t const * records;
+      if (first_class < 0 || first_class >= fc_read_u16(table + 12)) continue;
+      records = table + 16 + 2 * (size_t) first_class * second_count;
+      for (k = 0; k < subtable->class_count; k++) {
+        size_t slot = subtable->classes[k].slot;
+        if (fc_kerning_row_has(work, owner, slot)) continue;
+        fc_kerning_row_set(work, owner, slot, fc_read_i16(records + 2 * subtable->classes[k].value));
+      }
+    }
+  }
+
+  if (info->kern) {
+    uint8_t const * data = info->data + info->kern;
+    long l = 0, r, m;
+    if (fc_read_u16(data + 2) < 1 || fc_read_u16(data + 8) != 1) return;
+    /* pairs are sorted by their first glyph, so those of this glyph follow the first of them */
+    r = (long) fc_read_u16(data + 10);
+    while (l < r) {
+      m = (l + r) >> 1;
+      if (fc_read_u16(data + 18 + m * 6) < glyph) l = m + 1;
+      else r = m;
+    }
+    for (; l < fc_read_u16(data + 10) && fc_read_u16(data + 18 + l * 6) == glyph; l++) {
+      int second = fc_read_u16(data + 20 + l * 6);
+      int slot = second < info->numGlyphs ? work->slots[second] : -1;
+      if (slot < 0) continue;
+      if (work->row_owner[slot] == owner) work->row[slot] += fc_read_i16(data + 22 + l * 6);
+      else if (!fc_kerning_row_has(work, owner, (size_t) slot)) fc_kerning_row_set(work, owner, (size_t) slot, fc_read_i16(data + 22 + l * 6));
+    }
+  }
+}
+
+static int fc_kerning_grow(struct fc_kerning * kerning) {
+  size_t i, capacity = kerning->capacity ? kerning->capacity * 2 : 64;
+  struct fc_kerning_pair * old = kerning->pairs;
+  struct fc_kerning_pair * pairs = malloc(sizeof(*pairs) * capacity);
+  if (pairs == NULL) return 0;
+  for (i = 0; i < capacity; i++) pairs[i].first = FC_KERNING_EMPTY;
+
+  kerning->pairs = pairs;
+  kerning->capacity = capacity;
+  kerning->count = 0;
+  for (i = 0; old != NULL && i < capacity / 2; i++) {
+    if (old[i].first != FC_KERNING_EMPTY) fc_kerning_insert(kerning, old[i].first, old[i].second, old[i].kern);
+  }
+  free(old);
+  return 1;
+}
+
+int fc_kerning_insert(struct fc_kerning * kerning, uint32_t first, uint32_t second, float kern) {
+  size_t i, mask;
+  /* keeps the load factor under one half so probes stay short */
+  if ((kerning->count + 1) * 2 > kerning->capacity && !fc_kerning_grow(kerning)) return 0;
+  mask = kerning->capacity - 1;
+  for (i = fc_kerning_hash(first, second) & mask; ; i = (i + 1) & mask) {
+    struct fc_kerning_pair * pair = &kerning->pairs[i];
+    if (pair->first == FC_KERNING_EMPTY) {
+      pair->first = first;
+      pair->second = second;
+      kerning->count += 1;
+    } else if (pair->first != first || pair->second != second) continue;
+    pair->kern = kern;
+    return 1;
+  }
+}
+
+void fc_kerning_clear(struct fc_kerning * kerning) {
+  free(kerning->pairs);
+  free(kerning->marks);
+  kerning->pairs = NULL;
+  kerning->marks = NULL;
+  kerning->capacity = 0;
+  kerning->count = 0;
+  kerning->built = 0;
+}
+
+/* Rather than asking stb_truetype about every possible pair, this walks the pairs listed in the
+ * 'kern' and 'GPOS' tables for each cooked glyph that can start one, keeping those whose second
+ * glyph was cooked too. Glyphs that start no pair are told apart beforehand with marks, which are
+ * kept so the table can be extended */
+int fc_kerning_build(
+    struct fc_kerning * kerning,
+    stbtt_fontinfo const * info,
+    float scale,
+    uint32_t const * codepoints,
+    size_t count
+) {
+  fc_kerning_clear(kerning);
+  kerning->built = 1;
+  if (!info->kern && !info->gpos) return 1;
+
+  kerning->marks = calloc((size_t) info->numGlyphs, sizeof(*kerning->marks));
+  if (kerning->marks == NULL) {
+    kerning->built = 0;
+    return 0;
+  }
+  fc_mark_kern_table(info, kerning->marks);
+  fc_mark_gpos_table(info, kerning->marks);
+  return fc_kerning_extend(kerning, info, scale, codepoints, count, 0);
+}
+
+int fc_kerning_extend(
+    struct fc_kerning * kerning,
+    stbtt_fontinfo const * info,
+    float scale,
+    uint32_t const * codepoints,
+    size_t count,
+    size_t first_new
+) {
+  struct fc_kerning_work work = { 0 };
+  size_t i, j, a, b;
+
+  if (!kerning->built) return 0;
+  if (kerning->marks == NULL || first_new >= count) return 1;
+
+  work.info = info;
+  work.slots = malloc(sizeof(*work.slots) * (size_t) info->numGlyphs);
+  work.glyphs = malloc(sizeof(*work.glyphs) * count);
+  work.heads = malloc(sizeof(*work.heads) * count);
+  work.next = malloc(sizeof(*work.next) * count);
+  work.fresh = malloc(count);
+  work.row = malloc(sizeof(*work.row) * count);
+  work.row_owner = malloc(sizeof(*work.row_owner) * count);
+  work.touched = malloc(sizeof(*work.touched) * count);
+  if (!work.slots || !work.glyphs || !work.heads || !work.next || !work.fresh || !work.row || !work.row_owner || !work.touched) {
+    fc_kerning_work_destruct(&work);
+    fc_kerning_clear(kerning);
+    return 0;
+  }
+
+  /* gives each distinct cooked glyph a slot, chaining the codepoints that share it */
+  for (i = 0; i < (size_t) info->numGlyphs; i++) work.slots[i] = -1;
+  for (i = count; i-- > 0;) {
+    int glyph = stbtt_FindGlyphIndex(info, (int) codepoints[i]);
+    size_t slot;
+    if (glyph < 0 || glyph >= info->numGlyphs) continue;
+    if (work.slots[glyph] < 0) {
+      slot = work.slot_count++;
+      work.slots[glyph] = (int) slot;
+      work.glyphs[slot] = glyph;
+      work.heads[slot] = FC_KERNING_NONE;
+      work.fresh[slot] = 0;
+      work.row_owner[slot] = FC_KERNING_NONE;
+    }
+    slot = (size_t) work.slots[glyph];
+    work.next[i] = work.heads[slot];
+    work.heads[slot] = i;
+    if (i >= first_new) work.fresh[slot] = 1;
+  }
+
+  if (!fc_kerning_gather_subtables(&work)) {
+    fc_kerning_work_destruct(&work);
+    fc_kerning_clear(kerning);
+    return 0;
+  }
+
+  for (i = 0; i < work.slot_count && kerning->built; i++) {
+    if (!(kerning->marks[work.glyphs[i]] & FC_KERNING_FIRST)) continue;
+    fc_kerning_fill_row(&work, i);
+    for (j = 0; j < work.touched_count && kerning->built; j++) {
+      size_t slot = work.touched[j];
+      float kern = scale * (float) work.row[slot];
+      if (work.row[slot] == 0) continue;
+      for (a = work.heads[i]; a != FC_KERNING_NONE && kerning->built; a = work.next[a]) {
+        for (b = work.heads[slot]; b != FC_KERNING_NONE; b = work.next[b]) {
+          if (a < first_new && b < first_new) continue;
+          if (!fc_kerning_insert(kerning, codepoints[a], codepoints[b], kern)) {
+            fc_kerning_clear(kerning);
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  fc_kerning_work_destruct(&work);
+  return kerning->built;
+}
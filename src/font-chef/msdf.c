@@ -0,0 +1,683 @@
+#include "font-internal.h"
+#include <math.h>
+#include <stdlib.h>
+
+/* A multi-channel distance field stores, in each of its red, green and blue channels, the distance to
+ * a subset of the glyph edges. Edges are colored so that the two edges meeting at a corner never share
+ * every channel: the median of the three channels then keeps the corner sharp, where a single distance
+ * would round it. This follows the approach of Viktor Chlumsky's msdfgen */
+
+#define FC_MSDF_RED 1
+#define FC_MSDF_GREEN 2
+#define FC_MSDF_BLUE 4
+#define FC_MSDF_YELLOW (FC_MSDF_RED | FC_MSDF_GREEN)
+#define FC_MSDF_MAGENTA (FC_MSDF_RED | FC_MSDF_BLUE)
+#define FC_MSDF_CYAN (FC_MSDF_GREEN | FC_MSDF_BLUE)
+#define FC_MSDF_WHITE (FC_MSDF_RED | FC_MSDF_GREEN | FC_MSDF_BLUE)
+
+/* edges meeting at an angle sharper than about 3 radians (sin(3) ~ 0.141) make a corner */
+#define FC_MSDF_CORNER_CROSS 0.141
+
+/* neighbouring pixels whose channels differ by more than a pixel (plus some slack) clash */
+#define FC_MSDF_CLASH_THRESHOLD 1.001
+
+/* how cubic curves are searched for their closest point */
+#define FC_MSDF_CUBIC_STARTS 4
+#define FC_MSDF_CUBIC_STEPS 4
+
+#define FC_MSDF_PI 3.14159265358979323846
+
+struct fc_msdf_point {
+  double x, y;
+};
+
+/* a line (degree 1), quadratic (degree 2) or cubic (degree 3) curve, in pixels with y pointing up.
+ * The curve never leaves the box around its control points */
+struct fc_msdf_edge {
+  struct fc_msdf_point p[4];
+  struct fc_msdf_point low;
+  struct fc_msdf_point high;
+  int degree;
+  int color;
+};
+
+/* a distance to an edge, along with how orthogonal the edge is to it (0 is orthogonal), which
+ * tells apart edges that are equally distant at the corner they share */
+struct fc_msdf_distance {
+  double distance;
+  double dot;
+};
+
+struct fc_msdf_shape {
+  struct fc_msdf_edge * edges;
+  size_t count;
+  size_t capacity;
+};
+
+static struct fc_msdf_point fc_msdf_point(double x, double y) {
+  struct fc_msdf_point p;
+  p.x = x;
+  p.y = y;
+  return p;
+}
+
+static struct fc_msdf_point fc_msdf_add(struct fc_msdf_point a, struct fc_msdf_point b) {
+  return fc_msdf_point(a.x + b.x, a.y + b.y);
+}
+
+static struct fc_msdf_point fc_msdf_sub(struct fc_msdf_point a, struct fc_msdf_point b) {
+  return fc_msdf_point(a.x - b.x, a.y - b.y);
+}
+
+static struct fc_msdf_point fc_msdf_mul(struct fc_msdf_point a, double s) {
+  return fc_msdf_point(a.x * s, a.y * s);
+}
+
+static struct fc_msdf_point fc_msdf_mix(struct fc_msdf_point a, struct fc_msdf_point b, double t) {
+  return fc_msdf_point(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t);
+}
+
+static double fc_msdf_dot(struct fc_msdf_point a, struct fc_msdf_point b) {
+  return a.x * b.x + a.y * b.y;
+}
+
+static double fc_msdf_cross(struct fc_msdf_point a, struct fc_msdf_point b) {
+  return a.x * b.y - a.y * b.x;
+}
+
+static double fc_msdf_length(struct fc_msdf_point a) {
+  return sqrt(a.x * a.x + a.y * a.y);
+}
+
+static struct fc_msdf_point fc_msdf_normalize(struct fc_msdf_point a) {
+  double length = fc_msdf_length(a);
+  if (length == 0) return fc_msdf_point(0, 1);
+  return fc_msdf_point(a.x / length, a.y / length);
+}
+
+static double fc_msdf_sign(double value) {
+  return value > 0 ? 1 : -1;
+}
+
+static int fc_msdf_closer(struct fc_msdf_distance a, struct fc_msdf_distance b) {
+  return fabs(a.distance) < fabs(b.distance) || (fabs(a.distance) == fabs(b.distance) && a.dot < b.dot);
+}
+
+/* solves a x^2 + b x + c = 0, returning how many roots were found (-1 for infinitely many) */
+static int fc_msdf_solve_quadratic(double x[2], double a, double b, double c) {
+  double discriminant;
+  if (a == 0 || fabs(b) > 1e12 * fabs(a)) {
+    if (b == 0) return c == 0 ? -1 : 0;
+    x[0] = -c / b;
+    return 1;
+  }
+  discriminant = b * b - 4 * a * c;
+  if (discriminant > 0) {
+    discriminant = sqrt(discriminant);
+    x[0] = (-b + discriminant) / (2 * a);
+    x[1] = (-b - discriminant) / (2 * a);
+    return 2;
+  }
+  if (discriminant == 0) {
+    x[0] = -b / (2 * a);
+    return 1;
+  }
+  return 0;
+}
+
+/* solves x^3 + a x^2 + b x + c = 0 */
+static int fc_msdf_solve_cubic_normed(double x[3], double a, double b, double c) {
+  double a2 = a * a;
+  double q = (a2 - 3 * b) / 9;
+  double r = (a * (2 * a2 - 9 * b) + 27 * c) / 54;
+  double r2 = r * r, q3 = q * q * q;
+  a /= 3;
+  if (r2 < q3) {
+    double t = r / sqrt(q3);
+    if (t < -1) t = -1;
+    if (t > 1) t = 1;
+    t = acos(t);
+    q = -2 * sqrt(q);
+    x[0] = q * cos(t / 3) - a;
+    x[1] = q * cos((t + 2 * FC_MSDF_PI) / 3) - a;
+    x[2] = q * cos((t - 2 * FC_MSDF_PI) / 3) - a;
+    return 3;
+  } else {
+    double u = (r < 0 ? 1 : -1) * pow(fabs(r) + sqrt(r2 - q3), 1.0 / 3);
+    double v = u == 0 ? 0 : q / u;
+    x[0] = (u + v) - a;
+    if (u == v || fabs(u - v) < 1e-12 * fabs(u + v)) {
+      x[1] = -0.5 * (u + v) - a;
+      return 2;
+    }
+    return 1;
+  }
+}
+
+/* solves a x^3 + b x^2 + c x + d = 0 */
+static int fc_msdf_solve_cubic(double x[3], double a, double b, double c, double d) {
+  if (a != 0 && fabs(b / a) < 1e6) return fc_msdf_solve_cubic_normed(x, b / a, c / a, d / a);
+  return fc_msdf_solve_quadratic(x, b, c, d);
+}
+
+static struct fc_msdf_point fc_msdf_edge_point(struct fc_msdf_edge const * e, double t) {
+  struct fc_msdf_point p12;
+  switch (e->degree) {
+    case 1:
+      return fc_msdf_mix(e->p[0], e->p[1], t);
+    case 2:
+      return fc_msdf_mix(fc_msdf_mix(e->p[0], e->p[1], t), fc_msdf_mix(e->p[1], e->p[2], t), t);
+    default:
+      p12 = fc_msdf_mix(e->p[1], e->p[2], t);
+      return fc_msdf_mix(
+          fc_msdf_mix(fc_msdf_mix(e->p[0], e->p[1], t), p12, t),
+          fc_msdf_mix(p12, fc_msdf_mix(e->p[2], e->p[3], t), t),
+          t
+      );
+  }
+}
+
+/* the tangent of the edge at t, falling back to the chord where control points overlap */
+static struct fc_msdf_point fc_msdf_edge_direction(struct fc_msdf_edge const * e, double t) {
+  struct fc_msdf_point tangent;
+  switch (e->degree) {
+    case 1:
+      return fc_msdf_sub(e->p[1], e->p[0]);
+    case 2:
+      tangent = fc_msdf_mix(fc_msdf_sub(e->p[1], e->p[0]), fc_msdf_sub(e->p[2], e->p[1]), t);
+      if (tangent.x == 0 && tangent.y == 0) return fc_msdf_sub(e->p[2], e->p[0]);
+      return tangent;
+    default:
+      tangent = fc_msdf_mix(
+          fc_msdf_mix(fc_msdf_sub(e->p[1], e->p[0]), fc_msdf_sub(e->p[2], e->p[1]), t),
+          fc_msdf_mix(fc_msdf_sub(e->p[2], e->p[1]), fc_msdf_sub(e->p[3], e->p[2]), t),
+          t
+      );
+      if (tangent.x == 0 && tangent.y == 0) {
+        if (t == 0) return fc_msdf_sub(e->p[2], e->p[0]);
+        if (t == 1) return fc_msdf_sub(e->p[3], e->p[1]);
+      }
+      return tangent;
+  }
+}
+
+/* splits an edge in three parts of equal parameter range, keeping its color */
+static void fc_msdf_split_thirds(struct fc_msdf_edge const * e, struct fc_msdf_edge parts[3]) {
+  int i;
+  double t[4] = { 0, 1.0 / 3, 2.0 / 3, 1 };
+  for (i = 0; i < 3; i++) {
+    double t0 = t[i], t1 = t[i + 1];
+    parts[i] = *e;
+    parts[i].p[0] = fc_msdf_edge_point(e, t0);
+    parts[i].p[e->degree] = fc_msdf_edge_point(e, t1);
+    if (e->degree == 2) {
+      /* the control point of a piece of a quadratic curve is where the tangents at its ends meet */
+      parts[i].p[1] = fc_msdf_mix(fc_msdf_mix(e->p[0], e->p[1], t0), fc_msdf_mix(e->p[1], e->p[2], t0), t1);
+    } else if (e->degree == 3) {
+      /* the control points of a piece of a cubic curve follow its derivative at each end */
+      struct fc_msdf_point d0 = fc_msdf_mix(
+          fc_msdf_mix(fc_msdf_sub(e->p[1], e->p[0]), fc_msdf_sub(e->p[2], e->p[1]), t0),
+          fc_msdf_mix(fc_msdf_sub(e->p[2], e->p[1]), fc_msdf_sub(e->p[3], e->p[2]), t0),
+          t0
+      );
+      struct fc_msdf_point d1 = fc_msdf_mix(
+          fc_msdf_mix(fc_msdf_sub(e->p[1], e->p[0]), fc_msdf_sub(e->p[2], e->p[1]), t1),
+          fc_msdf_mix(fc_msdf_sub(e->p[2], e->p[1]), fc_msdf_sub(e->p[3], e->p[2]), t1),
+          t1
+      );
+      parts[i].p[1] = fc_msdf_add(parts[i].p[0], fc_msdf_mul(d0, t1 - t0));
+      parts[i].p[2] = fc_msdf_sub(parts[i].p[3], fc_msdf_mul(d1, t1 - t0));
+    }
+  }
+}
+
+/* signed distance from `origin` to the edge, and the parameter of the closest point (outside of
+ * [0, 1] when it is past an end, for fc_msdf_pseudo_distance) */
+static struct fc_msdf_distance fc_msdf_edge_distance(
+    struct fc_msdf_edge const * e,
+    struct fc_msdf_point origin,
+    double * param
+) {
+  struct fc_msdf_distance result;
+  struct fc_msdf_point qa = fc_msdf_sub(e->p[0], origin), ab = fc_msdf_sub(e->p[1], e->p[0]);
+  struct fc_msdf_point end = fc_msdf_sub(e->p[e->degree], origin), direction;
+  double min_distance, distance;
+  int i;
+
+  if (e->degree == 1) {
+    struct fc_msdf_point aq = fc_msdf_sub(origin, e->p[0]), eq;
+    double endpoint_distance;
+    *param = fc_msdf_dot(aq, ab) / fc_msdf_dot(ab, ab);
+    eq = fc_msdf_sub(*param > 0.5 ? e->p[1] : e->p[0], origin);
+    endpoint_distance = fc_msdf_length(eq);
+    if (*param > 0 && *param < 1) {
+      struct fc_msdf_point normal = fc_msdf_normalize(fc_msdf_point(ab.y, -ab.x));
+      double ortho_distance = fc_msdf_dot(normal, aq);
+      if (fabs(ortho_distance) < endpoint_distance) {
+        result.distance = ortho_distance;
+        result.dot = 0;
+        return result;
+      }
+    }
+    result.distance = fc_msdf_sign(fc_msdf_cross(aq, ab)) * endpoint_distance;
+    result.dot = fabs(fc_msdf_dot(fc_msdf_normalize(ab), fc_msdf_normalize(eq)));
+    return result;
+  }
+
+  /* the distance to each end first */
+  direction = fc_msdf_edge_direction(e, 0);
+  min_distance = fc_msdf_sign(fc_msdf_cross(direction, qa)) * fc_msdf_length(qa);
+  *param = -fc_msdf_dot(qa, direction) / fc_msdf_dot(direction, direction);
+  direction = fc_msdf_edge_direction(e, 1);
+  distance = fc_msdf_length(end);
+  if (distance < fabs(min_distance)) {
+    min_distance = fc_msdf_sign(fc_msdf_cross(direction, end)) * distance;
+    *param = fc_msdf_dot(fc_msdf_sub(origin, e->p[e->degree - 1]), direction) / fc_msdf_dot(direction, direction);
+  }
+
+  if (e->degree == 2) {
+    /* the closest point zeroes the derivative of the squared distance, a cubic polynomial */
+    struct fc_msdf_point br = fc_msdf_sub(fc_msdf_sub(e->p[2], e->p[1]), ab);
+    double t[3];
+    int solutions = fc_msdf_solve_cubic(
+        t,
+        fc_msdf_dot(br, br),
+        3 * fc_msdf_dot(ab, br),
+        2 * fc_msdf_dot(ab, ab) + fc_msdf_dot(qa, br),
+        fc_msdf_dot(qa, ab)
+    );
+    for (i = 0; i < solutions; i++) {
+      struct fc_msdf_point qe;
+      if (t[i] <= 0 || t[i] >= 1) continue;
+      qe = fc_msdf_add(fc_msdf_add(qa, fc_msdf_mul(ab, 2 * t[i])), fc_msdf_mul(br, t[i] * t[i]));
+      distance = fc_msdf_length(qe);
+      if (distance <= fabs(min_distance)) {
+        min_distance = fc_msdf_sign(fc_msdf_cross(fc_msdf_add(ab, fc_msdf_mul(br, t[i])), qe)) * distance;
+        *param = t[i];
+      }
+    }
+  } else {
+    /* cubic curves are searched with a few Newton iterations from evenly spread starts */
+    struct fc_msdf_point br = fc_msdf_sub(fc_msdf_sub(e->p[2], e->p[1]), ab);
+    struct fc_msdf_point as = fc_msdf_sub(fc_msdf_sub(fc_msdf_sub(e->p[3], e->p[2]), fc_msdf_sub(e->p[2], e->p[1])), br);
+    for (i = 0; i <= FC_MSDF_CUBIC_STARTS; i++) {
+      double t = (double) i / FC_MSDF_CUBIC_STARTS;
+      int step;
+      struct fc_msdf_point qe = fc_msdf_add(
+          fc_msdf_add(qa, fc_msdf_mul(ab, 3 * t)),
+          fc_msdf_add(fc_msdf_mul(br, 3 * t * t), fc_msdf_mul(as, t * t * t))
+      );
+      for (step = 0; step < FC_MSDF_CUBIC_STEPS; step++) {
+        struct fc_msdf_point d1 = fc_msdf_add(
+            fc_msdf_add(fc_msdf_mul(ab, 3), fc_msdf_mul(br, 6 * t)),
+            fc_msdf_mul(as, 3 * t * t)
+        );
+        struct fc_msdf_point d2 = fc_msdf_add(fc_msdf_mul(br, 6), fc_msdf_mul(as, 6 * t));
+        double denominator = fc_msdf_dot(d1, d1) + fc_msdf_dot(qe, d2);
+        if (denominator == 0) break;
+        t -= fc_msdf_dot(qe, d1) / denominator;
+        if (t <= 0 || t >= 1) break;
+        qe = fc_msdf_add(
+            fc_msdf_add(qa, fc_msdf_mul(ab, 3 * t)),
+            fc_msdf_add(fc_msdf_mul(br, 3 * t * t), fc_msdf_mul(as, t * t * t))
+        );
+        distance = fc_msdf_length(qe);
+        if (distance < fabs(min_distance)) {
+          min_distance = fc_msdf_sign(fc_msdf_cross(d1, qe)) * distance;
+          *param = t;
+        }
+      }
+    }
+  }
+
+  result.distance = min_distance;
+  if (*param >= 0 && *param <= 1) {
+    result.dot = 0;
+  } else if (*param < 0.5) {
+    result.dot = fabs(fc_msdf_dot(fc_msdf_normalize(fc_msdf_edge_direction(e, 0)), fc_msdf_normalize(qa)));
+  } else {
+    result.dot = fabs(fc_msdf_dot(fc_msdf_normalize(fc_msdf_edge_direction(e, 1)), fc_msdf_normalize(end)));
+  }
+  return result;
+}
+
+/* past the ends of an edge, measures the distance to the lines extending it instead, so that the
+ * channels of two edges meeting at a corner cross exactly at the corner */
+static double fc_msdf_pseudo_distance(
+    struct fc_msdf_edge const * e,
+    struct fc_msdf_distance distance,
+    struct fc_msdf_point origin,
+    double param
+) {
+  struct fc_msdf_point direction, aq;
+  double pseudo;
+  if (param < 0) {
+    direction = fc_msdf_normalize(fc_msdf_edge_direction(e, 0));
+    aq = fc_msdf_sub(origin, e->p[0]);
+    if (fc_msdf_dot(aq, direction) < 0) {
+      pseudo = fc_msdf_cross(aq, direction);
+      if (fabs(pseudo) <= fabs(distance.distance)) return pseudo;
+    }
+  } else if (param > 1) {
+    direction = fc_msdf_normalize(fc_msdf_edge_direction(e, 1));
+    aq = fc_msdf_sub(origin, e->p[e->degree]);
+    if (fc_msdf_dot(aq, direction) > 0) {
+      pseudo = fc_msdf_cross(aq, direction);
+      if (fabs(pseudo) <= fabs(distance.distance)) return pseudo;
+    }
+  }
+  return distance.distance;
+}
+
+static struct fc_msdf_edge * fc_msdf_push(struct fc_msdf_shape * shape, int degree) {
+  struct fc_msdf_edge * edge;
+  if (shape->count >= shape->capacity) {
+    size_t capacity = shape->capacity ? shape->capacity * 2 : 32;
+    struct fc_msdf_edge * edges = realloc(shape->edges, sizeof(*edges) * capacity);
+    if (edges == NULL) return NULL;
+    shape->edges = edges;
+    shape->capacity = capacity;
+  }
+  edge = &shape->edges[shape->count++];
+  edge->degree = degree;
+  edge->color = FC_MSDF_WHITE;
+  return edge;
+}
+
+/* the next color of a cycle through cyan, magenta and yellow, avoiding `banned` when possible */
+static int fc_msdf_switch_color(int color, int banned) {
+  int combined = color & banned, shifted;
+  if (combined == FC_MSDF_RED || combined == FC_MSDF_GREEN || combined == FC_MSDF_BLUE) return combined ^ FC_MSDF_WHITE;
+  if (color == 0 || color == FC_MSDF_WHITE) return FC_MSDF_CYAN;
+  shifted = color << 1;
+  return (shifted | shifted >> 3) & FC_MSDF_WHITE;
+}
+
+static int fc_msdf_is_corner(struct fc_msdf_point a, struct fc_msdf_point b) {
+  a = fc_msdf_normalize(a);
+  b = fc_msdf_normalize(b);
+  return fc_msdf_dot(a, b) <= 0 || fabs(fc_msdf_cross(a, b)) > FC_MSDF_CORNER_CROSS;
+}
+
+/* colors the edges of the contour at the end of the shape, starting at `first`. Smooth contours are
+ * white, a contour with a single corner is split in three colors, and edges between corners
+ * take turns with the three two-channel colors */
+static int fc_msdf_color_contour(struct fc_msdf_shape * shape, size_t first) {
+  size_t i, m = shape->count - first, corner_count = 0, start = 0, spline = 0;
+  struct fc_msdf_edge * edges = shape->edges + first;
+  struct fc_msdf_point previous;
+  int color, initial;
+
+  if (m == 0) return 1;
+  previous = fc_msdf_edge_direction(&edges[m - 1], 1);
+  for (i = 0; i < m; i++) {
+    if (fc_msdf_is_corner(previous, fc_msdf_edge_direction(&edges[i], 0))) {
+      if (corner_count == 0) start = i;
+      corner_count++;
+    }
+    previous = fc_msdf_edge_direction(&edges[i], 1);
+  }
+
+  if (corner_count == 0) {
+    for (i = 0; i < m; i++) edges[i].color = FC_MSDF_WHITE;
+    return 1;
+  }
+
+  if (corner_count == 1) {
+    int colors[3];
+    colors[0] = fc_msdf_switch_color(FC_MSDF_WHITE, 0);
+    colors[1] = FC_MSDF_WHITE;
+    colors[2] = fc_msdf_switch_color(colors[0], 0);
+    if (m >= 3) {
+      for (i = 0; i < m; i++) {
+        edges[(start + i) % m].color = colors[(int) (3 + 2.875 * (double) i / (double) (m - 1) - 1.4375 + 0.5) - 2];
+      }
+    } else {
+      /* too few edges for three colors: each is split in thirds, starting at the corner */
+      struct fc_msdf_edge parts[6], original[2];
+      size_t part_count = m * 3;
+      original[0] = edges[0];
+      if (m == 2) original[1] = edges[1];
+      fc_msdf_split_thirds(&original[start], parts);
+      if (m == 2) fc_msdf_split_thirds(&original[1 - start], parts + 3);
+      for (i = 0; i < part_count; i++) parts[i].color = colors[i * 3 / part_count];
+      shape->count = first;
+      for (i = 0; i < part_count; i++) {
+        struct fc_msdf_edge * edge = fc_msdf_push(shape, parts[i].degree);
+        if (edge == NULL) return 0;
+        *edge = parts[i];
+      }
+    }
+    return 1;
+  }
+
+  /* several corners: the color changes at each of them, and the last spline also avoids the color
+   * of the first one, which it meets at the first corner */
+  color = initial = fc_msdf_switch_color(FC_MSDF_WHITE, 0);
+  previous = fc_msdf_edge_direction(&edges[(start + m - 1) % m], 1);
+  for (i = 0; i < m; i++) {
+    size_t index = (start + i) % m;
+    if (i > 0 && fc_msdf_is_corner(previous, fc_msdf_edge_direction(&edges[index], 0))) {
+      spline++;
+      color = fc_msdf_switch_color(color, spline == corner_count - 1 ? initial : 0);
+    }
+    edges[index].color = color;
+    previous = fc_msdf_edge_direction(&edges[index], 1);
+  }
+  return 1;
+}
+
+/* turns the glyph outline into colored edges, in pixels with y pointing up */
+static int fc_msdf_load_shape(
+    stbtt_fontinfo const * info,
+    int glyph,
+    float scale,
+    struct fc_msdf_shape * shape,
+    double * area
+) {
+  stbtt_vertex * vertices = NULL;
+  int i, vertex_count = stbtt_GetGlyphShape(info, glyph, &vertices);
+  size_t first = 0;
+  struct fc_msdf_point cursor = { 0, 0 }, start = { 0, 0 };
+  int result = 1;
+
+  *area = 0;
+  for (i = 0; i <= vertex_count && result; i++) {
+    stbtt_vertex const * v = i < vertex_count ? &vertices[i] : NULL;
+    struct fc_msdf_point to;
+    struct fc_msdf_edge * edge;
+
+    /* contours are closed and colored when the next one starts, or at the end of the outline */
+    if (v == NULL || v->type == STBTT_vmove) {
+      if (shape->count > first && (cursor.x != start.x || cursor.y != start.y)) {
+        edge = fc_msdf_push(shape, 1);
+        if (edge == NULL) {
+          result = 0;
+          break;
+        }
+        edge->p[0] = cursor;
+        edge->p[1] = start;
+      }
+      if (shape->count > first) result = fc_msdf_color_contour(shape, first);
+      first = shape->count;
+      if (v == NULL) break;
+      cursor = start = fc_msdf_point(v->x * scale, v->y * scale);
+      continue;
+    }
+
+    /* edges that collapse to a point have no direction and are left out */
+    to = fc_msdf_point(v->x * scale, v->y * scale);
+    if (to.x == cursor.x && to.y == cursor.y && (v->type == STBTT_vline || (v->cx == v->x && v->cy == v->y))) continue;
+    edge = fc_msdf_push(shape, v->type == STBTT_vline ? 1 : v->type == STBTT_vcurve ? 2 : 3);
+    if (edge == NULL) {
+      result = 0;
+      break;
+    }
+    edge->p[0] = cursor;
+    if (edge->degree == 1) {
+      edge->p[1] = to;
+    } else if (edge->degree == 2) {
+      edge->p[1] = fc_msdf_point(v->cx * scale, v->cy * scale);
+      edge->p[2] = to;
+    } else {
+      edge->p[1] = fc_msdf_point(v->cx * scale, v->cy * scale);
+      edge->p[2] = fc_msdf_point(v->cx1 * scale, v->cy1 * scale);
+      edge->p[3] = to;
+    }
+    cursor = to;
+  }
+  stbtt_FreeShape(info, vertices);
+
+  /* the area enclosed by the control polygons tells which way outer contours wind */
+  for (i = 0; i < (int) shape->count; i++) {
+    struct fc_msdf_edge * e = &shape->edges[i];
+    int k;
+    e->low = e->high = e->p[0];
+    for (k = 0; k < e->degree; k++) {
+      *area += fc_msdf_cross(e->p[k], e->p[k + 1]);
+      e->low.x = e->low.x < e->p[k + 1].x ? e->low.x : e->p[k + 1].x;
+      e->low.y = e->low.y < e->p[k + 1].y ? e->low.y : e->p[k + 1].y;
+      e->high.x = e->high.x > e->p[k + 1].x ? e->high.x : e->p[k + 1].x;
+      e->high.y = e->high.y > e->p[k + 1].y ? e->high.y : e->p[k + 1].y;
+    }
+  }
+  return result;
+}
+
+/* Out of a pair of neighbouring pixels, flags the one farther from the outline if the two
+ * channels that change the most between them change by more than a pixel: their median would
+ * then make an artifact */
+static int fc_msdf_clashes(float const * a, float const * b) {
+  float a0 = a[0], a1 = a[1], a2 = a[2], b0 = b[0], b1 = b[1], b2 = b[2], tmp;
+  if (fabsf(b0 - a0) < fabsf(b1 - a1)) {
+    tmp = a0; a0 = a1; a1 = tmp;
+    tmp = b0; b0 = b1; b1 = tmp;
+  }
+  if (fabsf(b1 - a1) < fabsf(b2 - a2)) {
+    tmp = a1; a1 = a2; a2 = tmp;
+    tmp = b1; b1 = b2; b2 = tmp;
+    if (fabsf(b0 - a0) < fabsf(b1 - a1)) {
+      tmp = a0; a0 = a1; a1 = tmp;
+      tmp = b0; b0 = b1; b1 = tmp;
+    }
+  }
+  return fabsf(b1 - a1) >= FC_MSDF_CLASH_THRESHOLD && !(b0 == b1 && b0 == b2) && fabsf(a2) >= fabsf(b2);
+}
+
+static float fc_msdf_median(float a, float b, float c) {
+  float low = a < b ? a : b, high = a < b ? b : a;
+  return c < low ? low : c > high ? high : c;
+}
+
+static unsigned char fc_msdf_encode(float distance, struct fc_sdf const * sdf) {
+  float value = (float) sdf->on_edge_value + distance * (float) sdf->on_edge_value / (float) sdf->padding;
+  if (value <= 0) return 0;
+  if (value >= 255) return 255;
+  return (unsigned char) (value + 0.5f);
+}
+
+int fc_msdf_render(
+    stbtt_fontinfo const * info,
+    int glyph,
+    float scale,
+    struct fc_sdf const * sdf,
+    unsigned char * pixels,
+    size_t stride,
+    int left,
+    int top,
+    int width,
+    int height
+) {
+  struct fc_msdf_shape shape = { NULL, 0, 0 };
+  size_t x, y, i, count = (size_t) width * (size_t) height;
+  float * field;
+  uint8_t * clashes;
+  double area, orientation;
+  int c;
+
+  if (count == 0) return 1;
+  field = malloc(sizeof(*field) * 4 * count);
+  clashes = malloc(count);
+  if (field == NULL || clashes == NULL || !fc_msdf_load_shape(info, glyph, scale, &shape, &area)) {
+    free(field);
+    free(clashes);
+    free(shape.edges);
+    return 0;
+  }
+
+  /* distances come out positive inside clockwise contours, as TrueType outer contours are */
+  orientation = area > 0 ? -1 : 1;
+
+  for (y = 0; y < (size_t) height; y++) {
+    for (x = 0; x < (size_t) width; x++) {
+      struct fc_msdf_point origin = fc_msdf_point(left + (double) x + 0.5, -(top + (double) y + 0.5));
+      struct fc_msdf_distance best[4];
+      struct fc_msdf_edge const * nearest[3] = { NULL, NULL, NULL };
+      double params[3] = { 0, 0, 0 };
+      float * out = field + (y * (size_t) width + x) * 4;
+
+      for (c = 0; c < 4; c++) {
+        best[c].distance = -1e240;
+        best[c].dot = 1;
+      }
+      for (i = 0; i < shape.count; i++) {
+        struct fc_msdf_edge const * e = &shape.edges[i];
+        double param, dx, dy, farthest = 0;
+        struct fc_msdf_distance distance;
+
+        /* edges whose box is farther than what every channel they color has found cannot win. Some
+         * slack keeps edges sharing a corner with the nearest one, which tie with it */
+        dx = e->low.x > origin.x ? e->low.x - origin.x : origin.x > e->high.x ? origin.x - e->high.x : 0;
+        dy = e->low.y > origin.y ? e->low.y - origin.y : origin.y > e->high.y ? origin.y - e->high.y : 0;
+        for (c = 0; c < 3; c++) {
+          if ((e->color & (1 << c)) && fabs(best[c].distance) > farthest) farthest = fabs(best[c].distance);
+        }
+        if (dx * dx + dy * dy > farthest * farthest * 1.0001 + 1e-9) continue;
+
+        distance = fc_msdf_edge_distance(e, origin, &param);
+        if (fc_msdf_closer(distance, best[3])) best[3] = distance;
+        for (c = 0; c < 3; c++) {
+          if (!(e->color & (1 << c)) || !fc_msdf_closer(distance, best[c])) continue;
+          best[c] = distance;
+          nearest[c] = e;
+          params[c] = param;
+        }
+      }
+      for (c = 0; c < 3; c++) {
+        double distance = nearest[c] ? fc_msdf_pseudo_distance(nearest[c], best[c], origin, params[c]) : best[c].distance;
+        out[c] = (float) (distance * orientation);
+      }
+      out[3] = (float) (best[3].distance * orientation);
+    }
+  }
+
+  /* pixels whose channels clash with a neighbour fall back to their median */
+  for (y = 0; y < (size_t) height; y++) {
+    for (x = 0; x < (size_t) width; x++) {
+      float const * p = field + (y * (size_t) width + x) * 4;
+      clashes[y * (size_t) width + x] = (uint8_t) (
+          (x > 0 && fc_msdf_clashes(p, p - 4)) ||
+          (x + 1 < (size_t) width && fc_msdf_clashes(p, p + 4)) ||
+          (y > 0 && fc_msdf_clashes(p, p - 4 * (size_t) width)) ||
+          (y + 1 < (size_t) height && fc_msdf_clashes(p, p + 4 * (size_t) width))
+      );
+    }
+  }
+  for (i = 0; i < count; i++) {
+    float * p = field + i * 4;
+    if (clashes[i]) p[0] = p[1] = p[2] = fc_msdf_median(p[0], p[1], p[2]);
+  }
+
+  for (y = 0; y < (size_t) height; y++) {
+    unsigned char * row = pixels + y * stride;
+    for (x = 0; x < (size_t) width; x++) {
+      float const * p = field + (y * (size_t) width + x) * 4;
+      for (c = 0; c < 4; c++) row[x * 4 + (size_t) c] = fc_msdf_encode(p[c], sdf);
+    }
+  }
+
+  free(field);
+  free(clashes);
+  free(shape.edges);
+  return 1;
+}
@@ -0,0 +1,221 @@
+#include "font-internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* state shared by all rasterization tasks. Each task renders a disjoint, consecutive
+ * slice of the packed rects */
+struct fc_pack_work {
+  stbtt_pack_context const * context;
+  stbtt_fontinfo const * info;
+  stbtt_pack_range const * ranges;
+  size_t range_count;
+  size_t * range_starts;
+  stbrp_rect * rects;
+  size_t rect_count;
+  size_t task_size;
+  struct fc_sdf const * sdf;
+  uint8_t * results;
+};
+
+/* the scale stbtt packs a range with */
+static float fc_pack_scale(stbtt_fontinfo const * info, float font_size) {
+  return font_size > 0 ? stbtt_ScaleForPixelHeight(info, font_size) : stbtt_ScaleForMappingEmToPixels(info, -font_size);
+}
+
+static int fc_pack_codepoint(stbtt_pack_range const * range, size_t index) {
+  if (range->array_of_unicode_codepoints != NULL) return range->array_of_unicode_codepoints[index];
+  return range->first_unicode_codepoint_in_range + (int) index;
+}
+
+void fc_pack_gather(
+    stbtt_pack_context const * context,
+    stbtt_fontinfo const * info,
+    stbtt_pack_range * ranges,
+    size_t range_count,
+    stbrp_rect * rects,
+    struct fc_sdf const * sdf
+) {
+  size_t i, j, k = 0;
+
+  if (sdf->padding == 0) {
+    stbtt_PackFontRangesGatherRects((stbtt_pack_context *) context, info, ranges, (int) range_count, rects);
+    return;
+  }
+
+  /* distance fields are never oversampled and reach `padding` pixels out of the glyph box on
+   * every side, just like stbtt_GetGlyphSDF lays them out. Empty glyphs get no field at all */
+  for (i = 0; i < range_count; i++) {
+    float scale = fc_pack_scale(info, ranges[i].font_size);
+    ranges[i].h_oversample = ranges[i].v_oversample = 1;
+    for (j = 0; j < (size_t) ranges[i].num_chars; j++, k++) {
+      int x0, y0, x1, y1, glyph = stbtt_FindGlyphIndex(info, fc_pack_codepoint(&ranges[i], j));
+      stbtt_GetGlyphBitmapBoxSubpixel(info, glyph, scale, scale, 0, 0, &x0, &y0, &x1, &y1);
+      if (x0 == x1 || y0 == y1) {
+        rects[k].w = rects[k].h = (stbrp_coord) context->padding;
+        continue;
+      }
+      rects[k].w = (stbrp_coord) (x1 - x0 + 2 * sdf->padding + context->padding);
+      rects[k].h = (stbrp_coord) (y1 - y0 + 2 * sdf->padding + context->padding);
+    }
+  }
+}
+
+/* same as stbtt_PackFontRangesRenderIntoRects, rendering signed distance fields instead of
+ * coverage. Values drop by on_edge_value / padding for every pixel away from the outline, so
+ * they reach zero right at the edge of the field */
+static int fc_pack_render_sdf(
+    stbtt_pack_context const * context,
+    stbtt_fontinfo const * info,
+    stbtt_pack_range const * range,
+    stbrp_rect * rects,
+    struct fc_sdf const * sdf
+) {
+  float scale = fc_pack_scale(info, range->font_size);
+  float distance_scale = (float) sdf->on_edge_value / (float) sdf->padding;
+  size_t stride = (size_t) context->stride_in_bytes;
+  int i, row, result = 1;
+
+  for (i = 0; i < range->num_chars; i++) {
+    stbrp_rect * r = &rects[i];
+    stbtt_packedchar * c = &range->chardata_for_range[i];
+    int glyph, advance, lsb, width = 0, height = 0, xoff = 0, yoff = 0, copied;
+
+    if (!r->was_packed || r->w == 0 || r->h == 0) {
+      result = 0;
+      continue;
+    }
+
+    /* pad on left and top */
+    r->x = (stbrp_coord) (r->x + context->padding);
+    r->y = (stbrp_coord) (r->y + context->padding);
+    r->w = (stbrp_coord) (r->w - context->padding);
+    r->h = (stbrp_coord) (r->h - context->padding);
+
+    glyph = stbtt_FindGlyphIndex(info, fc_pack_codepoint(range, (size_t) i));
+    stbtt_GetGlyphHMetrics(info, glyph, &advance, &lsb);
+
+    if (sdf->channels == 3) {
+      /* multi-channel fields are laid out like stbtt_GetGlyphSDF lays out single channel ones */
+      int x0, y0, x1, y1;
+      stbtt_GetGlyphBitmapBoxSubpixel(info, glyph, scale, scale, 0, 0, &x0, &y0, &x1, &y1);
+      if (x0 != x1 && y0 != y1) {
+        xoff = x0 - sdf->padding;
+        yoff = y0 - sdf->padding;
+        width = x1 - x0 + 2 * sdf->padding;
+        height = y1 - y0 + 2 * sdf->padding;
+      }
+      copied = width < r->w ? width : r->w;
+      if (height > r->h) height = r->h;
+      if (!fc_msdf_render(
+          info, glyph, scale, sdf,
+          context->pixels + (size_t) r->y * stride + (size_t) r->x * 4, stride,
+          xoff, yoff, copied, height
+      )) {
+        result = 0;
+      }
+    } else {
+      unsigned char * field = stbtt_GetGlyphSDF(
+          info, scale, glyph,
+          sdf->padding, sdf->on_edge_value, distance_scale,
+          &width, &height, &xoff, &yoff
+      );
+
+      /* the field has the size the rect was gathered with, this only keeps it in the rect */
+      copied = width < r->w ? width : r->w;
+      if (height > r->h) height = r->h;
+      for (row = 0; field != NULL && row < height; row++) {
+        memcpy(
+            context->pixels + (size_t) (r->y + row) * stride + r->x,
+            field + (size_t) row * (size_t) width,
+            (size_t) copied
+        );
+      }
+      stbtt_FreeSDF(field, info->userdata);
+    }
+
+    c->x0 = (unsigned short) r->x;
+    c->y0 = (unsigned short) r->y;
+    c->x1 = (unsigned short) (r->x + copied);
+    c->y1 = (unsigned short) (r->y + height);
+    c->xadvance = scale * (float) advance;
+    c->xoff = (float) xoff;
+    c->yoff = (float) yoff;
+    c->xoff2 = (float) (xoff + copied);
+    c->yoff2 = (float) (yoff + height);
+  }
+  return result;
+}
+
+/* renders rects [index * task_size, (index + 1) * task_size) by handing stbtt the parts of the
+ * ranges that correspond to them. The context is copied because stbtt
+ * changes its oversampling fields while rendering */
+static void fc_pack_render_task(void * data, size_t index) {
+  struct fc_pack_work * work = data;
+  stbtt_pack_context context = *work->context;
+  size_t first = index * work->task_size;
+  size_t last = first + work->task_size < work->rect_count ? first + work->task_size : work->rect_count;
+  size_t range = 0;
+
+  while (work->range_starts[range + 1] <= first) range++;
+  for (; first < last; range++) {
+    size_t offset = first - work->range_starts[range];
+    size_t end = work->range_starts[range + 1] < last ? work->range_starts[range + 1] : last;
+    stbtt_pack_range slice = work->ranges[range];
+    if (end <= first) continue;
+    if (slice.array_of_unicode_codepoints != NULL) slice.array_of_unicode_codepoints += offset;
+    else slice.first_unicode_codepoint_in_range += (int) offset;
+    slice.num_chars = (int) (end - first);
+    slice.chardata_for_range += offset;
+    if (work->sdf->padding > 0) {
+      if (!fc_pack_render_sdf(&context, work->info, &slice, work->rects + first, work->sdf)) work->results[index] = 0;
+    } else if (!stbtt_PackFontRangesRenderIntoRects(&context, work->info, &slice, 1, work->rects + first)) {
+      work->results[index] = 0;
+    }
+    first = end;
+  }
+}
+
+int fc_pack_render(
+    stbtt_pack_context const * context,
+    stbtt_fontinfo const * info,
+    stbtt_pack_range const * ranges,
+    size_t range_count,
+    stbrp_rect * rects,
+    struct fc_sdf const * sdf,
+    struct fc_executor const * executor,
+    size_t thread_count
+) {
+  struct fc_pack_work work;
+  size_t i, task_count;
+  int result = 1;
+
+  work.context = context;
+  work.info = info;
+  work.ranges = ranges;
+  work.range_count = range_count;
+  work.rects = rects;
+  work.sdf = sdf;
+  work.range_starts = malloc(sizeof(*work.range_starts) * (range_count + 1));
+  if (work.range_starts == NULL) return 0;
+
+  work.range_starts[0] = 0;
+  for (i = 0; i < range_count; i++) {
+    work.range_starts[i + 1] = work.range_starts[i] + (size_t) ranges[i].num_chars;
+  }
+  work.rect_count = work.range_starts[range_count];
+  work.task_size = sdf->padding > 0 && sdf->channels == 3 ? FC_PACK_MSDF_TASK_SIZE : FC_PACK_TASK_SIZE;
+  task_count = (work.rect_count + work.task_size - 1) / work.task_size;
+
+  work.results = malloc(task_count ? task_count : 1);
+  if (work.results == NULL) {
+    result = 0;
+  } else {
+    memset(work.results, 1, task_count);
+    fc_run_tasks(executor, thread_count, fc_pack_render_task, &work, task_count);
+    for (i = 0; i < task_count; i++) result &= work.results[i];
+  }
+
+  free(work.range_starts);
+  free(work.results);
+  return result;
+}
@@ -0,0 +1,264 @@
+#include "font-internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+int fc_pages_construct(struct fc_pages * pages) {
+  pages->items = calloc(1, sizeof(*pages->items));
+  pages->count = 0;
+  pages->capacity = 1;
+  pages->max_size = 0;
+  pages->format = fc_pixel_format_rgba;
+  pages->multi_channel = 0;
+  return pages->items != NULL;
+}
+
+enum fc_pixel_format fc_pages_format(struct fc_pages const * pages) {
+  return pages->multi_channel ? fc_pixel_format_rgba : pages->format;
+}
+
+size_t fc_pages_render_bpp(struct fc_pages const * pages) {
+  return pages->multi_channel ? 4 : 1;
+}
+
+void fc_pages_clear(struct fc_pages * pages) {
+  size_t i;
+  for (i = 0; i < pages->count; i++) {
+    free(pages->items[i].pixels.data);
+    free(pages->items[i].dirty);
+  }
+  memset(pages->items, 0, sizeof(*pages->items) * pages->capacity);
+  pages->items[0].pixels.format = fc_pages_format(pages);
+  pages->count = 0;
+}
+
+void fc_pages_destruct(struct fc_pages * pages) {
+  fc_pages_clear(pages);
+  free(pages->items);
+  pages->items = NULL;
+  pages->capacity = 0;
+}
+
+static struct fc_page * fc_pages_push(struct fc_pages * pages, size_t width, size_t height) {
+  struct fc_page * page;
+  if (pages->count >= pages->capacity) {
+    size_t capacity = pages->capacity * 2;
+    struct fc_page * items = realloc(pages->items, sizeof(*items) * capacity);
+    if (items == NULL) return NULL;
+    pages->items = items;
+    pages->capacity = capacity;
+  }
+
+  page = &pages->items[pages->count];
+  memset(page, 0, sizeof(*page));
+  page->pixels.format = fc_pages_format(pages);
+  page->pixels.dimensions.width = (float) width;
+  page->pixels.dimensions.height = (float) height;
+  return page;
+}
+
+unsigned char * fc_pages_add(struct fc_pages * pages, size_t width, size_t height) {
+  struct fc_page * page = fc_pages_push(pages, width, height);
+  size_t pixel_count = width * height;
+  if (page == NULL) return NULL;
+
+  /* stbtt packs 1 byte-per-pixel coverage. In alpha mode that is the final bitmap; in RGBA mode
+   * it is packed into the last quarter of the RGBA buffer and expanded in place, so we never
+   * hold both buffers at the same time. Multi-channel fields are rendered as they are */
+  if (pages->multi_channel) {
+    page->pixels.data = calloc(pixel_count ? pixel_count * 4 : 1, 1);
+    if (page->pixels.data == NULL) return NULL;
+    pages->count += 1;
+    return page->pixels.data;
+  }
+  if (pages->format == fc_pixel_format_alpha) {
+    page->pixels.data = calloc(pixel_count ? pixel_count : 1, 1);
+    if (page->pixels.data == NULL) return NULL;
+    pages->count += 1;
+    return page->pixels.data;
+  }
+
+  page->pixels.data = malloc(pixel_count ? pixel_count * 4 : 1);
+  if (page->pixels.data == NULL) return NULL;
+  memset(page->pixels.data + pixel_count * 3, 0, pixel_count);
+  pages->count += 1;
+  return page->pixels.data + pixel_count * 3;
+}
+
+int fc_pages_add_pixels(struct fc_pages * pages, size_t width, size_t height, unsigned char * data) {
+  struct fc_page * page = fc_pages_push(pages, width, height);
+  if (page == NULL) return 0;
+  page->pixels.data = data;
+  pages->count += 1;
+  return 1;
+}
+
+void fc_pages_finish(struct fc_pages * pages, size_t index, unsigned char * coverage, struct fc_color color) {
+  struct fc_pixels * pixels = &pages->items[index].pixels;
+  if (pixels->format == fc_pixel_format_alpha || pages->multi_channel) return;
+  fc_colorify(coverage, pixels->data, pixels->dimensions, color);
+}
+
+int fc_pages_mark_dirty(struct fc_pages * pages, size_t index, struct fc_rect rect) {
+  struct fc_page * page = &pages->items[index];
+  if (page->dirty_count >= page->dirty_capacity) {
+    size_t capacity = page->dirty_capacity ? page->dirty_capacity * 2 : 8;
+    struct fc_rect * dirty = realloc(page->dirty, sizeof(*dirty) * capacity);
+    if (dirty == NULL) return 0;
+    page->dirty = dirty;
+    page->dirty_capacity = capacity;
+  }
+  page->dirty[page->dirty_count++] = rect;
+  return 1;
+}
+
+/* renders the rects packed into one page, each font its own slice of them with its settings:
+ * stbtt skips rects that were not packed, so the ones from other pages are flagged as such in
+ * a copy */
+static int fc_pack_page(
+    struct fc_font * const * fonts,
+    size_t font_count,
+    stbtt_pack_context const * context,
+    stbrp_rect const * rects,
+    uint32_t const * rect_pages,
+    size_t count,
+    uint32_t page
+) {
+  size_t i, f, first = 0;
+  stbrp_rect * page_rects = malloc(sizeof(*page_rects) * (count ? count : 1));
+  if (page_rects == NULL) return 0;
+  for (i = 0; i < count; i++) {
+    page_rects[i] = rects[i];
+    page_rects[i].was_packed = rects[i].was_packed && rect_pages[i] == page;
+  }
+  for (f = 0; f < font_count; first += fonts[f]->packing.char_count, f++) {
+    struct fc_font * font = fonts[f];
+    fc_pack_render(
+        context,
+        font->metadata.info,
+        font->packing.blocks,
+        font->packing.count,
+        page_rects + first,
+        &font->sdf,
+        &font->settings.executor,
+        font->settings.thread_count
+    );
+  }
+  free(page_rects);
+  return 1;
+}
+
+/* pages are colored with the color of the first font, the glyphs of fonts with other colors
+ * are painted over */
+static void fc_pack_recolor(
+    struct fc_pages * pages,
+    struct fc_font * const * fonts,
+    size_t font_count,
+    stbrp_rect const * rects,
+    uint32_t const * rect_pages,
+    uint32_t page
+) {
+  struct fc_pixels * pixels = &pages->items[page].pixels;
+  struct fc_color base = fonts[0]->metadata.color;
+  size_t f, i, first = fonts[0]->packing.char_count, width = (size_t) pixels->dimensions.width;
+  int x, y;
+
+  if (pixels->format == fc_pixel_format_alpha || pages->multi_channel) return;
+  for (f = 1; f < font_count; first += fonts[f]->packing.char_count, f++) {
+    struct fc_color color = fonts[f]->metadata.color;
+    if (color.r == base.r && color.g == base.g && color.b == base.b) continue;
+    for (i = first; i < first + fonts[f]->packing.char_count; i++) {
+      stbrp_rect const * r = &rects[i];
+      if (!r->was_packed || rect_pages[i] != page) continue;
+      for (y = r->y; y < r->y + r->h; y++) {
+        unsigned char * row = pixels->data + ((size_t) y * width + (size_t) r->x) * 4;
+        for (x = 0; x < r->w; x++, row += 4) {
+          row[0] = color.r;
+          row[1] = color.g;
+          row[2] = color.b;
+        }
+      }
+    }
+  }
+}
+
+int fc_pack_pages(
+    struct fc_pages * pages,
+    struct fc_font * const * fonts,
+    size_t font_count,
+    stbtt_pack_context * context,
+    stbrp_rect * rects,
+    uint8_t keep_last
+) {
+  size_t i, f, first, count = 0, pending_count, packed;
+  int result = 1, width = context->width, height = context->height;
+  unsigned int h_oversample = context->h_oversample, v_oversample = context->v_oversample;
+  uint32_t page;
+  stbrp_rect * pending;
+  uint32_t * rect_pages;
+
+  for (f = 0; f < font_count; f++) count += fonts[f]->packing.char_count;
+  pending = malloc(sizeof(*pending) * (count ? count : 1));
+  rect_pages = malloc(sizeof(*rect_pages) * (count ? count : 1));
+  if (pending == NULL || rect_pages == NULL) {
+    free(pending);
+    free(rect_pages);
+    return 0;
+  }
+
+  /* glyphs that do not fit even on an empty page are left out from the start, so that every page
+   * after the first one gets at least one glyph and the last page is the one the packer ends on */
+  for (i = 0, pending_count = 0; i < count; i++) {
+    rects[i].was_packed = 0;
+    rect_pages[i] = 0;
+    if (rects[i].w > width - context->padding || rects[i].h > height - context->padding) continue;
+    pending[pending_count] = rects[i];
+    pending[pending_count++].id = (int) i;
+  }
+
+  for (page = 0; ; page++) {
+    unsigned char * coverage;
+    int used = 1;
+
+    /* everything that did not fit in the previous pages goes to this one */
+    stbtt_PackFontRangesPackRects(context, pending, (int) pending_count);
+    for (i = 0, packed = 0; i < pending_count; i++) {
+      stbrp_rect const * r = &pending[i];
+      if (!r->was_packed) {
+        pending[i - packed] = *r;
+        continue;
+      }
+      rects[r->id] = *r;
+      rect_pages[r->id] = page;
+      if (r->y + r->h > used) used = r->y + r->h;
+      packed++;
+    }
+    pending_count -= packed;
+
+    /* a page after the first one only stays if it got glyphs */
+    if (packed == 0 && page > 0) break;
+
+    /* pages that are not getting any more glyphs only need the rows they use */
+    if (!keep_last || pending_count > 0) context->height = used;
+    coverage = fc_pages_add(pages, (size_t) context->width, (size_t) context->height);
+    context->pixels = coverage;
+    context->stride_in_bytes = context->width * (int) fc_pages_render_bpp(pages);
+    if (coverage == NULL || !fc_pack_page(fonts, font_count, context, rects, rect_pages, count, page)) {
+      result = 0;
+      break;
+    }
+    fc_pages_finish(pages, page, coverage, fonts[0]->metadata.color);
+    fc_pack_recolor(pages, fonts, font_count, rects, rect_pages, page);
+
+    if (pending_count == 0 || packed == 0) break;
+    stbtt_PackEnd(context);
+    stbtt_PackBegin(context, NULL, width, height, 0, context->padding, NULL);
+    stbtt_PackSetOversampling(context, h_oversample, v_oversample);
+  }
+
+  for (f = 0, first = 0; f < font_count; first += fonts[f]->packing.char_count, f++) {
+    memcpy(fonts[f]->packing.pages, rect_pages + first, sizeof(*rect_pages) * fonts[f]->packing.char_count);
+  }
+  free(rect_pages);
+  free(pending);
+  return result;
+}
@@ -1,6 +1,126 @@
-#include "font-chef/character-mapping.h"
-#include "stb_truetype.h"
+#include "font-internal.h"
+#include "simd.h"
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+
+static void fc_bounds_merge(struct fc_rect * r, struct fc_rect const * dst) {
+  if (dst->top < r->top) r->top = dst->top;
+  if (dst->bottom > r->bottom) r->bottom = dst->bottom;
+  if (dst->left < r->left) r->left = dst->left;
+  if (dst->right > r->right) r->right = dst->right;
+}
+
+static struct fc_rect fc_text_bounds_scalar(struct fc_character_mapping const mapping[], size_t length, struct fc_rect r) {
+  for (size_t i = 0; i < length; i++) fc_bounds_merge(&r, &mapping[i].target);
+  return r;
+}
+
+/* Vector kernels load whole target rects (left, top, right and bottom) at once. Minimums and
+ * maximums are taken as `new < old ? new : old` and `new > old ? new : old`, which is what the
+ * scalar loop does, NaNs included */
+
+/* Vector kernels keep four pairs of minimums and maximums, each going through every fourth
+ * glyph, so that they do not wait on one another. The lanes are merged in the end */
+#define FC_BOUNDS_CHAINS 4
+
+static int fc_bounds_merge_chains(struct fc_rect * r, float chains[FC_BOUNDS_CHAINS][8]) {
+  float left[FC_BOUNDS_CHAINS], top[FC_BOUNDS_CHAINS], right[FC_BOUNDS_CHAINS], bottom[FC_BOUNDS_CHAINS];
+  for (size_t k = 0; k < FC_BOUNDS_CHAINS; k++) {
+    left[k] = chains[k][0];
+    top[k] = chains[k][1];
+    right[k] = chains[k][6];
+    bottom[k] = chains[k][7];
+  }
+  return fc_bounds_merge_lanes(r, left, top, right, bottom, FC_BOUNDS_CHAINS);
+}
+
+#if defined(FC_SIMD_SSE2)
+static struct fc_rect fc_text_bounds_sse2(struct fc_character_mapping const mapping[], size_t length, struct fc_rect r) {
+  struct fc_rect const start = r;
+  size_t i = 0, k;
+
+  if (length >= FC_BOUNDS_CHAINS) {
+    __m128 low[FC_BOUNDS_CHAINS], high[FC_BOUNDS_CHAINS];
+    float chains[FC_BOUNDS_CHAINS][8];
+    for (k = 0; k < FC_BOUNDS_CHAINS; k++) low[k] = high[k] = _mm_loadu_ps(&r.left);
+    for (; i + FC_BOUNDS_CHAINS <= length; i += FC_BOUNDS_CHAINS) {
+      for (k = 0; k < FC_BOUNDS_CHAINS; k++) {
+        __m128 target = _mm_loadu_ps(&mapping[i + k].target.left);
+        low[k] = _mm_min_ps(target, low[k]);
+        high[k] = _mm_max_ps(target, high[k]);
+      }
+    }
+    for (k = 0; k < FC_BOUNDS_CHAINS; k++) {
+      _mm_storeu_ps(chains[k], low[k]);
+      _mm_storeu_ps(chains[k] + 4, high[k]);
+    }
+    if (!fc_bounds_merge_chains(&r, chains)) return fc_text_bounds_scalar(mapping, length, start);
+  }
+  return fc_text_bounds_scalar(mapping + i, length - i, r);
+}
+#endif
+
+#if defined(FC_SIMD_AVX2_DISPATCH)
+FC_TARGET_AVX2
+static struct fc_rect fc_text_bounds_avx2(struct fc_character_mapping const mapping[], size_t length, struct fc_rect r) {
+  struct fc_rect const start = r;
+  size_t i = 0, k;
+
+  /* the low half of each vector goes through one chain, the high half through the next one */
+  if (length >= FC_BOUNDS_CHAINS) {
+    __m128 first = _mm_loadu_ps(&r.left);
+    __m256 low[FC_BOUNDS_CHAINS / 2], high[FC_BOUNDS_CHAINS / 2];
+    float chains[FC_BOUNDS_CHAINS][8];
+    for (k = 0; k < FC_BOUNDS_CHAINS / 2; k++) {
+      low[k] = high[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(first), first, 1);
+    }
+    for (; i + FC_BOUNDS_CHAINS <= length; i += FC_BOUNDS_CHAINS) {
+      for (k = 0; k < FC_BOUNDS_CHAINS / 2; k++) {
+        __m128 even = _mm_loadu_ps(&mapping[i + k * 2].target.left);
+        __m128 odd = _mm_loadu_ps(&mapping[i + k * 2 + 1].target.left);
+        __m256 targets = _mm256_insertf128_ps(_mm256_castps128_ps256(even), odd, 1);
+        low[k] = _mm256_min_ps(targets, low[k]);
+        high[k] = _mm256_max_ps(targets, high[k]);
+      }
+    }
+    for (k = 0; k < FC_BOUNDS_CHAINS / 2; k++) {
+      _mm_storeu_ps(chains[k * 2], _mm256_castps256_ps128(low[k]));
+      _mm_storeu_ps(chains[k * 2] + 4, _mm256_castps256_ps128(high[k]));
+      _mm_storeu_ps(chains[k * 2 + 1], _mm256_extractf128_ps(low[k], 1));
+      _mm_storeu_ps(chains[k * 2 + 1] + 4, _mm256_extractf128_ps(high[k], 1));
+    }
+    if (!fc_bounds_merge_chains(&r, chains)) return fc_text_bounds_scalar(mapping, length, start);
+  }
+  return fc_text_bounds_scalar(mapping + i, length - i, r);
+}
+#endif
+
+#if defined(FC_SIMD_NEON)
+static struct fc_rect fc_text_bounds_neon(struct fc_character_mapping const mapping[], size_t length, struct fc_rect r) {
+  struct fc_rect const start = r;
+  size_t i = 0, k;
+
+  if (length >= FC_BOUNDS_CHAINS) {
+    float32x4_t low[FC_BOUNDS_CHAINS], high[FC_BOUNDS_CHAINS];
+    float chains[FC_BOUNDS_CHAINS][8];
+    for (k = 0; k < FC_BOUNDS_CHAINS; k++) low[k] = high[k] = vld1q_f32(&r.left);
+    for (; i + FC_BOUNDS_CHAINS <= length; i += FC_BOUNDS_CHAINS) {
+      for (k = 0; k < FC_BOUNDS_CHAINS; k++) {
+        float32x4_t target = vld1q_f32(&mapping[i + k].target.left);
+        low[k] = vbslq_f32(vcltq_f32(target, low[k]), target, low[k]);
+        high[k] = vbslq_f32(vcgtq_f32(target, high[k]), target, high[k]);
+      }
+    }
+    for (k = 0; k < FC_BOUNDS_CHAINS; k++) {
+      vst1q_f32(chains[k], low[k]);
+      vst1q_f32(chains[k] + 4, high[k]);
+    }
+    if (!fc_bounds_merge_chains(&r, chains)) return fc_text_bounds_scalar(mapping, length, start);
+  }
+  return fc_text_bounds_scalar(mapping + i, length - i, r);
+}
+#endif
 
 struct fc_rect fc_text_bounds(struct fc_character_mapping const mapping[], size_t length) {
   struct fc_rect r = { .left = 0, .top = 0, .right = 0, .bottom = 0 };
@@ -9,31 +129,65 @@ struct fc_rect fc_text_bounds(struct fc_character_mapping const mapping[], size_
   r.top = mapping[0].target.top;
   r.bottom = mapping[0].target.bottom;
   r.right = mapping[length -1].target.right;
-  for (size_t i = 0; i < length; i++) {
-    struct fc_rect const * dst = &mapping[i].target;
-    if (dst->top < r.top) r.top = dst->top;
-    if (dst->bottom > r.bottom) r.bottom = dst->bottom;
-    if (dst->left < r.left) r.left = dst->left;
-    if (dst->right > r.right) r.right = dst->right;
-  }
 
-  return r;
+  switch (fc_get_simd_level()) {
+#if defined(FC_SIMD_AVX2_DISPATCH)
+    case fc_simd_avx2:
+      return fc_text_bounds_avx2(mapping, length, r);
+#endif
+#if defined(FC_SIMD_SSE2)
+    case fc_simd_sse2:
+      return fc_text_bounds_sse2(mapping, length, r);
+#endif
+#if defined(FC_SIMD_NEON)
+    case fc_simd_neon:
+      return fc_text_bounds_neon(mapping, length, r);
+#endif
+    default:
+      return fc_text_bounds_scalar(mapping, length, r);
+  }
 }
 
-struct fc_text_segment {
-  size_t first;
-  size_t last;
-};
-
 float fc_text_segment_width(struct fc_text_segment const * segment, struct fc_character_mapping const * mapping) {
   return mapping[segment->last].target.right - mapping[segment->first].target.left;
 }
 
+size_t fc_wrap_workspace_size(size_t glyph_count) {
+  /* words and lines, plus room to align them */
+  return sizeof(struct fc_text_segment) * (2 * (glyph_count ? glyph_count : 1) + 1);
+}
+
 uint32_t fc_wrap(struct fc_character_mapping mapping[], size_t glyph_count, float line_width, float line_height, float space_width, enum fc_alignment aligment) {
-  struct fc_text_segment * words = calloc(sizeof(*words), glyph_count);
-  struct fc_text_segment * lines = calloc(sizeof(*lines), glyph_count);
+  return fc_wrap_with_workspace(mapping, glyph_count, line_width, line_height, space_width, aligment, NULL, 0);
+}
+
+uint32_t fc_wrap_with_workspace(
+    struct fc_character_mapping mapping[],
+    size_t glyph_count,
+    float line_width,
+    float line_height,
+    float space_width,
+    enum fc_alignment aligment,
+    void * workspace,
+    size_t workspace_size
+) {
+  size_t segment_count = glyph_count ? glyph_count : 1;
+  void * allocated = NULL;
+  uintptr_t address;
+  struct fc_text_segment * words, * lines;
   size_t word_count = 0;
 
+  /* a workspace that is missing or too small is replaced by a temporary one */
+  if (workspace == NULL || workspace_size < fc_wrap_workspace_size(glyph_count)) {
+    allocated = workspace = malloc(fc_wrap_workspace_size(glyph_count));
+    if (workspace == NULL) return 0;
+  }
+  address = (uintptr_t) workspace;
+  address += (sizeof(*words) - address % sizeof(*words)) % sizeof(*words);
+  words = (struct fc_text_segment *) address;
+  lines = words + segment_count;
+  memset(words, 0, sizeof(*words) * segment_count * 2);
+
   for (size_t i = 0; i < glyph_count; i++) {
     struct fc_character_mapping * current_glyph = &mapping[i];
     struct fc_text_segment * current_word = &words[word_count];
@@ -57,7 +211,7 @@ uint32_t fc_wrap(struct fc_character_mapping mapping[], size_t glyph_count, floa
        * right by the space_width amount for every extra space,
        * because the line positioning algorithm below expects words to
        * be apart by a single space */
-      while (mapping[i+1].codepoint == 0x20) {
+      while (i + 1 < glyph_count && mapping[i+1].codepoint == 0x20) {
         i++;
         fc_move(mapping + current_word->first, current_word->last - current_word->first +1, space_width, 0);
       }
@@ -120,12 +274,11 @@ uint32_t fc_wrap(struct fc_character_mapping mapping[], size_t glyph_count, floa
     if (mapping[glyph_i].codepoint != 0x20) continue;
     mapping[glyph_i].target = mapping[first_non_space_index].target;
   }
-  free(words);
-  free(lines);
+  free(allocated);
   return line_count;
 }
 
-void fc_move(struct fc_character_mapping * mapping, size_t count, float left, float baseline) {
+static void fc_move_scalar(struct fc_character_mapping * mapping, size_t count, float left, float baseline) {
   for (size_t i = 0; i < count; i++) {
     mapping[i].target.top += baseline;
     mapping[i].target.bottom += baseline;
@@ -133,3 +286,131 @@ void fc_move(struct fc_character_mapping * mapping, size_t count, float left, fl
     mapping[i].target.right += left;
   }
 }
+
+#if defined(FC_SIMD_SSE2)
+static void fc_move_sse2(struct fc_character_mapping * mapping, size_t count, float left, float baseline) {
+  __m128 offset = _mm_setr_ps(left, baseline, left, baseline);
+  for (size_t i = 0; i < count; i++) {
+    float * target = &mapping[i].target.left;
+    _mm_storeu_ps(target, _mm_add_ps(_mm_loadu_ps(target), offset));
+  }
+}
+#endif
+
+#if defined(FC_SIMD_AVX2_DISPATCH)
+/* Four mappings take five vectors. The offset is added to every float, but only the sums that
+ * fall on target rects are blended in, leaving the other fields (integers included) untouched */
+FC_TARGET_AVX2
+static void fc_move_avx2(struct fc_character_mapping * mapping, size_t count, float left, float baseline) {
+  __m128 offset = _mm_setr_ps(left, baseline, left, baseline);
+  size_t i = 0;
+
+  if (sizeof(*mapping) == 40 && offsetof(struct fc_character_mapping, target) == 16) {
+    __m256 o0 = _mm256_setr_ps(0, 0, 0, 0, left, baseline, left, baseline);
+    __m256 o1 = _mm256_setr_ps(0, 0, 0, 0, 0, 0, left, baseline);
+    __m256 o2 = _mm256_setr_ps(left, baseline, 0, 0, 0, 0, 0, 0);
+    __m256 o3 = _mm256_setr_ps(left, baseline, left, baseline, 0, 0, 0, 0);
+    __m256 o4 = _mm256_setr_ps(0, 0, left, baseline, left, baseline, 0, 0);
+    for (; i + 4 <= count; i += 4) {
+      float * floats = (float *) (mapping + i);
+      __m256 v0 = _mm256_loadu_ps(floats), v1 = _mm256_loadu_ps(floats + 8), v2 = _mm256_loadu_ps(floats + 16);
+      __m256 v3 = _mm256_loadu_ps(floats + 24), v4 = _mm256_loadu_ps(floats + 32);
+      _mm256_storeu_ps(floats, _mm256_blend_ps(v0, _mm256_add_ps(v0, o0), 0xF0));
+      _mm256_storeu_ps(floats + 8, _mm256_blend_ps(v1, _mm256_add_ps(v1, o1), 0xC0));
+      _mm256_storeu_ps(floats + 16, _mm256_blend_ps(v2, _mm256_add_ps(v2, o2), 0x03));
+      _mm256_storeu_ps(floats + 24, _mm256_blend_ps(v3, _mm256_add_ps(v3, o3), 0x0F));
+      _mm256_storeu_ps(floats + 32, _mm256_blend_ps(v4, _mm256_add_ps(v4, o4), 0x3C));
+    }
+  }
+  for (; i < count; i++) {
+    float * target = &mapping[i].target.left;
+    _mm_storeu_ps(target, _mm_add_ps(_mm_loadu_ps(target), offset));
+  }
+}
+#endif
+
+#if defined(FC_SIMD_NEON)
+static void fc_move_neon(struct fc_character_mapping * mapping, size_t count, float left, float baseline) {
+  float const values[4] = { left, baseline, left, baseline };
+  float32x4_t offset = vld1q_f32(values);
+  for (size_t i = 0; i < count; i++) {
+    float * target = &mapping[i].target.left;
+    vst1q_f32(target, vaddq_f32(vld1q_f32(target), offset));
+  }
+}
+#endif
+
+void fc_move(struct fc_character_mapping * mapping, size_t count, float left, float baseline) {
+  switch (fc_get_simd_level()) {
+#if defined(FC_SIMD_AVX2_DISPATCH)
+    case fc_simd_avx2:
+      fc_move_avx2(mapping, count, left, baseline);
+      break;
+#endif
+#if defined(FC_SIMD_SSE2)
+    case fc_simd_sse2:
+      fc_move_sse2(mapping, count, left, baseline);
+      break;
+#endif
+#if defined(FC_SIMD_NEON)
+    case fc_simd_neon:
+      fc_move_neon(mapping, count, left, baseline);
+      break;
+#endif
+    default:
+      fc_move_scalar(mapping, count, left, baseline);
+      break;
+  }
+}
+
+void fc_scale(struct fc_character_mapping * mapping, size_t count, float scale) {
+  size_t i;
+  for (i = 0; i < count; i++) {
+    mapping[i].target.left *= scale;
+    mapping[i].target.top *= scale;
+    mapping[i].target.right *= scale;
+    mapping[i].target.bottom *= scale;
+  }
+}
+
+/* rounds to the nearest integer, halfway cases away from zero */
+static long fc_round(float value) {
+  return (long) (value < 0 ? value - 0.5f : value + 0.5f);
+}
+
+size_t fc_make_instances(
+    struct fc_character_mapping const * mapping,
+    size_t count,
+    struct fc_glyph_instance * instances
+) {
+  size_t i, written = 0;
+  for (i = 0; i < count; i++) {
+    struct fc_rect const * src = &mapping[i].source, * dst = &mapping[i].target;
+    long x, y, width, height, uv_width = (long) (src->right - src->left), uv_height = (long) (src->bottom - src->top);
+
+    /* ruled out as floats first, as rounding them would not fit a long */
+    if (!(dst->left > INT16_MIN - 1 && dst->top > INT16_MIN - 1)) continue;
+    if (!(dst->right < INT16_MAX + UINT8_MAX + 1 && dst->bottom < INT16_MAX + UINT8_MAX + 1)) continue;
+    x = fc_round(dst->left);
+    y = fc_round(dst->top);
+    width = fc_round(dst->right) - x;
+    height = fc_round(dst->bottom) - y;
+
+    if (uv_width <= 0 || uv_height <= 0 || uv_width > UINT8_MAX || uv_height > UINT8_MAX) continue;
+    if (width < 0 || height < 0 || width > UINT8_MAX || height > UINT8_MAX) continue;
+    if (x < INT16_MIN || x > INT16_MAX || y < INT16_MIN || y > INT16_MAX) continue;
+    if (src->right > UINT16_MAX || src->bottom > UINT16_MAX || mapping[i].page > UINT16_MAX) continue;
+
+    instances[written].x = (int16_t) x;
+    instances[written].y = (int16_t) y;
+    instances[written].u = (uint16_t) src->left;
+    instances[written].v = (uint16_t) src->top;
+    instances[written].width = (uint8_t) width;
+    instances[written].height = (uint8_t) height;
+    instances[written].uv_width = (uint8_t) uv_width;
+    instances[written].uv_height = (uint8_t) uv_height;
+    instances[written].page = (uint16_t) mapping[i].page;
+    written++;
+  }
+  return written;
+}
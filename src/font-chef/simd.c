@@ -0,0 +1,139 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "simd.h"
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#if defined(_MSC_VER) && defined(FC_SIMD_AVX2_DISPATCH)
+#include <intrin.h>
+#endif
+
+/* the level chosen with fc_set_simd_level, or fc_simd_auto for the best one. Only
+ * fc_set_simd_level writes it, which is documented not to run alongside anything else */
+static int fc_simd_level_in_use = fc_simd_auto;
+
+/* the best level, detected once no matter how many threads ask for it at the same time */
+static int fc_simd_level_detected = fc_simd_scalar;
+
+static int fc_cpu_has_avx2(void) {
+#if defined(FC_SIMD_AVX2)
+  return 1;
+#elif defined(FC_SIMD_AVX2_DISPATCH) && (defined(__GNUC__) || defined(__clang__))
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0;
+#elif defined(FC_SIMD_AVX2_DISPATCH)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) return 0;
+  __cpuid(info, 1);
+  /* the CPU has AVX and the OS saves its registers */
+  if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28)) || (_xgetbv(0) & 6) != 6) return 0;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return 0;
+#endif
+}
+
+static int fc_simd_supported(enum fc_simd_level level) {
+  switch (level) {
+    case fc_simd_scalar:
+      return 1;
+    case fc_simd_sse2:
+#if defined(FC_SIMD_SSE2)
+      return 1;
+#else
+      return 0;
+#endif
+    case fc_simd_avx2:
+      return fc_cpu_has_avx2();
+    case fc_simd_neon:
+#if defined(FC_SIMD_NEON)
+      return 1;
+#else
+      return 0;
+#endif
+    default:
+      return 0;
+  }
+}
+
+static enum fc_simd_level fc_simd_best(void) {
+  if (fc_simd_supported(fc_simd_avx2)) return fc_simd_avx2;
+  if (fc_simd_supported(fc_simd_sse2)) return fc_simd_sse2;
+  if (fc_simd_supported(fc_simd_neon)) return fc_simd_neon;
+  return fc_simd_scalar;
+}
+
+uint8_t fc_set_simd_level(enum fc_simd_level level) {
+  if (level == fc_simd_auto) level = fc_simd_best();
+  if (!fc_simd_supported(level)) return 0;
+  fc_simd_level_in_use = level;
+  return 1;
+}
+
+#if defined(_WIN32)
+static INIT_ONCE fc_simd_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK fc_simd_detect(PINIT_ONCE once, PVOID parameter, PVOID * context) {
+  (void) once;
+  (void) parameter;
+  (void) context;
+  fc_simd_level_detected = fc_simd_best();
+  return TRUE;
+}
+#else
+static pthread_once_t fc_simd_once = PTHREAD_ONCE_INIT;
+
+static void fc_simd_detect(void) {
+  fc_simd_level_detected = fc_simd_best();
+}
+#endif
+
+enum fc_simd_level fc_get_simd_level(void) {
+  if (fc_simd_level_in_use != fc_simd_auto) return (enum fc_simd_level) fc_simd_level_in_use;
+#if defined(_WIN32)
+  InitOnceExecuteOnce(&fc_simd_once, fc_simd_detect, NULL, NULL);
+#else
+  pthread_once(&fc_simd_once, fc_simd_detect);
+#endif
+  return (enum fc_simd_level) fc_simd_level_detected;
+}
+
+/* whether `value` is a zero with a sign other than the one of `zero` */
+static int fc_other_zero(float value, float zero) {
+  uint32_t a, b;
+  if (value != 0 || zero != 0) return 0;
+  memcpy(&a, &value, sizeof(a));
+  memcpy(&b, &zero, sizeof(b));
+  return a != b;
+}
+
+int fc_bounds_merge_lanes(
+    struct fc_rect * r,
+    float const * left,
+    float const * top,
+    float const * right,
+    float const * bottom,
+    size_t lanes
+) {
+  size_t i;
+  for (i = 0; i < lanes; i++) {
+    if (top[i] < r->top) r->top = top[i];
+    if (bottom[i] > r->bottom) r->bottom = bottom[i];
+    if (left[i] < r->left) r->left = left[i];
+    if (right[i] > r->right) r->right = right[i];
+  }
+  for (i = 0; i < lanes; i++) {
+    if (fc_other_zero(left[i], r->left) || fc_other_zero(top[i], r->top)) return 0;
+    if (fc_other_zero(right[i], r->right) || fc_other_zero(bottom[i], r->bottom)) return 0;
+  }
+  return 1;
+}
@@ -0,0 +1,55 @@
+#ifndef FC_SIMD_H
+#define FC_SIMD_H
+
+/* Compile-time selection of the vector instruction sets font-chef kernels can use. Each
+ * kernel has a portable scalar path and uses the widest of these that is available. */
+
+#include "font-chef/rect.h"
+#include "font-chef/simd-level.h"
+#include <stddef.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FC_SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define FC_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define FC_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+/* Layout kernels also have AVX2 versions that are picked at runtime, so they are compiled
+ * even when the rest of the library is not built for AVX2. Those kernels are marked with
+ * FC_TARGET_AVX2 and only run when fc_get_simd_level returns fc_simd_avx2 */
+#if defined(FC_SIMD_AVX2)
+#define FC_SIMD_AVX2_DISPATCH 1
+#define FC_TARGET_AVX2
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define FC_SIMD_AVX2_DISPATCH 1
+#define FC_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#define FC_SIMD_AVX2_DISPATCH 1
+#define FC_TARGET_AVX2
+#include <immintrin.h>
+#endif
+
+/* Merges bounds found by the lanes of a vector kernel into `r`. Each lane went through its
+ * glyphs in order, keeping the first of equal values like the scalar loop does, so merging
+ * them only gives a different result when lanes found zeroes of different signs. Returns
+ * zero in that case, so that the caller can fall back to the scalar loop */
+int fc_bounds_merge_lanes(
+    struct fc_rect * r,
+    float const * left,
+    float const * top,
+    float const * right,
+    float const * bottom,
+    size_t lanes
+);
+
+#endif
@@ -0,0 +1,111 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "font-internal.h"
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+/* tasks are handed out one by one from a shared counter, so threads that get cheap tasks
+ * (e.g, empty glyphs) simply take more of them */
+struct fc_thread_work {
+  fc_task task;
+  void * data;
+  size_t count;
+  size_t next;
+#if defined(_WIN32)
+  CRITICAL_SECTION lock;
+#else
+  pthread_mutex_t lock;
+#endif
+};
+
+static size_t fc_thread_work_next(struct fc_thread_work * work) {
+  size_t index;
+#if defined(_WIN32)
+  EnterCriticalSection(&work->lock);
+  index = work->next++;
+  LeaveCriticalSection(&work->lock);
+#else
+  pthread_mutex_lock(&work->lock);
+  index = work->next++;
+  pthread_mutex_unlock(&work->lock);
+#endif
+  return index;
+}
+
+static void fc_thread_work_run(struct fc_thread_work * work) {
+  size_t index;
+  while ((index = fc_thread_work_next(work)) < work->count) work->task(work->data, index);
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI fc_thread_main(LPVOID work) {
+  fc_thread_work_run(work);
+  return 0;
+}
+#else
+static void * fc_thread_main(void * work) {
+  fc_thread_work_run(work);
+  return NULL;
+}
+#endif
+
+void fc_run_tasks(
+    struct fc_executor const * executor,
+    size_t thread_count,
+    fc_task task,
+    void * data,
+    size_t count
+) {
+  struct fc_thread_work work;
+  size_t i, started = 0;
+
+  if (executor != NULL && executor->run != NULL) {
+    executor->run(executor->context, task, data, count);
+    return;
+  }
+
+  if (thread_count > count) thread_count = count;
+  if (thread_count <= 1) {
+    for (i = 0; i < count; i++) task(data, i);
+    return;
+  }
+
+  work.task = task;
+  work.data = data;
+  work.count = count;
+  work.next = 0;
+
+  /* the calling thread works too, so only thread_count - 1 threads are started. If starting
+   * one fails, the ones already running (or the caller alone) take over its share */
+#if defined(_WIN32)
+  HANDLE * threads = malloc(sizeof(*threads) * (thread_count - 1));
+  InitializeCriticalSection(&work.lock);
+  for (i = 0; threads != NULL && i < thread_count - 1; i++) {
+    threads[started] = CreateThread(NULL, 0, fc_thread_main, &work, 0, NULL);
+    if (threads[started] != NULL) started++;
+  }
+  fc_thread_work_run(&work);
+  for (i = 0; i < started; i++) {
+    WaitForSingleObject(threads[i], INFINITE);
+    CloseHandle(threads[i]);
+  }
+  DeleteCriticalSection(&work.lock);
+#else
+  pthread_t * threads = malloc(sizeof(*threads) * (thread_count - 1));
+  pthread_mutex_init(&work.lock, NULL);
+  for (i = 0; threads != NULL && i < thread_count - 1; i++) {
+    if (pthread_create(&threads[started], NULL, fc_thread_main, &work) == 0) started++;
+  }
+  fc_thread_work_run(&work);
+  for (i = 0; i < started; i++) pthread_join(threads[i], NULL);
+  pthread_mutex_destroy(&work.lock);
+#endif
+  free(threads);
+}
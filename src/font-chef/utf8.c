@@ -0,0 +1,96 @@
+#include "font-internal.h"
+#include "simd.h"
+#include "utf8-decode.h"
+#include <string.h>
+
+/* converts a run of ASCII bytes to codepoints. Returns how many bytes were converted, stopping
+ * before the first block that has a byte with its high bit set */
+static size_t fc_decode_ascii(unsigned char const * text, size_t byte_count, uint32_t * codepoints) {
+  size_t i = 0;
+#if defined(FC_SIMD_AVX2)
+  for (; i + 32 <= byte_count; i += 32) {
+    __m256i bytes = _mm256_loadu_si256((__m256i const *) (text + i));
+    if (_mm256_movemask_epi8(bytes) != 0) break;
+    _mm256_storeu_si256((__m256i *) (codepoints + i), _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const *) (text + i))));
+    _mm256_storeu_si256((__m256i *) (codepoints + i + 8), _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const *) (text + i + 8))));
+    _mm256_storeu_si256((__m256i *) (codepoints + i + 16), _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const *) (text + i + 16))));
+    _mm256_storeu_si256((__m256i *) (codepoints + i + 24), _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const *) (text + i + 24))));
+  }
+#endif
+#if defined(FC_SIMD_SSE2)
+  for (; i + 16 <= byte_count; i += 16) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i bytes = _mm_loadu_si128((__m128i const *) (text + i));
+    __m128i low, high;
+    if (_mm_movemask_epi8(bytes) != 0) break;
+    low = _mm_unpacklo_epi8(bytes, zero);
+    high = _mm_unpackhi_epi8(bytes, zero);
+    _mm_storeu_si128((__m128i *) (codepoints + i), _mm_unpacklo_epi16(low, zero));
+    _mm_storeu_si128((__m128i *) (codepoints + i + 4), _mm_unpackhi_epi16(low, zero));
+    _mm_storeu_si128((__m128i *) (codepoints + i + 8), _mm_unpacklo_epi16(high, zero));
+    _mm_storeu_si128((__m128i *) (codepoints + i + 12), _mm_unpackhi_epi16(high, zero));
+  }
+#elif defined(FC_SIMD_NEON)
+  for (; i + 16 <= byte_count; i += 16) {
+    uint8x16_t bytes = vld1q_u8(text + i);
+    uint16x8_t low, high;
+    if (vmaxvq_u8(bytes) >= 0x80) break;
+    low = vmovl_u8(vget_low_u8(bytes));
+    high = vmovl_u8(vget_high_u8(bytes));
+    vst1q_u32(codepoints + i, vmovl_u16(vget_low_u16(low)));
+    vst1q_u32(codepoints + i + 4, vmovl_u16(vget_high_u16(low)));
+    vst1q_u32(codepoints + i + 8, vmovl_u16(vget_low_u16(high)));
+    vst1q_u32(codepoints + i + 12, vmovl_u16(vget_high_u16(high)));
+  }
+#endif
+  for (; i + 8 <= byte_count; i += 8) {
+    uint64_t word;
+    size_t j;
+    memcpy(&word, text + i, sizeof(word));
+    if (word & 0x8080808080808080ull) break;
+    for (j = 0; j < 8; j++) codepoints[i + j] = text[i + j];
+  }
+  return i;
+}
+
+size_t fc_decode_utf8(
+    unsigned char const * text,
+    size_t byte_count,
+    uint32_t * codepoints,
+    size_t capacity,
+    size_t * consumed
+) {
+  size_t i = 0, count = 0, ascii;
+  struct utf8_decode_result decode;
+
+  while (i < byte_count && count < capacity) {
+    /* fast path for runs of ASCII, writing straight to the output */
+    ascii = byte_count - i < capacity - count ? byte_count - i : capacity - count;
+    ascii = fc_decode_ascii(text + i, ascii, codepoints + count);
+    i += ascii;
+    count += ascii;
+
+    /* whatever is left in this run is handled one byte at a time */
+    for (; i < byte_count && count < capacity; count++) {
+      if (text[i] < 0x80) {
+        codepoints[count] = text[i++];
+        continue;
+      }
+      decode = utf8_decode(text + i, byte_count - i);
+      /* invalid sequences become a replacement character instead of stalling the decoder */
+      if (decode.skip == 0) {
+        decode.codepoint = 0xFFFD;
+        decode.skip = 1;
+      }
+      codepoints[count] = decode.codepoint;
+      i += decode.skip;
+      if (i + 16 <= byte_count && text[i] < 0x80) {
+        count++;
+        break;
+      }
+    }
+  }
+
+  *consumed = i;
+  return count;
+}
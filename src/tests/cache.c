@@ -0,0 +1,62 @@
+#include "font-chef/font-chef.h"
+
+#include "common/font.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static struct fc_font * make_font(void) {
+  struct fc_font * font = fc_construct(font_pacifico_ttf.data, fc_px(48), fc_color_white);
+  fc_set_max_page_size(font, 256);
+  fc_add(font, fc_basic_latin.first, fc_latin_1_supplement.last);
+  return font;
+}
+
+/* a single block spread over a few pages, loaded back into a font that renders the same */
+int main(void) {
+  struct fc_font * cooked = make_font(), * loaded = make_font();
+  struct fc_character_mapping expected[64], mapping[64];
+  struct fc_render_result expected_result, result;
+  const char text[] = "Hello, wörld! AV To ÆØÅ";
+  unsigned char * cache;
+  size_t size, i;
+  int failed = 0;
+
+  fc_cook(cooked);
+  size = fc_save_cache(cooked, NULL, 0);
+  cache = malloc(size);
+  if (fc_save_cache(cooked, cache, size) != size) {
+    printf("could not save the cache\n");
+    return EXIT_FAILURE;
+  }
+
+  if (fc_load_cache(loaded, cache, size - 1)) {
+    printf("a truncated cache was loaded\n");
+    failed = 1;
+  }
+  if (!fc_load_cache(loaded, cache, size)) {
+    printf("a cache of %zu pages was not loaded\n", fc_get_page_count(cooked));
+    failed = 1;
+  } else {
+    expected_result = fc_render(cooked, (uint8_t const *) text, strlen(text), expected);
+    result = fc_render(loaded, (uint8_t const *) text, strlen(text), mapping);
+    if (result.glyph_count != expected_result.glyph_count || memcmp(mapping, expected, sizeof(*mapping) * result.glyph_count)) {
+      printf("the loaded font renders differently\n");
+      failed = 1;
+    }
+    for (i = 0; i < fc_get_page_count(cooked); i++) {
+      struct fc_pixels const * a = fc_get_page(cooked, i), * b = fc_get_page(loaded, i);
+      size_t bytes = (size_t) a->dimensions.width * (size_t) a->dimensions.height * 4;
+      if (memcmp(&a->dimensions, &b->dimensions, sizeof(a->dimensions)) || memcmp(a->data, b->data, bytes)) {
+        printf("page %zu differs\n", i);
+        failed = 1;
+      }
+    }
+  }
+
+  fc_destruct(loaded);
+  fc_destruct(cooked);
+  free(cache);
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,62 @@
+#include "font-chef/font-chef.h"
+
+#include "common/font.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_PAGE_SIZE 48
+
+static int overlaps(struct fc_rect a, struct fc_rect b) {
+  return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+static int empty(struct fc_rect r) {
+  return r.right <= r.left || r.bottom <= r.top;
+}
+
+/* at this size 'W' does not fit in a page of MAX_PAGE_SIZE pixels, while the punctuation does */
+int main(void) {
+  struct fc_font * font = fc_construct(font_pacifico_ttf.data, fc_px(96), fc_color_white);
+  struct fc_character_mapping mapping[16];
+  struct fc_render_result result;
+  const char text[] = ",.-W'`:;";
+  struct fc_pixels const * last;
+  int failed = 0;
+  uint32_t i, j;
+
+  fc_set_dynamic_atlas(font, 1);
+  fc_set_max_page_size(font, MAX_PAGE_SIZE);
+  fc_add(font, ',', '.');
+  fc_add(font, 'W', 'W');
+  fc_cook(font);
+
+  last = fc_get_page(font, fc_get_page_count(font) - 1);
+  if (fc_get_page_count(font) != 1 || last->dimensions.height != MAX_PAGE_SIZE) {
+    printf("expected a single page of full height, got %zu with the last one %g pixels high\n",
+        fc_get_page_count(font), last->dimensions.height);
+    failed = 1;
+  }
+
+  /* glyphs cooked on demand must land in free space of the pages, not over the glyphs already there */
+  result = fc_render_dynamic(font, (uint8_t const *) text, strlen(text), mapping);
+  for (i = 0; i < result.glyph_count; i++) {
+    struct fc_pixels const * page = fc_get_page(font, mapping[i].page);
+    struct fc_rect a = mapping[i].source;
+    if (empty(a)) continue;
+    if (a.left < 0 || a.top < 0 || a.right > page->dimensions.width || a.bottom > page->dimensions.height) {
+      printf("U+%04X lies outside of page %u\n", mapping[i].codepoint, mapping[i].page);
+      failed = 1;
+    }
+    for (j = i + 1; j < result.glyph_count; j++) {
+      if (mapping[j].page != mapping[i].page || empty(mapping[j].source)) continue;
+      if (!overlaps(a, mapping[j].source)) continue;
+      printf("U+%04X overlaps U+%04X on page %u\n", mapping[i].codepoint, mapping[j].codepoint, mapping[i].page);
+      failed = 1;
+    }
+  }
+
+  fc_destruct(font);
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
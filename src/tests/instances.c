@@ -0,0 +1,84 @@
+#include "font-chef/font-chef.h"
+
+#include "common/font.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEXT "Hello, world! AV To"
+
+static long round_pixel(float value) {
+  return (long) (value < 0 ? value - 0.5f : value + 0.5f);
+}
+
+static float distance(float a, float b) {
+  return a > b ? a - b : b - a;
+}
+
+/* checks that every quad is as big as its target rect and about `ratio` times its page pixels */
+static int check(char const * name, struct fc_character_mapping const * mapping, size_t count, float ratio) {
+  struct fc_glyph_instance instances[64];
+  size_t i, j, written = fc_make_instances(mapping, count, instances);
+  int failed = 0;
+
+  if (written == 0) {
+    printf("%s: no instances\n", name);
+    return 1;
+  }
+  for (i = 0, j = 0; i < count && j < written; i++) {
+    struct fc_rect target = mapping[i].target;
+    if (mapping[i].source.right <= mapping[i].source.left) continue;
+    if (instances[j].width != (uint8_t) (round_pixel(target.right) - round_pixel(target.left))
+        || instances[j].height != (uint8_t) (round_pixel(target.bottom) - round_pixel(target.top))
+        || distance(instances[j].width, instances[j].uv_width * ratio) > 1.0f
+        || distance(instances[j].height, instances[j].uv_height * ratio) > 1.0f) {
+      printf("%s: U+%04X is %ux%u for %ux%u page pixels\n", name, mapping[i].codepoint,
+          instances[j].width, instances[j].height, instances[j].uv_width, instances[j].uv_height);
+      failed = 1;
+    }
+    j++;
+  }
+  return failed;
+}
+
+int main(void) {
+  struct fc_character_mapping mapping[64];
+  struct fc_glyph_instance rendered[64], made[64];
+  struct fc_render_result result;
+  size_t count;
+  int failed = 0;
+
+  struct fc_font * font = fc_construct(font_pacifico_ttf.data, fc_px(24), fc_color_white);
+  struct fc_font * oversampled = fc_construct(font_pacifico_ttf.data, fc_px(24), fc_color_white);
+  fc_add(font, fc_basic_latin.first, fc_basic_latin.last);
+  fc_add(oversampled, fc_basic_latin.first, fc_basic_latin.last);
+  fc_set_oversampling(oversampled, 2, 2);
+  fc_cook(font);
+  fc_cook(oversampled);
+
+  result = fc_render(font, (uint8_t const *) TEXT, strlen(TEXT), mapping);
+  failed |= check("cooked size", mapping, result.glyph_count, 1.0f);
+
+  /* drawn at a different size than cooked, as distance fields usually are */
+  fc_move(mapping, result.glyph_count, 10.0f, 40.0f);
+  fc_scale(mapping, result.glyph_count, 2.5f);
+  failed |= check("scaled", mapping, result.glyph_count, 2.5f);
+
+  result = fc_render(oversampled, (uint8_t const *) TEXT, strlen(TEXT), mapping);
+  failed |= check("oversampled", mapping, result.glyph_count, 0.5f);
+
+  /* rendering straight into instances matches going through mappings */
+  result = fc_render(oversampled, (uint8_t const *) TEXT, strlen(TEXT), mapping);
+  fc_move(mapping, result.glyph_count, 10.0f, 40.0f);
+  count = fc_make_instances(mapping, result.glyph_count, made);
+  if (fc_render_instances(oversampled, (uint8_t const *) TEXT, strlen(TEXT), 10.0f, 40.0f, rendered, 64) != count
+      || memcmp(rendered, made, sizeof(*made) * count) != 0) {
+    printf("fc_render_instances differs from fc_make_instances\n");
+    failed = 1;
+  }
+
+  fc_destruct(oversampled);
+  fc_destruct(font);
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+#include "font-chef/font-chef.h"
+#include "common/font.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr size_t thread_count = 8;
+static constexpr size_t round_count = 50;
+static constexpr int width = 480;
+static constexpr int height = 480;
+
+/* what a thread laid out and drew in its last round, and how many rounds disagreed with the first one */
+struct output {
+  std::vector<fc_character_mapping> mapping;
+  std::vector<uint8_t> pixels;
+  size_t mismatches = 0;
+};
+
+static void render(fc_font const * font, std::string const & text, output & out) {
+  out.mapping.resize(text.size());
+  out.mapping.resize(fc_render_wrapped(
+      font, reinterpret_cast<unsigned char const *>(text.data()), text.size(),
+      width - 20, 1.0f, fc_align_left, out.mapping.data()
+  ).glyph_count);
+  fc_move(out.mapping.data(), out.mapping.size(), 10, 30);
+  out.pixels.assign(width * height * 4, 0);
+  fc_framebuffer framebuffer = { out.pixels.data(), width, height, 0 };
+  fc_blit(font, out.mapping.data(), out.mapping.size(), &framebuffer, nullptr, fc_color_white);
+}
+
+static bool same(output const & a, output const & b) {
+  return a.mapping.size() == b.mapping.size()
+      && memcmp(a.mapping.data(), b.mapping.data(), a.mapping.size() * sizeof(fc_character_mapping)) == 0
+      && a.pixels == b.pixels;
+}
+
+/* several threads render and blit the same cooked font at once, and must all get what a single thread gets. The
+ * threads start before anything else uses the font, so that the SIMD level is detected while they race for it */
+int main() {
+  fc_font * font = fc_construct(font_pacifico_ttf.data, fc_px(24), fc_color_white);
+  fc_add(font, fc_basic_latin.first, fc_basic_latin.last);
+  fc_add(font, fc_latin_1_supplement.first, fc_latin_1_supplement.last);
+  fc_add(font, fc_cyrillic.first, fc_cyrillic.last);
+  fc_cook(font);
+
+  std::string text;
+  while (text.size() < 1024) {
+    text += "D\xc3\xa9j\xc3\xa0 vu, na\xc3\xafve fa\xc3\xa7" "ade: \xd0\xa1\xd1\x8a\xd0\xb5\xd1\x88\xd1\x8c "
+        "\xd0\xb6\xd0\xb5 \xd0\xb5\xd1\x89\xd1\x91 AV To \xe6\x97\xa5\xe6\x9c\xac stra\xc3\x9f" "e. ";
+  }
+
+  std::vector<output> outputs(thread_count);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < thread_count; t++) {
+    threads.emplace_back([&, t] {
+      output first;
+      render(font, text, first);
+      for (size_t round = 1; round < round_count; round++) {
+        render(font, text, outputs[t]);
+        if (!same(outputs[t], first)) outputs[t].mismatches++;
+      }
+    });
+  }
+  for (auto & thread : threads) thread.join();
+
+  output expected;
+  render(font, text, expected);
+  int failed = 0;
+  for (size_t t = 0; t < thread_count; t++) {
+    if (outputs[t].mismatches == 0 && same(outputs[t], expected)) continue;
+    printf("thread %zu differs from a single thread (%zu rounds disagreed)\n", t, outputs[t].mismatches);
+    failed = 1;
+  }
+
+  fc_destruct(font);
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}